@@ -0,0 +1,12 @@
+// Array push/index/iteration, sorting and typed arrays
+var a = [];
+for (var i=0;i<1000;i++) a.push((i*37) % 1000);
+var sum = 0;
+for (var j=0;j<a.length;j++) sum += a[j];
+a.sort(function(x, y) { return x-y; });
+var mapped = a.map(function(v) { return v*2; }).filter(function(v) { return v%3==0; });
+var t = new Uint16Array(2000);
+for (var k=0;k<t.length;k++) t[k] = k*3;
+var tsum = 0;
+for (var m=0;m<t.length;m++) tsum += t[m];
+print(sum, a[0], a[999], mapped.length, tsum);
@@ -0,0 +1,17 @@
+// Garbage collection of deep structures: a long linked list, deeply nested arrays and a wide tree
+var list = null;
+for (var i=0;i<600;i++) list = { v:i, next:list };
+var nest = [];
+for (var j=0;j<300;j++) nest = [nest, j];
+var level = [];
+for (var l=0;l<128;l++) level.push(l);
+while (level.length>1) {
+  var up = [];
+  for (var m=0;m<level.length;m+=2) up.push([level[m], level[m+1]]);
+  level = up;
+}
+var used = 0;
+for (var k=0;k<40;k++) used = process.memory().usage; // each call runs a full collection
+var n = 0;
+for (var p=list;p;p=p.next) n++;
+print(n, nest[1], level[0][1][1][1][1][1][1][1], used>0);
@@ -0,0 +1,14 @@
+// Integer and floating point arithmetic in tight loops, and function calls
+// (recursion is kept shallow - each frame holds a lock on the function's code)
+function fib(n) { return n<2 ? n : fib(n-1)+fib(n-2); }
+
+var sum = 0;
+for (var i=0;i<20000;i++) {
+  sum += (i*7) % 13;
+  if (i & 1) sum -= i>>3;
+}
+var f = 0;
+for (var j=1;j<5000;j++) f += Math.sqrt(j) / j;
+var fibs = 0;
+for (var k=0;k<30;k++) fibs += fib(6);
+print(sum, f.toFixed(3), fibs);
@@ -0,0 +1,16 @@
+// Object creation, property access and method calls
+function Point(x, y) { this.x = x; this.y = y; }
+Point.prototype.add = function(p) { return new Point(this.x+p.x, this.y+p.y); };
+Point.prototype.len2 = function() { return this.x*this.x + this.y*this.y; };
+
+var acc = new Point(0, 0);
+var total = 0;
+for (var i=0;i<3000;i++) {
+  acc = acc.add(new Point(i%7, i%5));
+  total += acc.len2() % 1000;
+}
+var o = {};
+for (var j=0;j<200;j++) o["key" + j] = j;
+var keySum = 0;
+for (var k=0;k<200;k++) keySum += o["key" + (199-k)];
+print(acc.x, acc.y, total, keySum);
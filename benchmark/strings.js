@@ -0,0 +1,12 @@
+// String building, searching and slicing
+var s = "";
+for (var i=0;i<500;i++) s += String.fromCharCode(65 + i%26);
+var count = 0;
+for (var j=0;j<2000;j++) {
+  if (s.indexOf("XYZ", j%500) >= 0) count++;
+  count += s.substr(j%500, 10).length;
+}
+var parts = [];
+for (var k=0;k<100;k++) parts.push("item" + k);
+var joined = parts.join(",");
+print(s.length, count, joined.split(",").length);
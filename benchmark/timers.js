@@ -0,0 +1,12 @@
+// Timers, intervals, events and pin watches through the idle loop
+var fired = 0, ticks = 0, emitted = 0, edges = 0;
+for (var i=0;i<100;i++) setTimeout(function() { fired++; }, i%10);
+var iv = setInterval(function() {
+  if (++ticks >= 20) clearInterval(iv);
+}, 1);
+var e = {};
+e.on("ev", function(n) { emitted += n; });
+for (var j=0;j<20;j++) e.emit("ev", j);
+setWatch(function() { edges++; }, A0, { repeat:true, edge:"both" });
+for (var k=0;k<100;k++) digitalWrite(A0, k&1);
+setTimeout(function() { print(fired, ticks, emitted, edges); }, 30);
@@ -24,13 +24,43 @@
 
 // ----------------------------------------------------------------------------
 //                                                         DATA TRANSMIT BUFFER
+/* Data waiting to be transmitted is kept in one pool of items shared by all
+ * the serial devices, each of which has its own queue of items linked through
+ * the pool - so the next character for a device is found straight away. Half
+ * of the pool is split up between the devices, so each one always has a few
+ * items it can use however busy the others are. The other half goes to
+ * whichever devices need it. Items are referred to by their index+1, so 0
+ * means 'none' and everything starts off empty. */
+#define TXBUFFERS (EV_SERIAL_MAX+1-EV_SERIAL_START) // one queue for each serial device
+#define TXBUFFER_DEVICE_MIN (((TXBUFFERMASK+1)/(2*TXBUFFERS)) ? ((TXBUFFERMASK+1)/(2*TXBUFFERS)) : 1) // items kept for each device
+#define TXBUFFER_SHARED ((TXBUFFERMASK+1) - TXBUFFERS*TXBUFFER_DEVICE_MIN) // items any device can use once it has used its own
+
 typedef struct {
-  IOEventFlags flags; // Where this data should be transmitted
-  unsigned char data;         // data to transmit
+  unsigned char data; // data to transmit
+  unsigned char next; // next item for the same device (or 0)
 } PACKED_FLAGS TxBufferItem;
 
-volatile TxBufferItem txBuffer[TXBUFFERMASK+1];
-volatile unsigned char txHead=0, txTail=0;
+typedef struct {
+  volatile unsigned char head, tail; // first and last items waiting (or 0)
+  volatile unsigned char count; // number of items waiting
+} TxQueue;
+
+TxBufferItem txBuffer[TXBUFFERMASK+1];
+volatile unsigned char txFree; // first unused item (they're linked through 'next'), or 0
+volatile unsigned char txNeverUsed; // how many items have ever been used - the rest aren't linked into txFree yet
+volatile unsigned char txSharedUsed; // how many items devices are using beyond TXBUFFER_DEVICE_MIN
+TxQueue txQueues[TXBUFFERS];
+
+/// Get the transmit queue for a device, or 0 if it's not a device we transmit on
+static ALWAYS_INLINE TxQueue *jshGetTxQueue(IOEventFlags device) {
+  if (!DEVICE_IS_USART(device)) return 0;
+  return &txQueues[device-EV_SERIAL_START];
+}
+
+/// Is there no room to queue another character for this device? (if not, there's always a free item)
+static ALWAYS_INLINE bool jshIsTxQueueFull(TxQueue *tx) {
+  return tx->count>=TXBUFFER_DEVICE_MIN && txSharedUsed>=TXBUFFER_SHARED;
+}
 // ----------------------------------------------------------------------------
 //                                                              IO EVENT BUFFER
 volatile IOEvent ioBuffer[IOBUFFERMASK+1];
@@ -59,11 +89,11 @@ void jshTransmit(IOEventFlags device, unsigned char data) {
     return;
   }
 #endif
-  if (device==EV_NONE) return;
-  unsigned char txHeadNext = (txHead+1)&TXBUFFERMASK;
-  if (txHeadNext==txTail) {
+  TxQueue *tx = jshGetTxQueue(device);
+  if (!tx) return;
+  if (jshIsTxQueueFull(tx)) {
     jsiSetBusy(BUSY_TRANSMIT, true);
-    while (txHeadNext==txTail) {
+    while (jshIsTxQueueFull(tx)) {
       // wait for send to finish as buffer is about to overflow
 #ifdef USB
       // just in case USB was unplugged while we were waiting!
@@ -72,17 +102,32 @@ void jshTransmit(IOEventFlags device, unsigned char data) {
     }
     jsiSetBusy(BUSY_TRANSMIT, false);
   }
-  txBuffer[txHead].flags = device;
-  txBuffer[txHead].data = (char)data;
-  txHead = txHeadNext;
+  jshInterruptOff(); // the IRQ puts items back in the pool as it sends them
+  unsigned char item = txFree;
+  if (item) txFree = txBuffer[item-1].next;
+  else {
+    assert(txNeverUsed<=TXBUFFERMASK);
+    item = ++txNeverUsed;
+  }
+  txBuffer[item-1].data = data;
+  txBuffer[item-1].next = 0;
+  if (tx->tail) txBuffer[tx->tail-1].next = item;
+  else tx->head = item;
+  tx->tail = item;
+  if (tx->count>=TXBUFFER_DEVICE_MIN) txSharedUsed++;
+  tx->count++;
+  jshInterruptOn();
 
   jshUSARTKick(device); // set up interrupts if required
 }
 
-// Return the device at the top of the transmit queue (or EV_NONE)
+// Return a device that has data waiting to be transmitted (or EV_NONE)
 IOEventFlags jshGetDeviceToTransmit() {
-  if (!jshHasTransmitData()) return EV_NONE;
-  return IOEVENTFLAGS_GETTYPE(txBuffer[txTail].flags);
+  int i;
+  for (i=0;i<TXBUFFERS;i++)
+    if (txQueues[i].head)
+      return (IOEventFlags)(EV_SERIAL_START+i);
+  return EV_NONE;
 }
 
 // Try and get a character for transmission - could just return -1 if nothing
@@ -99,24 +144,20 @@ int jshGetCharToTransmit(IOEventFlags device) {
     }
   }
 
-  unsigned char ptr = txTail;
-  while (txHead != ptr) {
-    if (IOEVENTFLAGS_GETTYPE(txBuffer[ptr].flags) == device) {
-      unsigned char data = txBuffer[ptr].data;
-      if (ptr != txTail) { // so we weren't right at the back of the queue
-        // we need to work back from ptr (until we hit tail), shifting everything forwards
-        unsigned char this = ptr;
-        unsigned char last = (unsigned char)((this+TXBUFFERMASK)&TXBUFFERMASK);
-        while (this!=txTail) { // if this==txTail, then last is before it, so stop here
-          txBuffer[this] = txBuffer[last];
-          this = last;
-          last = (unsigned char)((this+TXBUFFERMASK)&TXBUFFERMASK);
-        }
-      }
-      txTail = (unsigned char)((txTail+1)&TXBUFFERMASK); // advance the tail
-      return data; // return data
-    }
-    ptr = (unsigned char)((ptr+1)&TXBUFFERMASK);
+  TxQueue *tx = jshGetTxQueue(device);
+  if (tx && tx->head) {
+    jshInterruptOff(); // to allow this to be used outside of an IRQ
+    unsigned char item = tx->head;
+    unsigned char data = txBuffer[item-1].data;
+    tx->head = txBuffer[item-1].next;
+    if (!tx->head) tx->tail = 0;
+    tx->count--;
+    if (tx->count>=TXBUFFER_DEVICE_MIN) txSharedUsed--;
+    // put the item back in the pool
+    txBuffer[item-1].next = txFree;
+    txFree = item;
+    jshInterruptOn();
+    return data; // return data
   }
   return -1; // no data :(
 }
@@ -133,7 +174,7 @@ void jshTransmitClearDevice(IOEventFlags device) {
 }
 
 bool jshHasTransmitData() {
-  return txHead != txTail;
+  return jshGetDeviceToTransmit() != EV_NONE;
 }
 
 
@@ -23,6 +23,7 @@
 #include "jspin.h"
 #include "jstimer.h"
 
+#ifndef LINUX
 //for mbed library
 #include "serial_api.h"
 
@@ -46,15 +47,9 @@
 #if DEVICE_SPI
 #include "spi_api.h"
 #endif
+#endif // !LINUX
 
 //---------------------------------------------------------for struct ----------
-typedef struct mbedGpio{
-	gpio_t gpio;
-	struct mbedGpio *next;
-	bool isStateManual;
-}jsGpio;
-
-
 typedef enum {
   SDS_NONE,
   SDS_XOFF_PENDING = 1,
@@ -63,6 +58,16 @@ typedef enum {
   SDS_FLOW_CONTROL_XON_XOFF = 8, // flow control enabled
 } PACKED_FLAGS JshSerialDeviceState;
 
+// Functions that can be called in an IRQ when a pin changes state
+typedef void(*JshEventCallbackCallback)(bool state);
+
+#ifndef LINUX
+typedef struct mbedGpio{
+	gpio_t gpio;
+	struct mbedGpio *next;
+	bool isStateManual;
+}jsGpio;
+
 typedef struct mbedSerial{
 	serial_t serial;
 	IOEventFlags flag;  //use it to decide diferrent device
@@ -95,9 +100,6 @@ typedef struct mbedPwmout{
 #endif
 
 #if DEVICE_INTERRUPTIN
-// Functions that can be called in an IRQ when a pin changes state
-typedef void(*JshEventCallbackCallback)(bool state);
-
 typedef struct mbedInterruptIn{
 	gpio_irq_t gpioIrq;
 	Pin pin;
@@ -113,10 +115,11 @@ typedef struct mbedSpi{
 	struct mbedSpi *next;
 }jsSpi;
 #endif
+#endif // !LINUX
 
 //----------------------
 #define DEFAULT_CONSOLE_DEVICE EV_STDIOSERIAL
-#ifndef ARM
+#if !defined(ARM) && !defined(LINUX)
 #define ARM
 #endif
 
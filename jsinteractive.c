@@ -31,6 +31,7 @@
 
 #define DEFAULT_BUSY_PIN_INDICATOR (Pin)-1 // no indicator
 #define DEFAULT_SLEEP_PIN_INDICATOR (Pin)-1 // no indicator
+#define GC_STEP_TIME 1 // in milliseconds - the most time we spend garbage collecting each time around the idle loop
 
 // ----------------------------------------------------------------------------
 typedef enum {
@@ -48,9 +49,10 @@ typedef enum {
 } PACKED_FLAGS InputState;
 
 TODOFlags todo = TODO_NOTHING;
-JsVar *events = 0; // Array of events to execute
 JsVarRef timerArray = 0; // Linked List of timers to check and run
+JsVarRef timerHeap = 0; // Flat string of JsiTimerHeapEntry - the timers, ordered by when they're due
 JsVarRef watchArray = 0; // Linked List of input watches to check and run
+JsVarRef watchIndex = 0; // Flat string of JsiWatchIndexEntry - the watches, ordered by pin
 // ----------------------------------------------------------------------------
 IOEventFlags consoleDevice; ///< The console device for user interaction
 Pin pinBusyIndicator = DEFAULT_BUSY_PIN_INDICATOR;
@@ -373,13 +375,565 @@ static JsVarRef _jsiInitNamedArray(const char *name) {
 	return arrayRef;
 }
 
+/* Timers are kept in timerArray (that's what gives them their IDs, keeps them
+ * from being freed and gets them saved), but so that the idle loop doesn't
+ * have to look at every timer every time, we also keep a binary min-heap of
+ * the absolute time each one is due at. Each entry refers to the timer's
+ * *name* in timerArray, so a timer can be removed without searching for it.
+ *
+ * The heap is stored in a flat string (referenced from hiddenRoot so the
+ * garbage collector keeps it) and grows when it's full. */
+typedef struct {
+	JsSysTime time; ///< The absolute time at which the timer is due
+	JsVarRef timer; ///< The timer's name in timerArray
+} PACKED_FLAGS JsiTimerHeapEntry; // packed, as flat string data is only 4 byte aligned
+
+static unsigned int timerHeapCount = 0; ///< Number of entries in timerHeap
+static JsVarRef timerRunning = 0; ///< The name of the timer whose callback we're running (it isn't in the heap). Set to 0 if the timer gets removed
+
+#define JSI_TIMER_HEAP_NAME "timerHeap"
+#define JSI_TIMER_HEAP_MIN_SIZE 4 // Number of entries to allocate space for initially
+
+static ALWAYS_INLINE JsiTimerHeapEntry *jsiTimerHeapEntries(JsVar *heap) {
+	return (JsiTimerHeapEntry*)jsvGetFlatStringPointer(heap);
+}
+
+static ALWAYS_INLINE JsVarRef jsiTimerHeapGetTimerRef(JsVarRef timerName) {
+	return jsvGetFirstChild(_jsvGetAddressOf(timerName));
+}
+
+static void jsiTimerHeapSiftUp(JsiTimerHeapEntry *h, unsigned int i) {
+	JsiTimerHeapEntry e = h[i];
+	while (i>0) {
+		unsigned int parent = (i-1)/2;
+		if (h[parent].time <= e.time) break;
+		h[i] = h[parent];
+		i = parent;
+	}
+	h[i] = e;
+}
+
+static void jsiTimerHeapSiftDown(JsiTimerHeapEntry *h, unsigned int i) {
+	JsiTimerHeapEntry e = h[i];
+	while (true) {
+		unsigned int child = i*2+1;
+		if (child >= timerHeapCount) break;
+		if (child+1 < timerHeapCount && h[child+1].time < h[child].time) child++;
+		if (e.time <= h[child].time) break;
+		h[i] = h[child];
+		i = child;
+	}
+	h[i] = e;
+}
+
+static void jsiTimerHeapRemoveAt(JsiTimerHeapEntry *h, unsigned int i) {
+	timerHeapCount--;
+	if (i == timerHeapCount) return;
+	h[i] = h[timerHeapCount];
+	jsiTimerHeapSiftDown(h, i);
+	jsiTimerHeapSiftUp(h, i);
+}
+
+/// Return the index in the heap of the given timer object, or -1
+static int jsiTimerHeapFind(JsiTimerHeapEntry *h, JsVar *timerPtr) {
+	JsVarRef ref = jsvGetRef(timerPtr);
+	unsigned int i;
+	for (i=0;i<timerHeapCount;i++)
+		if (jsiTimerHeapGetTimerRef(h[i].timer) == ref)
+			return (int)i;
+	return -1;
+}
+
+/** Add a timer (given the timer's name in timerArray) to the heap. Returns false if out of memory.
+ * The name must be locked, as growing the heap may compact memory, which moves anything unlocked */
+static bool jsiTimerHeapPush(JsVar *timerName, JsSysTime time) {
+	JsVar *heap = timerHeap ? jsvLock(timerHeap) : 0;
+	size_t size = heap ? jsvGetStringLength(heap)/sizeof(JsiTimerHeapEntry) : 0;
+	if (timerHeapCount >= size) {
+		// it's full - make a new one twice the size
+		size_t newSize = size ? size*2 : JSI_TIMER_HEAP_MIN_SIZE;
+		JsVar *newHeap = jsvNewFlatStringOfLength((unsigned int)(newSize*sizeof(JsiTimerHeapEntry)));
+		if (!newHeap) {
+			jsvUnLock(heap);
+			return false;
+		}
+		if (heap)
+			memcpy(jsiTimerHeapEntries(newHeap), jsiTimerHeapEntries(heap), timerHeapCount*sizeof(JsiTimerHeapEntry));
+		jsvUnLock(heap);
+		if (!jsvObjectSetChild(execInfo.hiddenRoot, JSI_TIMER_HEAP_NAME, newHeap)) { // no unlock
+			jsvUnLock(newHeap);
+			return false;
+		}
+		timerHeap = jsvGetRef(newHeap);
+		heap = newHeap;
+	}
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(heap);
+	h[timerHeapCount].time = time;
+	h[timerHeapCount].timer = jsvGetRef(timerName);
+	jsiTimerHeapSiftUp(h, timerHeapCount++);
+	jsvUnLock(heap);
+	return true;
+}
+
+/** If the first timer in the heap is due at or before 'time', remove it and
+ * return its (locked) name in timerArray, and put the time it was due in dueTime */
+static JsVar *jsiTimerHeapPopDue(JsSysTime time, JsSysTime *dueTime) {
+	if (!timerHeapCount) return 0;
+	JsVar *heap = jsvLock(timerHeap);
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(heap);
+	JsVar *timerName = 0;
+	if (h[0].time <= time) {
+		*dueTime = h[0].time;
+		timerName = jsvLock(h[0].timer);
+		jsiTimerHeapRemoveAt(h, 0);
+	}
+	jsvUnLock(heap);
+	return timerName;
+}
+
+/// Get the time until the next timer is due (relative to 'time'), or JSSYSTIME_MAX if there are none
+static JsSysTime jsiTimerHeapGetTimeUntilNext(JsSysTime time) {
+	if (!timerHeapCount) return JSSYSTIME_MAX;
+	JsVar *heap = jsvLock(timerHeap);
+	JsSysTime t = jsiTimerHeapEntries(heap)[0].time - time;
+	jsvUnLock(heap);
+	return t;
+}
+
+/// Empty the timer heap, and free the memory it used
+static void jsiTimerHeapClear() {
+	timerHeapCount = 0;
+	timerRunning = 0;
+	if (timerHeap) {
+		jsvRemoveNamedChild(execInfo.hiddenRoot, JSI_TIMER_HEAP_NAME);
+		timerHeap = 0;
+	}
+}
+
+/** Add a timer object to timerArray, to be run at the given (absolute) time.
+ * Returns the timer's ID, or -1 if there wasn't enough memory */
+JsVarInt jsiTimerAdd(JsVar *timerPtr, JsSysTime time) {
+	JsVar *timerArrayPtr = jsvLock(timerArray);
+	JsVarInt itemIndex = jsvArrayAddToEnd(timerArrayPtr, timerPtr, 1) - 1;
+	if (itemIndex>=0) {
+		JsVar *timerName = jsvLock(jsvGetLastChild(timerArrayPtr));
+		if (!jsiTimerHeapPush(timerName, time)) {
+			jsvUnLock(jsvArrayPop(timerArrayPtr)); // out of memory - we'd never run it, so remove it
+			itemIndex = -1;
+		}
+		jsvUnLock(timerName);
+	}
+	jsvUnLock(timerArrayPtr);
+	return itemIndex;
+}
+
+/// Call when a timer has been removed from timerArray, so we stop trying to run it
+void jsiTimerRemove(JsVar *timerPtr) {
+	if (timerRunning && jsiTimerHeapGetTimerRef(timerRunning)==jsvGetRef(timerPtr)) {
+		timerRunning = 0;
+		return;
+	}
+	if (!timerHeapCount) return;
+	JsVar *heap = jsvLock(timerHeap);
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(heap);
+	int i = jsiTimerHeapFind(h, timerPtr);
+	if (i>=0) jsiTimerHeapRemoveAt(h, (unsigned int)i);
+	jsvUnLock(heap);
+}
+
+/// Call when all timers have been removed from timerArray
+void jsiTimerRemoveAll() {
+	timerHeapCount = 0;
+	timerRunning = 0;
+}
+
+/// Get the absolute time at which the given timer is due (or JSSYSTIME_MAX if it isn't waiting)
+JsSysTime jsiTimerGetTime(JsVar *timerPtr) {
+	JsSysTime time = JSSYSTIME_MAX;
+	if (!timerHeapCount) return time;
+	JsVar *heap = jsvLock(timerHeap);
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(heap);
+	int i = jsiTimerHeapFind(h, timerPtr);
+	if (i>=0) time = h[i].time;
+	jsvUnLock(heap);
+	return time;
+}
+
+/** Change the absolute time at which the given timer is due. If the timer is
+ * currently being run then it's rescheduled afterwards anyway, so nothing happens. */
+void jsiTimerSetTime(JsVar *timerPtr, JsSysTime time) {
+	if (!timerHeapCount) return;
+	JsVar *heap = jsvLock(timerHeap);
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(heap);
+	int i = jsiTimerHeapFind(h, timerPtr);
+	if (i>=0) {
+		h[i].time = time;
+		jsiTimerHeapSiftDown(h, (unsigned int)i);
+		jsiTimerHeapSiftUp(h, (unsigned int)i);
+	}
+	jsvUnLock(heap);
+}
+
+/// Update the references held in the timer heap after vars have been moved (see jsvCompact)
+void jsiRemapTimerHeap(JsVarRef (*getNewRef)(JsVarRef ref)) {
+	timerRunning = getNewRef(timerRunning);
+	if (!timerHeapCount) return;
+	JsiTimerHeapEntry *h = jsiTimerHeapEntries(_jsvGetAddressOf(timerHeap));
+	unsigned int i;
+	for (i=0;i<timerHeapCount;i++)
+		h[i].timer = getNewRef(h[i].timer);
+}
+
+/// (Re)build the timer heap from the times stored in the timers in timerArray (relative to 'time')
+static void jsiTimerHeapLoad(JsSysTime time) {
+	jsiTimerHeapClear();
+	if (!timerArray) return;
+	JsVar *timerArrayPtr = jsvLock(timerArray);
+	JsvObjectIterator it;
+	jsvObjectIteratorNew(&it, timerArrayPtr);
+	while (jsvObjectIteratorHasValue(&it)) {
+		JsVar *timerName = jsvObjectIteratorGetKey(&it);
+		JsVar *timerPtr = jsvSkipName(timerName);
+		JsSysTime timerTime = (JsSysTime)jsvGetLongIntegerAndUnLock(jsvObjectGetChild(timerPtr, "time", 0));
+		jsvRemoveNamedChild(timerPtr, "time"); // the heap has it now
+		if (!jsiTimerHeapPush(timerName, time + timerTime))
+			jsError("Not enough memory to restore timers");
+		jsvUnLock(timerPtr);
+		jsvUnLock(timerName);
+		jsvObjectIteratorNext(&it);
+	}
+	jsvObjectIteratorFree(&it);
+	jsvUnLock(timerArrayPtr);
+}
+
+/// Store the time each timer is due (relative to 'time') in the timer itself, and empty the timer heap
+static void jsiTimerHeapStore(JsSysTime time) {
+	while (timerHeapCount) {
+		JsSysTime timerTime;
+		JsVar *timerName = jsiTimerHeapPopDue(JSSYSTIME_MAX, &timerTime);
+		JsVar *timerPtr = jsvSkipName(timerName);
+		jsvUnLock(jsvObjectSetChild(timerPtr, "time", jsvNewFromLongInteger((long long)(timerTime - time))));
+		jsvUnLock(timerPtr);
+		jsvUnLock(timerName);
+	}
+	jsiTimerHeapClear();
+}
+
+/* So that a pin event doesn't have to look at every watch (and look up all
+ * its settings), we also keep an index of the watches in watchArray, sorted
+ * by pin - watches on the same pin stay in the order they were added. Each
+ * entry refers to the watch's *name* in watchArray, and caches the settings
+ * that never change once the watch has been made.
+ *
+ * Like the timer heap, it's stored in a flat string referenced from
+ * hiddenRoot. It isn't saved - it's rebuilt from watchArray in jsiSoftInit. */
+typedef struct {
+	JsVarRef watch; ///< The watch's name in watchArray
+	Pin pin;
+	JsVarInt debounce; ///< Debounce time (in system time units), or 0
+	signed char edge; ///< 1 for rising, -1 for falling, 0 for both
+	bool recur;
+} PACKED_FLAGS JsiWatchIndexEntry; // packed, as flat string data is only 4 byte aligned
+
+static unsigned int watchIndexCount = 0; ///< Number of entries in watchIndex
+
+#define JSI_WATCH_INDEX_NAME "watchIndex"
+#define JSI_WATCH_INDEX_MIN_SIZE 4 // Number of entries to allocate space for initially
+
+static ALWAYS_INLINE JsiWatchIndexEntry *jsiWatchIndexEntries(JsVar *index) {
+	return (JsiWatchIndexEntry*)jsvGetFlatStringPointer(index);
+}
+
+/// Return the index of the first entry whose pin is >= the given one
+static unsigned int jsiWatchIndexLowerBound(JsiWatchIndexEntry *w, Pin pin) {
+	unsigned int lo = 0, hi = watchIndexCount;
+	while (lo < hi) {
+		unsigned int mid = (lo+hi)/2;
+		if (w[mid].pin < pin) lo = mid+1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+/// Return the index of the entry for the given watch name (on the given pin), or -1
+static int jsiWatchIndexFind(JsiWatchIndexEntry *w, Pin pin, JsVarRef watchName) {
+	unsigned int i;
+	for (i=jsiWatchIndexLowerBound(w, pin); i<watchIndexCount && w[i].pin==pin; i++)
+		if (w[i].watch == watchName)
+			return (int)i;
+	return -1;
+}
+
+/// Add a watch (given its name in watchArray) to the index. Returns false if out of memory
+static bool jsiWatchIndexAdd(JsVar *watchName) {
+	JsVar *index = watchIndex ? jsvLock(watchIndex) : 0;
+	size_t size = index ? jsvGetStringLength(index)/sizeof(JsiWatchIndexEntry) : 0;
+	if (watchIndexCount >= size) {
+		// it's full - make a new one twice the size
+		size_t newSize = size ? size*2 : JSI_WATCH_INDEX_MIN_SIZE;
+		JsVar *newIndex = jsvNewFlatStringOfLength((unsigned int)(newSize*sizeof(JsiWatchIndexEntry)));
+		if (!newIndex) {
+			jsvUnLock(index);
+			return false;
+		}
+		if (index)
+			memcpy(jsiWatchIndexEntries(newIndex), jsiWatchIndexEntries(index), watchIndexCount*sizeof(JsiWatchIndexEntry));
+		jsvUnLock(index);
+		if (!jsvObjectSetChild(execInfo.hiddenRoot, JSI_WATCH_INDEX_NAME, newIndex)) { // no unlock
+			jsvUnLock(newIndex);
+			return false;
+		}
+		watchIndex = jsvGetRef(newIndex);
+		index = newIndex;
+	}
+	JsVar *watchPtr = jsvSkipName(watchName);
+	JsiWatchIndexEntry e;
+	e.watch = jsvGetRef(watchName);
+	e.pin = jshGetPinFromVarAndUnLock(jsvObjectGetChild(watchPtr, "pin", 0));
+	e.debounce = jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "debounce", 0));
+	e.edge = (signed char)jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "edge", 0));
+	e.recur = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr, "recur", 0));
+	jsvUnLock(watchPtr);
+	// insert after any other watches on the same pin
+	JsiWatchIndexEntry *w = jsiWatchIndexEntries(index);
+	unsigned int i = jsiWatchIndexLowerBound(w, e.pin);
+	while (i<watchIndexCount && w[i].pin==e.pin) i++;
+	memmove(&w[i+1], &w[i], (watchIndexCount-i)*sizeof(JsiWatchIndexEntry));
+	w[i] = e;
+	watchIndexCount++;
+	jsvUnLock(index);
+	return true;
+}
+
+/// Empty the watch index, and free the memory it used
+static void jsiWatchIndexClear() {
+	watchIndexCount = 0;
+	if (watchIndex) {
+		jsvRemoveNamedChild(execInfo.hiddenRoot, JSI_WATCH_INDEX_NAME);
+		watchIndex = 0;
+	}
+}
+
+/** Add a watch object to watchArray. Returns the watch's ID, or -1 if there
+ * wasn't enough memory */
+JsVarInt jsiWatchAdd(JsVar *watchPtr) {
+	if (!watchPtr) return -1;
+	JsVar *watchArrayPtr = jsvLock(watchArray);
+	JsVarInt itemIndex = jsvArrayAddToEnd(watchArrayPtr, watchPtr, 1) - 1;
+	if (itemIndex>=0) {
+		JsVar *watchName = jsvLock(jsvGetLastChild(watchArrayPtr));
+		if (!jsiWatchIndexAdd(watchName)) {
+			jsvRemoveChild(watchArrayPtr, watchName); // out of memory - we'd never run it, so remove it
+			itemIndex = -1;
+		}
+		jsvUnLock(watchName);
+	}
+	jsvUnLock(watchArrayPtr);
+	return itemIndex;
+}
+
+/** Remove a watch (given its name in watchArray), and stop watching its pin
+ * if nothing else is. Does nothing if the watch has already been removed. */
+void jsiWatchRemove(JsVar *watchName) {
+	if (!watchIndexCount) return;
+	JsVar *watchPtr = jsvSkipName(watchName);
+	Pin pin = jshGetPinFromVarAndUnLock(jsvObjectGetChild(watchPtr, "pin", 0));
+	jsvUnLock(watchPtr);
+	JsVar *index = jsvLock(watchIndex);
+	JsiWatchIndexEntry *w = jsiWatchIndexEntries(index);
+	int i = jsiWatchIndexFind(w, pin, jsvGetRef(watchName));
+	if (i>=0) {
+		watchIndexCount--;
+		memmove(&w[i], &w[i+1], (watchIndexCount-(unsigned int)i)*sizeof(JsiWatchIndexEntry));
+	}
+	jsvUnLock(index);
+	if (i<0) return;
+	JsVar *watchArrayPtr = jsvLock(watchArray);
+	jsvRemoveChild(watchArrayPtr, watchName);
+	jsvUnLock(watchArrayPtr);
+	if (!jsiIsWatchingPin(pin))
+		jshPinWatch(pin, false); // 'unwatch' pin
+}
+
+/// Remove all watches, and stop watching their pins
+void jsiWatchRemoveAll() {
+	if (watchIndexCount) {
+		JsVar *index = jsvLock(watchIndex);
+		JsiWatchIndexEntry *w = jsiWatchIndexEntries(index);
+		unsigned int i;
+		for (i=0;i<watchIndexCount;i++)
+			if (i==0 || w[i].pin!=w[i-1].pin)
+				jshPinWatch(w[i].pin, false);
+		jsvUnLock(index);
+	}
+	jsiWatchIndexClear();
+	JsVar *watchArrayPtr = jsvLock(watchArray);
+	jsvRemoveAllChildren(watchArrayPtr);
+	jsvUnLock(watchArrayPtr);
+}
+
+bool jsiIsWatchingPin(Pin pin) {
+	if (!watchIndexCount) return false;
+	JsVar *index = jsvLock(watchIndex);
+	JsiWatchIndexEntry *w = jsiWatchIndexEntries(index);
+	unsigned int i = jsiWatchIndexLowerBound(w, pin);
+	bool isWatched = i<watchIndexCount && w[i].pin==pin;
+	jsvUnLock(index);
+	return isWatched;
+}
+
+/// Update the references held in the watch index after vars have been moved (see jsvCompact)
+void jsiRemapWatchIndex(JsVarRef (*getNewRef)(JsVarRef ref)) {
+	if (!watchIndexCount) return;
+	JsiWatchIndexEntry *w = jsiWatchIndexEntries(_jsvGetAddressOf(watchIndex));
+	unsigned int i;
+	for (i=0;i<watchIndexCount;i++)
+		w[i].watch = getNewRef(w[i].watch);
+}
+
+/* Events waiting to be executed are kept in a fixed-size ring of var
+ * references, so queueing one doesn't have to allocate any vars. Each event
+ * takes up 3 + argCount consecutive slots (wrapping around at the end):
+ *
+ *   function, this, argCount, arg0, arg1, ...
+ *
+ * Every var in the ring has been jsvRef'd. Nothing else references the ring,
+ * so the garbage collector asks us to mark it (jsiMarkEvents). */
+static JsVarRef eventQueue[EVENTQUEUE_SLOTS];
+static unsigned int eventQueueHead = 0; ///< The slot the next event will be written to
+static unsigned int eventQueueTail = 0; ///< The slot the next event to execute starts at
+static unsigned int eventQueueSlotsUsed = 0;
+static unsigned int eventQueueCount = 0; ///< Number of events in the queue
+static unsigned int eventQueueMaxCount = 0; ///< The most events that have been in the queue at once
+
+static ALWAYS_INLINE void jsiEventQueuePush(JsVarRef ref) {
+	eventQueue[eventQueueHead] = ref;
+	eventQueueHead = (eventQueueHead+1) % EVENTQUEUE_SLOTS;
+	eventQueueSlotsUsed++;
+}
+
+static ALWAYS_INLINE JsVarRef jsiEventQueuePop() {
+	JsVarRef ref = eventQueue[eventQueueTail];
+	eventQueueTail = (eventQueueTail+1) % EVENTQUEUE_SLOTS;
+	eventQueueSlotsUsed--;
+	return ref;
+}
+
+static ALWAYS_INLINE void jsiEventQueuePushVar(JsVar *var) {
+	jsiEventQueuePush(var ? jsvGetRef(jsvRef(var)) : 0);
+}
+
+/// Take a var out of the queue, returning it locked (or 0)
+static JsVar *jsiEventQueuePopVar() {
+	JsVarRef ref = jsiEventQueuePop();
+	if (!ref) return 0;
+	JsVar *var = jsvLock(ref);
+	jsvUnRef(var);
+	return var;
+}
+
+/// Add an event to the queue. Returns false (and sets JSERR_EVENT_QUEUE_FULL) if there's no space
+static bool jsiEventQueueAdd(JsVar *func, JsVar *thisArg, JsVar **args, int argCount) {
+	if (eventQueueSlotsUsed + 3 + (unsigned int)argCount > EVENTQUEUE_SLOTS) {
+		jsErrorFlags |= JSERR_EVENT_QUEUE_FULL;
+		return false;
+	}
+	jsiEventQueuePushVar(func);
+	jsiEventQueuePushVar(thisArg);
+	jsiEventQueuePush((JsVarRef)argCount);
+	int i;
+	for (i=0;i<argCount;i++)
+		jsiEventQueuePushVar(args[i]);
+	eventQueueCount++;
+	if (eventQueueCount > eventQueueMaxCount)
+		eventQueueMaxCount = eventQueueCount;
+	return true;
+}
+
+/// Take the first event from the queue and execute it
+static NO_INLINE void jsiEventQueueExecuteFirst() {
+	JsVar *func = jsiEventQueuePopVar();
+	JsVar *thisArg = jsiEventQueuePopVar();
+	int argCount = (int)jsiEventQueuePop();
+	JsVar **args = (JsVar**)alloca(sizeof(JsVar*)*(size_t)(argCount?argCount:1));
+	int i;
+	for (i=0;i<argCount;i++)
+		args[i] = jsiEventQueuePopVar();
+	eventQueueCount--;
+
+	// now run..
+	if (func) {
+		if (jsvIsFunction(func))
+			jsvUnLock(jspExecuteFunction(func, thisArg, argCount, args));
+		else if (jsvIsString(func))
+			jsvUnLock(jspEvaluateVar(func, 0, false));
+		else
+			jsError("Unknown type of callback in Event Queue");
+	}
+	jsvUnLock(func);
+	jsvUnLock(thisArg);
+	for (i=0;i<argCount;i++)
+		jsvUnLock(args[i]);
+}
+
+/// Remove all events from the queue without executing them
+static void jsiEventQueueClear() {
+	while (eventQueueCount) {
+		jsvUnLock(jsiEventQueuePopVar()); // function
+		jsvUnLock(jsiEventQueuePopVar()); // this
+		int argCount = (int)jsiEventQueuePop();
+		while (argCount--)
+			jsvUnLock(jsiEventQueuePopVar());
+		eventQueueCount--;
+	}
+	assert(!eventQueueSlotsUsed);
+	eventQueueHead = eventQueueTail = 0;
+}
+
+/// Call markRef for every var referenced from the event queue (used by the garbage collector)
+void jsiMarkEvents(void (*markRef)(JsVarRef ref)) {
+	unsigned int slot = eventQueueTail;
+	unsigned int n;
+	for (n=0;n<eventQueueCount;n++) {
+		unsigned int argCount = (unsigned int)eventQueue[(slot+2) % EVENTQUEUE_SLOTS];
+		unsigned int i;
+		for (i=0;i<3+argCount;i++) {
+			if (i!=2 && eventQueue[slot]) markRef(eventQueue[slot]);
+			slot = (slot+1) % EVENTQUEUE_SLOTS;
+		}
+	}
+}
+
+/// Update the references held in the event queue after vars have been moved (see jsvCompact)
+void jsiRemapEvents(JsVarRef (*getNewRef)(JsVarRef ref)) {
+	unsigned int slot = eventQueueTail;
+	unsigned int n;
+	for (n=0;n<eventQueueCount;n++) {
+		unsigned int argCount = (unsigned int)eventQueue[(slot+2) % EVENTQUEUE_SLOTS];
+		unsigned int i;
+		for (i=0;i<3+argCount;i++) {
+			if (i!=2 && eventQueue[slot]) eventQueue[slot] = getNewRef(eventQueue[slot]);
+			slot = (slot+1) % EVENTQUEUE_SLOTS;
+		}
+	}
+}
+
+/// The number of events waiting to be executed
+unsigned int jsiGetEventCount() {
+	return eventQueueCount;
+}
+
+/// The most events that have been waiting to be executed at once
+unsigned int jsiGetMaxEventCount() {
+	return eventQueueMaxCount;
+}
+
 // Used when recovering after being flashed
 // 'claim' anything we are using
 void jsiSoftInit() {
 	jswInit();
 
 	jsErrorFlags = 0;
-	events = jsvNewWithFlags(JSV_ARRAY);
 	inputLine = jsvNewFromEmptyString();
 	inputCursorPos = 0;
 	jsiInputLineCursorMoved();
@@ -390,6 +944,8 @@ void jsiSoftInit() {
 	// Load timer/watch arrays
 	timerArray = _jsiInitNamedArray(JSI_TIMERS_NAME);
 	watchArray = _jsiInitNamedArray(JSI_WATCHES_NAME);
+	// Timers store the time they're due relative to when they were saved
+	jsiTimerHeapLoad(jshGetSystemTime());
 
 	// Now run initialisation code
 	JsVar *initCode = jsvObjectGetChild(execInfo.hiddenRoot, JSI_INIT_CODE_NAME, 0);
@@ -399,26 +955,30 @@ void jsiSoftInit() {
 		jsvRemoveNamedChild(execInfo.hiddenRoot, JSI_INIT_CODE_NAME);
 	}
 
-	// Check any existing watches and set up interrupts for them
+	// Check any existing watches, index them and set up interrupts for them
 	if (watchArray) {
 		JsVar *watchArrayPtr = jsvLock(watchArray);
 		JsvObjectIterator it;
 		jsvObjectIteratorNew(&it, watchArrayPtr);
 		while (jsvObjectIteratorHasValue(&it)) {
-			JsVar *watch = jsvObjectIteratorGetValue(&it);
-			JsVar *watchPin = jsvObjectGetChild(watch, "pin", 0);
-			jshPinWatch(jshGetPinFromVar(watchPin), true);
-			jsvUnLock(watchPin);
-			jsvUnLock(watch);
-			jsvObjectIteratorNext(&it);
+			JsVar *watchName = jsvObjectIteratorGetKey(&it);
+			if (jsiWatchIndexAdd(watchName)) {
+				JsVar *watch = jsvSkipName(watchName);
+				JsVar *watchPin = jsvObjectGetChild(watch, "pin", 0);
+				jshPinWatch(jshGetPinFromVar(watchPin), true);
+				jsvUnLock(watchPin);
+				jsvUnLock(watch);
+				jsvObjectIteratorNext(&it);
+			} else { // we'd never run it, so remove it
+				jsError("Not enough memory to restore watches");
+				jsvObjectIteratorRemoveAndGotoNext(&it, watchArrayPtr);
+			}
+			jsvUnLock(watchName);
 		}
 		jsvObjectIteratorFree(&it);
 		jsvUnLock(watchArrayPtr);
 	}
 
-	// Timers are stored by time in the future now, so no need
-	// to fiddle with them.
-
 	// Make sure we set up lastIdleTime, as this could be used
 	// when adding an interval from onInit (called below)
 	jsiLastIdleTime = jshGetSystemTime();
@@ -548,14 +1108,14 @@ void jsiSoftKill() {
 	// Stop all active timer tasks
 	jstReset();
 	// Unref Watches/etc
-	if (events) {
-		jsvUnLock(events);
-		events=0;
-	}
+	jsiEventQueueClear();
 	if (timerArray) {
+		// store the time each timer is due in the timer itself, so they get saved
+		jsiTimerHeapStore(jsiLastIdleTime);
 		jsvUnRefRef(timerArray);
 		timerArray=0;
 	}
+	jsiWatchIndexClear();
 	if (watchArray) {
 		// Check any existing watches and disable interrupts for them
 		JsVar *watchArrayPtr = jsvLock(watchArray);
@@ -666,6 +1226,14 @@ int jsiCountBracketsInInput() {
 
 /// Tries to get rid of some memory (by clearing command history). Returns true if it got rid of something, false if it didn't.
 bool jsiFreeMoreMemory() {
+	// pre-tokenised function code is only there for speed - functions can just be lexed
+	if (jspFreeTokenCaches()) return true;
+	// the field cache holds on to the names it found
+	if (jspClearFieldCache()) return true;
+	// and function calls keep their old scopes to reuse
+	if (jspClearFramePool()) return true;
+	// built-in functions are kept so they can be given out again
+	if (jsvClearNativeFunctionCache()) return true;
 	JsVar *history = jsvObjectGetChild(execInfo.hiddenRoot, JSI_HISTORY_NAME, 0);
 	if (!history) return 0;
 	JsVar *item = jsvArrayPopFirst(history);
@@ -1111,31 +1679,12 @@ void jsiHandleChar(char ch) {
 	//jsiConsolePrint("end for handle char !\n");
 }
 
-void jsiQueueEventInternal(JsVar *callbackFunc, JsVar **args, int argCount) {
-	assert(argCount<10);
-	assert(jsvIsFunction(callbackFunc) || jsvIsString(callbackFunc));
-
-	JsVar *event = jsvNewWithFlags(JSV_OBJECT);
-	if (event) { // Could be out of memory error!
-		jsvUnLock(jsvAddNamedChild(event, callbackFunc, "func"));
-
-		int i;
-		for (i=0;i<argCount;i++) {
-			char argName[5] = "arg#";
-			argName[3] = (char)('0'+i);
-			jsvUnLock(jsvAddNamedChild(event, args[i], argName));
-		}
-
-		jsvArrayPushAndUnLock(events, event);
-	}
-}
-
 /// Queue a function, string, or array (of funcs/strings) to be executed next time around the idle loop
-void jsiQueueEvents(JsVar *callback, JsVar **args, int argCount) { // an array of functions, a string, or a single function
+void jsiQueueEvents(JsVar *object, JsVar *callback, JsVar **args, int argCount) { // an array of functions, a string, or a single function
 	if (!callback) return;
 	// if it is a single callback, just add it
 	if (jsvIsFunction(callback) || jsvIsString(callback)) {
-		jsiQueueEventInternal(callback, args, argCount);
+		jsiEventQueueAdd(callback, object, args, argCount);
 	} else {
 		assert(jsvIsArray(callback));
 
@@ -1143,7 +1692,8 @@ void jsiQueueEvents(JsVar *callback, JsVar **args, int argCount) { // an array o
 		jsvObjectIteratorNew(&it, callback);
 		while (jsvObjectIteratorHasValue(&it)) {
 			JsVar *callbackFunc = jsvObjectIteratorGetValue(&it);
-			jsiQueueEventInternal(callbackFunc, args, argCount);
+			assert(jsvIsFunction(callbackFunc) || jsvIsString(callbackFunc));
+			jsiEventQueueAdd(callbackFunc, object, args, argCount);
 			jsvUnLock(callbackFunc);
 			jsvObjectIteratorNext(&it);
 		}
@@ -1161,40 +1711,16 @@ bool jsiObjectHasCallbacks(JsVar *object, const char *callbackName) {
 void jsiQueueObjectCallbacks(JsVar *object, const char *callbackName, JsVar **args, int argCount) {
 	JsVar *callback = jsvObjectGetChild(object, callbackName, 0);
 	if (!callback) return;
-	jsiQueueEvents(callback, args, argCount);
+	jsiQueueEvents(object, callback, args, argCount);
 	jsvUnLock(callback);
 }
 
 void jsiExecuteEvents() {
-	bool hasEvents = !jsvArrayIsEmpty(events);
+	bool hasEvents = eventQueueCount>0;
 	bool wasInterrupted = jspIsInterrupted();
 	if (hasEvents) jsiSetBusy(BUSY_INTERACTIVE, true);
-	while (!jsvArrayIsEmpty(events)) {
-		JsVar *event = jsvSkipNameAndUnLock(jsvArrayPopFirst(events));
-		// Get function to execute
-		JsVar *func = jsvObjectGetChild(event, "func", 0);
-		JsVar *args[2];
-		// TODO: make this faster by iterating over the children (and support varying numbers of args)
-		args[0] = jsvObjectGetChild(event, "arg0", 0);
-		args[1] = jsvObjectGetChild(event, "arg1", 0);
-		// free
-		jsvUnLock(event);
-
-
-		// now run..
-		if (func) {
-			if (jsvIsFunction(func))
-				jsvUnLock(jspExecuteFunction(func, 0, 2, args));
-			else if (jsvIsString(func))
-				jsvUnLock(jspEvaluateVar(func, 0, false));
-			else
-				jsError("Unknown type of callback in Event Queue");
-		}
-		//jsPrint("Event Done\n");
-		jsvUnLock(func);
-		jsvUnLock(args[0]);
-		jsvUnLock(args[1]);
-	}
+	while (eventQueueCount)
+		jsiEventQueueExecuteFirst();
 	if (hasEvents) {
 		jsiSetBusy(BUSY_INTERACTIVE, false);
 		if (!wasInterrupted && jspIsInterrupted())
@@ -1242,31 +1768,16 @@ bool jsiHasTimers() {
 	return hasTimers;
 }
 
-/// Is the given watch object meant to be executed when the current value of the pin is pinIsHigh
-bool jsiShouldExecuteWatch(JsVar *watchPtr, bool pinIsHigh) {
-	int watchEdge = (int)jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "edge", 0));
+/// Is a watch with the given edge meant to be executed when the current value of the pin is pinIsHigh
+static bool jsiShouldExecuteWatchEdge(int watchEdge, bool pinIsHigh) {
 	return watchEdge==0 || // any edge
 			(pinIsHigh && watchEdge>0) || // rising edge
 			(!pinIsHigh && watchEdge<0); // falling edge
 }
 
-bool jsiIsWatchingPin(Pin pin) {
-	bool isWatched = false;
-	JsVar *watchArrayPtr = jsvLock(watchArray);
-	JsvObjectIterator it;
-	jsvObjectIteratorNew(&it, watchArrayPtr);
-	while (jsvObjectIteratorHasValue(&it)) {
-		JsVar *watchPtr = jsvObjectIteratorGetValue(&it);
-		JsVar *pinVar = jsvObjectGetChild(watchPtr, "pin", 0);
-		if (jshGetPinFromVar(pinVar) == pin)
-			isWatched = true;
-		jsvUnLock(pinVar);
-		jsvUnLock(watchPtr);
-		jsvObjectIteratorNext(&it);
-	}
-	jsvObjectIteratorFree(&it);
-	jsvUnLock(watchArrayPtr);
-	return isWatched;
+/// Is the given watch object meant to be executed when the current value of the pin is pinIsHigh
+bool jsiShouldExecuteWatch(JsVar *watchPtr, bool pinIsHigh) {
+	return jsiShouldExecuteWatchEdge((int)jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "edge", 0)), pinIsHigh);
 }
 
 void jsiHandleIOEventForUSART(JsVar *usartClass, IOEvent *event) {
@@ -1307,6 +1818,129 @@ void jsiHandleIOEventForUSART(JsVar *usartClass, IOEvent *event) {
 	}
 }
 
+/// Execute (or debounce) the watches on the given pin for a pin event
+static NO_INLINE void jsiHandleIOEventForWatch(Pin pin, IOEvent *event) {
+	if (!watchIndexCount) return;
+	/* Find the watches on this pin. Their callbacks may add or remove watches
+	 * (so the index can change), so lock the names of the watches we're going
+	 * to look at first. */
+	JsVar *index = jsvLock(watchIndex);
+	JsiWatchIndexEntry *w = jsiWatchIndexEntries(index);
+	unsigned int first = jsiWatchIndexLowerBound(w, pin);
+	unsigned int watchCount = 0;
+	while (first+watchCount<watchIndexCount && w[first+watchCount].pin==pin)
+		watchCount++;
+	JsVar **watchNames = (JsVar**)alloca(sizeof(JsVar*)*(watchCount?watchCount:1));
+	unsigned int n;
+	for (n=0;n<watchCount;n++)
+		watchNames[n] = jsvLock(w[first+n].watch);
+	jsvUnLock(index);
+
+	/** Work out event time. Events time is only stored in 32 bits, so we need to
+	 * use the correct 'high' 32 bits from the current time.
+	 *
+	 * We know that the current time is always newer than the event time, so
+	 * if the bottom 32 bits of the current time is less than the bottom
+	 * 32 bits of the event time, we need to subtract a full 32 bits worth
+	 * from the current time.
+	 */
+	JsSysTime time = jshGetSystemTime();
+	if (((unsigned int)time) < (unsigned int)event->data.time)
+		time = time - 0x100000000LL;
+	// finally, mask in the event's time
+	JsSysTime eventTime = (time & ~0xFFFFFFFFLL) | (JsSysTime)event->data.time;
+
+	for (n=0;n<watchCount;n++) {
+		JsVar *watchName = watchNames[n];
+		// an earlier callback may have removed this watch
+		JsiWatchIndexEntry watch;
+		bool found = false;
+		if (watchIndexCount) {
+			index = jsvLock(watchIndex);
+			w = jsiWatchIndexEntries(index);
+			int i = jsiWatchIndexFind(w, pin, jsvGetRef(watchName));
+			if (i>=0) {
+				watch = w[i];
+				found = true;
+			}
+			jsvUnLock(index);
+		}
+		if (!found) {
+			jsvUnLock(watchName);
+			continue;
+		}
+		JsVar *watchPtr = jsvSkipName(watchName);
+
+		// Now actually process the event
+		bool pinIsHigh = (event->flags&EV_EXTI_IS_HIGH)!=0;
+		JsSysTime watchEventTime = eventTime;
+
+		bool executeNow = false;
+		if (watch.debounce<=0) {
+			executeNow = true;
+		} else { // Debouncing - use timeouts to ensure we only fire at the right time
+			// store the current state of the pin
+			bool oldWatchState = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr, "state",0));
+			jsvUnLock(jsvObjectSetChild(watchPtr, "state", jsvNewFromBool(pinIsHigh)));
+
+			JsVar *timeout = jsvObjectGetChild(watchPtr, "timeout", 0);
+			if (timeout) { // if we had a timeout, update the callback time
+				JsSysTime timeoutTime = jsiTimerGetTime(timeout);
+				jsiTimerSetTime(timeout, watchEventTime + watch.debounce);
+				if (watchEventTime > timeoutTime) {
+					// timeout should have fired, but we didn't get around to executing it!
+					// Do it now (with the old timeout time)
+					executeNow = true;
+					watchEventTime = timeoutTime - watch.debounce;
+					pinIsHigh = oldWatchState;
+				}
+			} else { // else create a new timeout
+				timeout = jsvNewWithFlags(JSV_OBJECT);
+				if (timeout) {
+					jsvObjectSetChild(timeout, "watch", watchPtr); // no unlock
+					jsvUnLock(jsvObjectSetChild(timeout, "callback", jsvObjectGetChild(watchPtr, "callback", 0)));
+					jsvUnLock(jsvObjectSetChild(timeout, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
+					jsvUnLock(jsvObjectSetChild(timeout, "pin", jsvNewFromPin(pin)));
+					// Add to timer array, and our watch
+					if (jsiTimerAdd(timeout, watchEventTime + watch.debounce) >= 0)
+						jsvObjectSetChild(watchPtr, "timeout", timeout); // no unlock
+				}
+			}
+			jsvUnLock(timeout);
+		}
+
+		// If we want to execute this watch right now...
+		if (executeNow) {
+			JsVar *timePtr = jsvNewFromFloat(jshGetMillisecondsFromTime(watchEventTime)/1000);
+			if (jsiShouldExecuteWatchEdge(watch.edge, pinIsHigh)) { // edge triggering
+				JsVar *watchCallback = jsvObjectGetChild(watchPtr, "callback", 0);
+				bool watchRecurring = watch.recur;
+				JsVar *data = jsvNewWithFlags(JSV_OBJECT);
+				if (data) {
+					jsvUnLock(jsvObjectSetChild(data, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
+					// set both data.time, and watch.lastTime in one go
+					jsvObjectSetChild(data, "time", timePtr); // no unlock
+					jsvUnLock(jsvObjectSetChild(data, "pin", jsvNewFromPin(pin)));
+					jsvUnLock(jsvObjectSetChild(data, "state", jsvNewFromBool(pinIsHigh)));
+				}
+				if (!jsiExecuteEventCallback(watchCallback, data, 0) && watchRecurring) {
+					jsError("Error processing Watch - removing it.");
+					jsErrorFlags |= JSERR_CALLBACK;
+					watchRecurring = false;
+				}
+				jsvUnLock(data);
+				if (!watchRecurring)
+					jsiWatchRemove(watchName); // (does nothing if the callback removed it already)
+				jsvUnLock(watchCallback);
+			}
+			jsvUnLock(jsvObjectSetChild(watchPtr, "lastTime", timePtr));
+		}
+
+		jsvUnLock(watchPtr);
+		jsvUnLock(watchName);
+	}
+}
+
 void jsiIdle() {
 	// This is how many times we have been here and not done anything.
 	// It will be zeroed if we do stuff later
@@ -1353,110 +1987,7 @@ void jsiIdle() {
 			}
 			jsvUnLock(usartClass);
 		} else if (DEVICE_IS_EXTI(eventType)) { // ---------------------------------------------------------------- PIN WATCH
-			// we have an event... find out what it was for...
-			// Check everything in our Watch array
-			JsVar *watchArrayPtr = jsvLock(watchArray);
-			JsvObjectIterator it;
-			jsvObjectIteratorNew(&it, watchArrayPtr);
-			while (jsvObjectIteratorHasValue(&it)) {
-				bool hasDeletedWatch = false;
-				JsVar *watchPtr = jsvObjectIteratorGetValue(&it);
-				Pin pin = jshGetPinFromVarAndUnLock(jsvObjectGetChild(watchPtr, "pin", 0));
-
-				if (pin == isWatchingPin) {
-					/** Work out event time. Events time is only stored in 32 bits, so we need to
-					 * use the correct 'high' 32 bits from the current time.
-					 *
-					 * We know that the current time is always newer than the event time, so
-					 * if the bottom 32 bits of the current time is less than the bottom
-					 * 32 bits of the event time, we need to subtract a full 32 bits worth
-					 * from the current time.
-					 */
-					JsSysTime time = jshGetSystemTime();
-					if (((unsigned int)time) < (unsigned int)event.data.time)
-						time = time - 0x100000000LL;
-					// finally, mask in the event's time
-					JsSysTime eventTime = (time & ~0xFFFFFFFFLL) | (JsSysTime)event.data.time;
-
-					// Now actually process the event
-					bool pinIsHigh = (event.flags&EV_EXTI_IS_HIGH)!=0;
-
-					bool executeNow = false;
-					JsVarInt debounce = jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "debounce", 0));
-					if (debounce<=0) {
-						executeNow = true;
-					} else { // Debouncing - use timeouts to ensure we only fire at the right time
-						// store the current state of the pin
-						bool oldWatchState = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr, "state",0));
-						jsvUnLock(jsvObjectSetChild(watchPtr, "state", jsvNewFromBool(pinIsHigh)));
-
-						JsVar *timeout = jsvObjectGetChild(watchPtr, "timeout", 0);
-						if (timeout) { // if we had a timeout, update the callback time
-							JsSysTime timeoutTime = jsiLastIdleTime + (JsSysTime)jsvGetIntegerAndUnLock(jsvObjectGetChild(timeout, "time", 0));
-							jsvUnLock(jsvObjectSetChild(timeout, "time", jsvNewFromInteger((JsVarInt)(eventTime - jsiLastIdleTime) + debounce)));
-							if (eventTime > timeoutTime) {
-								// timeout should have fired, but we didn't get around to executing it!
-								// Do it now (with the old timeout time)
-								executeNow = true;
-								eventTime = timeoutTime - debounce;
-								pinIsHigh = oldWatchState;
-							}
-						} else { // else create a new timeout
-							timeout = jsvNewWithFlags(JSV_OBJECT);
-							if (timeout) {
-								jsvObjectSetChild(timeout, "watch", watchPtr); // no unlock
-								jsvUnLock(jsvObjectSetChild(timeout, "time", jsvNewFromInteger((JsVarInt)(eventTime - jsiLastIdleTime) + debounce)));
-								jsvUnLock(jsvObjectSetChild(timeout, "callback", jsvObjectGetChild(watchPtr, "callback", 0)));
-								jsvUnLock(jsvObjectSetChild(timeout, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
-								jsvUnLock(jsvObjectSetChild(timeout, "pin", jsvNewFromPin(pin)));
-								// Add to timer array
-								jsiTimerAdd(timeout);
-								// Add to our watch
-								jsvObjectSetChild(watchPtr, "timeout", timeout); // no unlock
-							}
-						}
-						jsvUnLock(timeout);
-					}
-
-					// If we want to execute this watch right now...
-					if (executeNow) {
-						JsVar *timePtr = jsvNewFromFloat(jshGetMillisecondsFromTime(eventTime)/1000);
-						if (jsiShouldExecuteWatch(watchPtr, pinIsHigh)) { // edge triggering
-							JsVar *watchCallback = jsvObjectGetChild(watchPtr, "callback", 0);
-							bool watchRecurring = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr,  "recur", 0));
-							JsVar *data = jsvNewWithFlags(JSV_OBJECT);
-							if (data) {
-								jsvUnLock(jsvObjectSetChild(data, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
-								// set both data.time, and watch.lastTime in one go
-								jsvObjectSetChild(data, "time", timePtr); // no unlock
-								jsvUnLock(jsvObjectSetChild(data, "pin", jsvNewFromPin(pin)));
-								jsvUnLock(jsvObjectSetChild(data, "state", jsvNewFromBool(pinIsHigh)));
-							}
-							if (!jsiExecuteEventCallback(watchCallback, data, 0) && watchRecurring) {
-								jsError("Error processing Watch - removing it.");
-								jsErrorFlags |= JSERR_CALLBACK;
-								watchRecurring = false;
-							}
-							jsvUnLock(data);
-							if (!watchRecurring) {
-								// free all
-								jsvObjectIteratorRemoveAndGotoNext(&it, watchArrayPtr);
-								hasDeletedWatch = true;
-								if (!jsiIsWatchingPin(pin))
-									jshPinWatch(pin, false);
-							}
-							jsvUnLock(watchCallback);
-						}
-						jsvUnLock(jsvObjectSetChild(watchPtr, "lastTime", timePtr));
-					}
-				}  //end for if (jshIsEventForPin(&event, pin))
-
-				jsvUnLock(watchPtr);
-				if (!hasDeletedWatch)
-					jsvObjectIteratorNext(&it);
-			}  // end for while
-			jsvObjectIteratorFree(&it);
-			jsvUnLock(watchArrayPtr);
+			jsiHandleIOEventForWatch(isWatchingPin, &event);
 		}  //end for if (DEVICE_IS_EXTI(eventType))
 	}  //end for while (maxEvents-- && jshPopIOEvent(&event))
 
@@ -1472,109 +2003,96 @@ void jsiIdle() {
 
 
 	// Check timers
-	JsSysTime minTimeUntilNext = JSSYSTIME_MAX;
 	JsSysTime time = jshGetSystemTime();
-	JsSysTime timePassed = (JsVarInt)(time - jsiLastIdleTime);
 	jsiLastIdleTime = time;
 
+	/* The heap gives us the timers in the order they're due, so we only look
+	 * at the ones we have to run. Intervals go back in, so don't run more
+	 * timers than there were to start with or we could be here forever. */
+	unsigned int timersToCheck = timerHeapCount;
 	JsVar *timerArrayPtr = jsvLock(timerArray);
-	JsvObjectIterator it;
-	jsvObjectIteratorNew(&it, timerArrayPtr);
-	while (jsvObjectIteratorHasValue(&it)) {
-		bool hasDeletedTimer = false;
-		JsVar *timerPtr = jsvObjectIteratorGetValue(&it);
-		JsSysTime timerTime = (JsSysTime)jsvGetLongIntegerAndUnLock(jsvObjectGetChild(timerPtr, "time", 0));
-		int timeUntilNext = timerTime - timePassed;
-		//jsiConsolePrintf("timeUntilNext1 = %d\n",timeUntilNext);
-		if (timeUntilNext < minTimeUntilNext)
-			minTimeUntilNext = timeUntilNext;
-		//jsiConsolePrintf("timeUntilNext<=0 = %d\n",timeUntilNext<=0);
-		if (timeUntilNext<=0) {
-			// we're now doing work
-			//jsiConsolePrintf("doing now!\n");
-			jsiSetBusy(BUSY_INTERACTIVE, true);
-			wasBusy = true;
-			JsVar *timerCallback = jsvObjectGetChild(timerPtr, "callback", 0);
-			//jsiConsolePrintf("callback = ",timerCallback);
-			JsVar *watchPtr = jsvObjectGetChild(timerPtr, "watch", 0); // for debounce - may be undefined
-			bool exec = true;
-			JsVar *data = jsvNewWithFlags(JSV_OBJECT);
-			if (data) {
-				// if we were from a watch then we were delayed by the debounce time...
-				JsVarInt delay = 0;
-				if (watchPtr)
-					delay = jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "debounce", 0));
-				// Create the 'time' variable that will be passed to the user
-				JsVar *timePtr = jsvNewFromFloat(jshGetMillisecondsFromTime(jsiLastIdleTime+timeUntilNext-delay)/1000);
-				// if it was a watch, set the last state up
-				if (watchPtr) {
-					bool state = jsvGetBoolAndUnLock(jsvObjectSetChild(data, "state", jsvObjectGetChild(watchPtr, "state", 0)));
-					exec = jsiShouldExecuteWatch(watchPtr, state);
-					// set up the lastTime variable of data to what was in the watch
-					jsvUnLock(jsvObjectSetChild(data, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
-					// set up the watches lastTime to this one
-					jsvObjectSetChild(watchPtr, "lastTime", timePtr); // don't unlock
-				}
-				jsvUnLock(jsvObjectSetChild(data, "time", timePtr));
+	JsSysTime timerTime;
+	JsVar *timerName;
+	while (timersToCheck-- && (timerName = jsiTimerHeapPopDue(time, &timerTime))) {
+		JsVar *timerPtr = jsvSkipName(timerName);
+		timerRunning = jsvGetRef(timerName);
+		// we're now doing work
+		jsiSetBusy(BUSY_INTERACTIVE, true);
+		wasBusy = true;
+		JsVar *timerCallback = jsvObjectGetChild(timerPtr, "callback", 0);
+		JsVar *watchPtr = jsvObjectGetChild(timerPtr, "watch", 0); // for debounce - may be undefined
+		bool exec = true;
+		JsVar *data = jsvNewWithFlags(JSV_OBJECT);
+		if (data) {
+			// if we were from a watch then we were delayed by the debounce time...
+			JsVarInt delay = 0;
+			if (watchPtr)
+				delay = jsvGetIntegerAndUnLock(jsvObjectGetChild(watchPtr, "debounce", 0));
+			// Create the 'time' variable that will be passed to the user
+			JsVar *timePtr = jsvNewFromFloat(jshGetMillisecondsFromTime(timerTime-delay)/1000);
+			// if it was a watch, set the last state up
+			if (watchPtr) {
+				bool state = jsvGetBoolAndUnLock(jsvObjectSetChild(data, "state", jsvObjectGetChild(watchPtr, "state", 0)));
+				exec = jsiShouldExecuteWatch(watchPtr, state);
+				// set up the lastTime variable of data to what was in the watch
+				jsvUnLock(jsvObjectSetChild(data, "lastTime", jsvObjectGetChild(watchPtr, "lastTime", 0)));
+				// set up the watches lastTime to this one
+				jsvObjectSetChild(watchPtr, "lastTime", timePtr); // don't unlock
 			}
-			JsVar *interval = jsvObjectGetChild(timerPtr, "interval", 0);
-			if (exec) {
-				//jsiConsolePrintf("doing callback!\n");
-				if (!jsiExecuteEventCallback(timerCallback, data, 0) && interval) {
-					jsError("Error processing interval - removing it.");
-					jsErrorFlags |= JSERR_CALLBACK;
-				}
+			jsvUnLock(jsvObjectSetChild(data, "time", timePtr));
+		}
+		JsVar *interval = jsvObjectGetChild(timerPtr, "interval", 0);
+		if (exec) {
+			if (!jsiExecuteEventCallback(timerCallback, data, 0) && interval) {
+				jsError("Error processing interval - removing it.");
+				jsErrorFlags |= JSERR_CALLBACK;
 			}
-			jsvUnLock(data);
-			if (watchPtr) { // if we had a watch pointer, be sure to remove us from it
-				jsvObjectSetChild(watchPtr, "timeout", 0);
-				// Deal with non-recurring watches
-				if (exec) {
-					bool watchRecurring = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr,  "recur", 0));
-					if (!watchRecurring) {
-						JsVar *watchArrayPtr = jsvLock(watchArray);
-						JsVar *watchNamePtr = jsvGetArrayIndexOf(watchArrayPtr, watchPtr, true);
-						if (watchNamePtr) {
-							jsvRemoveChild(watchArrayPtr, watchNamePtr);
-							jsvUnLock(watchNamePtr);
-						}
-						jsvUnLock(watchArrayPtr);
-						Pin pin = jshGetPinFromVarAndUnLock(jsvObjectGetChild(watchPtr, "pin", 0));
-						if (!jsiIsWatchingPin(pin))
-							jshPinWatch(pin, false);
+		}
+		jsvUnLock(data);
+		if (watchPtr) { // if we had a watch pointer, be sure to remove us from it
+			jsvObjectSetChild(watchPtr, "timeout", 0);
+			// Deal with non-recurring watches
+			if (exec) {
+				bool watchRecurring = jsvGetBoolAndUnLock(jsvObjectGetChild(watchPtr,  "recur", 0));
+				if (!watchRecurring) {
+					JsVar *watchArrayPtr = jsvLock(watchArray);
+					JsVar *watchNamePtr = jsvGetArrayIndexOf(watchArrayPtr, watchPtr, true);
+					jsvUnLock(watchArrayPtr);
+					if (watchNamePtr) {
+						jsiWatchRemove(watchNamePtr);
+						jsvUnLock(watchNamePtr);
 					}
 				}
-				jsvUnLock(watchPtr);
 			}
+			jsvUnLock(watchPtr);
+		}
 
+		// The callback may have removed this timer - if so timerRunning will have been cleared
+		if (timerRunning) {
+			// ... or it may have called changeInterval
+			jsvUnLock(interval);
+			interval = jsvObjectGetChild(timerPtr, "interval", 0);
 			if (interval) {
-				timeUntilNext = timeUntilNext + jsvGetLongIntegerAndUnLock(interval);
+				if (!jsiTimerHeapPush(timerName, timerTime + jsvGetLongInteger(interval)))
+					jsvRemoveChild(timerArrayPtr, timerName); // out of memory - can't run it again
 			} else {
-				// free
-				// Beware... may have already been removed!
-				jsvObjectIteratorRemoveAndGotoNext(&it, timerArrayPtr);
-				hasDeletedTimer = true;
-				minTimeUntilNext = 0; // make sure we don't sleep
-				// We'll sort it out next time around idle loop
+				jsvRemoveChild(timerArrayPtr, timerName);
 			}
-			jsvUnLock(timerCallback);
-
-		}  //end for if (timeUntilNext<=0)
-		// update the timer's time
-		if (!hasDeletedTimer) {
-			jsvUnLock(jsvObjectSetChild(timerPtr, "time", jsvNewFromLongInteger(timeUntilNext)));
-			jsvObjectIteratorNext(&it);
 		}
+		timerRunning = 0;
+		jsvUnLock(interval);
+		jsvUnLock(timerCallback);
 		jsvUnLock(timerPtr);
-	}  //end for while
-	jsvObjectIteratorFree(&it);
+		jsvUnLock(timerName);
+	}
 	jsvUnLock(timerArrayPtr);
+	JsSysTime minTimeUntilNext = jsiTimerHeapGetTimeUntilNext(time);
 
 	// Check for events that might need to be processed from other libraries
 	if (jswIdle()) wasBusy = true;
 
 	// Just in case we got any events to do and didn't clear loopsIdling before
-	if (wasBusy || !jsvArrayIsEmpty(events) )
+	if (wasBusy || eventQueueCount)
 		loopsIdling = 0;
 
 	if (wasBusy)
@@ -1634,13 +2152,15 @@ void jsiIdle() {
 	}
 
 	/* if we've been around this loop, there is nothing to do, and
-	 * we have a spare 10ms then let's do some Garbage Collection
-	 * just in case. */
-	if (loopsIdling==1 &&
-			minTimeUntilNext > jshGetTimeFromMilliseconds(10)) {
+	 * we have a bit of spare time then let's do some Garbage Collection
+	 * just in case. This is done in small steps so we're never stuck
+	 * in the collector for long, and we keep going each time we're idle
+	 * until it's finished. */
+	if (loopsIdling && (loopsIdling==1 || jsvGarbageCollectInProgress()) &&
+			minTimeUntilNext > jshGetTimeFromMilliseconds(GC_STEP_TIME*2)) {
 		//jsiConsolePrintf("\nloopId = 1\n");
 		jsiSetBusy(BUSY_INTERACTIVE, true);
-		jsvGarbageCollect();
+		jsvGarbageCollectStep(jshGetTimeFromMilliseconds(GC_STEP_TIME));
 		jsiSetBusy(BUSY_INTERACTIVE, false);
 	}
 	// Go to sleep!
@@ -1824,7 +2344,10 @@ void jsiDumpState() {
 		JsVar *timerInterval = jsvObjectGetChild(timer, "interval", 0);
 		jsiConsolePrint(timerInterval ? "setInterval(" : "setTimeout(");
 		jsiDumpJSON(timerCallback, 0);
-		jsiConsolePrintf(", %f);\n", jshGetMillisecondsFromTime(timerInterval ? jsvGetLongInteger(timerInterval) : jsvGetLongIntegerAndUnLock(jsvObjectGetChild(timer, "time", 0))));
+		JsSysTime timerTime = timerInterval ? (JsSysTime)jsvGetLongInteger(timerInterval) : jsiTimerGetTime(timer);
+		if (!timerInterval) // it's due at an absolute time
+			timerTime = (timerTime==JSSYSTIME_MAX) ? 0 : (timerTime - jsiLastIdleTime);
+		jsiConsolePrintf(", %f);\n", jshGetMillisecondsFromTime(timerTime));
 		jsvUnLock(timerInterval);
 		jsvUnLock(timerCallback);
 		// next
@@ -1870,10 +2393,3 @@ void jsiDumpState() {
 void jsiSetTodo(TODOFlags newTodo) {
 	todo = newTodo;
 }
-
-JsVarInt jsiTimerAdd(JsVar *timerPtr) {
-	JsVar *timerArrayPtr = jsvLock(timerArray);
-	JsVarInt itemIndex = jsvArrayAddToEnd(timerArrayPtr, timerPtr, 1) - 1;
-	jsvUnLock(timerArrayPtr);
-	return itemIndex;
-}
@@ -39,8 +39,8 @@ bool jsiIsWatchingPin(Pin pin); // are there any watches for the given pin?
 
 void jsiHandleIOEventForUSART(JsVar *usartClass, IOEvent *event); ///< Called from idle loop
 
-/// Queue a function, string, or array (of funcs/strings) to be executed next time around the idle loop
-void jsiQueueEvents(JsVar *callback, JsVar **args, int argCount);
+/// Queue a function, string, or array (of funcs/strings) to be executed next time around the idle loop, with 'object' as 'this'
+void jsiQueueEvents(JsVar *object, JsVar *callback, JsVar **args, int argCount);
 /// Return true if the object has callbacks...
 bool jsiObjectHasCallbacks(JsVar *object, const char *callbackName);
 /// Queue up callbacks for other things (touchscreen? network?)
@@ -128,9 +128,24 @@ void jsiDumpState();
 void jsiSetTodo(TODOFlags newTodo);
 #define TIMER_MIN_INTERVAL 0.1 // in milliseconds
 extern JsVarRef timerArray; // Linked List of timers to check and run
+extern JsVarRef timerHeap; // Flat string of the timers, ordered by when they're due
 extern JsVarRef watchArray; // Linked List of input watches to check and run
-
-extern JsVarInt jsiTimerAdd(JsVar *timerPtr);
+extern JsVarRef watchIndex; // Flat string of the watches, ordered by pin
+
+extern JsVarInt jsiTimerAdd(JsVar *timerPtr, JsSysTime time);
+void jsiTimerRemove(JsVar *timerPtr);
+void jsiTimerRemoveAll();
+JsSysTime jsiTimerGetTime(JsVar *timerPtr);
+void jsiTimerSetTime(JsVar *timerPtr, JsSysTime time);
+void jsiRemapTimerHeap(JsVarRef (*getNewRef)(JsVarRef ref));
+JsVarInt jsiWatchAdd(JsVar *watchPtr);
+void jsiWatchRemove(JsVar *watchName);
+void jsiWatchRemoveAll();
+void jsiRemapWatchIndex(JsVarRef (*getNewRef)(JsVarRef ref));
+void jsiMarkEvents(void (*markRef)(JsVarRef ref));
+void jsiRemapEvents(JsVarRef (*getNewRef)(JsVarRef ref));
+unsigned int jsiGetEventCount();
+unsigned int jsiGetMaxEventCount();
 // end for jswrap_interactive/io.c ------------------------------------------------
 
 
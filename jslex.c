@@ -21,6 +21,7 @@ JslCharPos jslCharPosClone(JslCharPos *pos) {
   JslCharPos p;
   p.it = jsvStringIteratorClone(&pos->it);
   p.currCh = pos->currCh;
+  p.tokensIdx = pos->tokensIdx;
   return p;
 }
 
@@ -200,7 +201,84 @@ static ALWAYS_INLINE void jslSingleChar(JsLex *lex) {
   jslGetNextCh(lex);
 }
 
+/* Token caches. Rather than lexing a function's code every time it is
+ * called, we can lex it once into a flat string of records, one per token:
+ *
+ *  1 byte  : the token. <128 is the character itself, otherwise 128+(tk-LEX_ID)
+ *  2 bytes : index of the token's first character in the source (little endian)
+ *  LEX_ID/LEX_INT/LEX_FLOAT : 1 byte length, then the token's characters
+ *  LEX_ID  : then 1 byte slot number (see jslTokenCacheAssignSlots)
+ *  LEX_STR : 2 byte length, then the string's (unescaped) characters
+ *
+ * The records come after a 2 byte header: the amount of slots, and how many
+ * of those are for the function's parameters. The last record is always LEX_EOF. Because we store the character index we
+ * can still report errors, and get the code of functions defined inside. */
+#define JSL_TOKEN_CACHE_MAX_INDEX 0xFFFF
+#define JSL_TOKEN_CACHE_HEADER_SIZE 2
+
+static ALWAYS_INLINE int jslTokenCacheGetToken(const unsigned char *rec) {
+  return (rec[0]<128) ? rec[0] : (LEX_ID + rec[0] - 128);
+}
+
+static ALWAYS_INLINE size_t jslTokenCacheGetInt16(const unsigned char *p) {
+  return (size_t)p[0] | ((size_t)p[1]<<8);
+}
+
+static ALWAYS_INLINE bool jslTokenCacheHasText(int tk) {
+  return tk==LEX_ID || tk==LEX_INT || tk==LEX_FLOAT;
+}
+
+/// Return the amount of bytes used by the token cache record at rec
+static size_t jslTokenCacheRecordSize(const unsigned char *rec) {
+  int tk = jslTokenCacheGetToken(rec);
+  if (tk==LEX_STR) return 5 + jslTokenCacheGetInt16(&rec[3]);
+  if (tk==LEX_ID) return 5 + rec[3];
+  if (jslTokenCacheHasText(tk)) return 4 + rec[3];
+  return 3;
+}
+
+/// Get the next token from lex->tokens (see jslInitFromTokens)
+static void jslGetNextTokenFromCache(JsLex *lex) {
+  const unsigned char *rec = (const unsigned char *)jsvGetFlatStringPointer(lex->tokens) + lex->tokensIdx;
+  if (lex->tokenValue) {
+    jsvUnLock(lex->tokenValue);
+    lex->tokenValue = 0;
+  }
+  lex->tokenLastStart = jsvStringIteratorGetIndex(&lex->tokenStart.it) - 1;
+  lex->tk = jslTokenCacheGetToken(rec);
+  /* There's no iterator when we're using the cache, but we still set the
+   * index up so that jsvStringIteratorGetIndex(&tokenStart.it) works */
+  lex->tokenStart.it.var = 0;
+  lex->tokenStart.it.charIdx = 0;
+  lex->tokenStart.it.charsInVar = 0;
+  lex->tokenStart.it.varIndex = jslTokenCacheGetInt16(&rec[1]) + 1;
+  lex->tokenStart.currCh = 0;
+  lex->tokenStart.tokensIdx = lex->tokensIdx;
+  // copy the token's text in (truncated, as the normal lexer would)
+  lex->tokenl = 0;
+  const unsigned char *text = 0;
+  size_t textLen = 0;
+  if (lex->tk==LEX_STR) {
+    textLen = jslTokenCacheGetInt16(&rec[3]);
+    text = &rec[5];
+  } else if (jslTokenCacheHasText(lex->tk)) {
+    textLen = rec[3];
+    text = &rec[4];
+  }
+  lex->tokenSlot = (lex->tk==LEX_ID) ? rec[4+textLen] : JSLEX_NO_SLOT;
+  if (textLen > JSLEX_MAX_TOKEN_LENGTH-1) textLen = JSLEX_MAX_TOKEN_LENGTH-1;
+  if (textLen) memcpy(lex->token, text, textLen);
+  lex->tokenl = (int)textLen;
+  // don't go past the end
+  if (lex->tk != LEX_EOF)
+    lex->tokensIdx += jslTokenCacheRecordSize(rec);
+}
+
 void jslGetNextToken(JsLex *lex) {
+  if (lex->tokens) {
+    jslGetNextTokenFromCache(lex);
+    return;
+  }
 jslGetNextToken_start:
   // Skip whitespace
   while (isWhitespace(lex->currCh)) jslGetNextCh(lex);
@@ -541,15 +619,45 @@ void jslInit(JsLex *lex, JsVar *var) {
   lex->tk = 0;
   lex->tokenStart.it.var = 0;
   lex->tokenStart.currCh = 0;
+  lex->tokenStart.tokensIdx = 0;
   lex->tokenLastStart = 0;
   lex->tokenl = 0;
   lex->tokenValue = 0;
+  lex->tokenSlot = JSLEX_NO_SLOT;
+  lex->tokens = 0;
+  lex->tokensIdx = 0;
   // set up iterator
   jsvStringIteratorNew(&lex->it, lex->sourceVar, 0);
   jsvUnLock(lex->it.var); // see jslGetNextCh
   jslPreload(lex);
 }
 
+void jslInitFromTokens(JsLex *lex, JsVar *var, JsVar *tokens) {
+  assert(jsvIsFlatString(tokens));
+  lex->sourceVar = jsvLockAgain(var);
+  // reset stuff
+  lex->tk = 0;
+  lex->tokenStart.it.var = 0;
+  lex->tokenStart.it.charIdx = 0;
+  lex->tokenStart.it.charsInVar = 0;
+  lex->tokenStart.it.varIndex = 0;
+  lex->tokenStart.currCh = 0;
+  lex->tokenStart.tokensIdx = 0;
+  lex->tokenLastStart = 0;
+  lex->tokenl = 0;
+  lex->tokenValue = 0;
+  lex->tokenSlot = JSLEX_NO_SLOT;
+  lex->tokens = jsvLockAgain(tokens);
+  lex->tokensIdx = JSL_TOKEN_CACHE_HEADER_SIZE;
+  // the iterator isn't used
+  lex->it.var = 0;
+  lex->it.charIdx = 0;
+  lex->it.charsInVar = 0;
+  lex->it.varIndex = 0;
+  lex->currCh = 0;
+  jslGetNextToken(lex);
+}
+
 void jslKill(JsLex *lex) {
   lex->tk = LEX_EOF; // safety ;)
   if (lex->it.var) jsvLockAgain(lex->it.var); // see jslGetNextCh
@@ -559,11 +667,27 @@ void jslKill(JsLex *lex) {
     lex->tokenValue = 0;
   }
   jsvUnLock(lex->sourceVar);
+  if (lex->tokens) {
+    jsvUnLock(lex->tokens);
+    lex->tokens = 0;
+  }
   lex->tokenStart.it.var = 0;
   lex->tokenStart.currCh = 0;
 }
 
 void jslSeekTo(JsLex *lex, size_t seekToChar) {
+  if (lex->tokens) {
+    // find the first token that starts at or after seekToChar
+    const unsigned char *buf = (const unsigned char *)jsvGetFlatStringPointer(lex->tokens);
+    lex->tokensIdx = JSL_TOKEN_CACHE_HEADER_SIZE;
+    while (jslTokenCacheGetToken(&buf[lex->tokensIdx])!=LEX_EOF &&
+           jslTokenCacheGetInt16(&buf[lex->tokensIdx+1]) < seekToChar)
+      lex->tokensIdx += jslTokenCacheRecordSize(&buf[lex->tokensIdx]);
+    lex->tokenStart.it.var = 0;
+    lex->tokenStart.currCh = 0;
+    jslGetNextToken(lex);
+    return;
+  }
   if (lex->it.var) jsvLockAgain(lex->it.var); // see jslGetNextCh
   jsvStringIteratorFree(&lex->it);
   jsvStringIteratorNew(&lex->it, lex->sourceVar, seekToChar);
@@ -574,6 +698,11 @@ void jslSeekTo(JsLex *lex, size_t seekToChar) {
 }
 
 void jslSeekToP(JsLex *lex, JslCharPos *seekToChar) {
+  if (lex->tokens) {
+    lex->tokensIdx = seekToChar->tokensIdx;
+    jslGetNextToken(lex);
+    return;
+  }
   if (lex->it.var) jsvLockAgain(lex->it.var); // see jslGetNextCh
   jsvStringIteratorFree(&lex->it);
   lex->it = jsvStringIteratorClone(&seekToChar->it);
@@ -706,6 +835,13 @@ int jslGetTokenLength(JsLex *lex) {
 JsVar *jslGetTokenValueAsVar(JsLex *lex) {
   if (lex->tokenValue) {
     return jsvLockAgain(lex->tokenValue);
+  } else if (lex->tokens && lex->tk==LEX_STR) {
+    // the string could be longer than lex->token, so get it from the cache
+    const unsigned char *rec = (const unsigned char *)jsvGetFlatStringPointer(lex->tokens) + lex->tokenStart.tokensIdx;
+    lex->tokenValue = jsvNewFromEmptyString();
+    if (lex->tokenValue)
+      jsvAppendStringBuf(lex->tokenValue, (const char *)&rec[5], jslTokenCacheGetInt16(&rec[3]));
+    return jsvLockAgain(lex->tokenValue);
   } else {
     assert(lex->tokenl < JSLEX_MAX_TOKEN_LENGTH);
     lex->token[lex->tokenl]  = 0; // add final null
@@ -733,7 +869,12 @@ bool jslMatch(JsLex *lex, int expected_tk) {
   return true;
 }
 
-JsVar *jslNewFromLexer(JslCharPos *charFrom, size_t charTo) {
+JsVar *jslNewFromLexer(JsLex *lex, JslCharPos *charFrom, size_t charTo) {
+  if (lex->tokens) {
+    // we're reading from a token cache so there's no iterator - just copy from the source
+    size_t charFromIdx = jsvStringIteratorGetIndex(&charFrom->it) - 1;
+    return jsvNewFromStringVar(lex->sourceVar, charFromIdx, charTo - charFromIdx);
+  }
   // Create a var
   JsVar *var = jsvNewFromEmptyString();
   if (!var) { // out of memory
@@ -770,6 +911,183 @@ JsVar *jslNewFromLexer(JslCharPos *charFrom, size_t charTo) {
   return var;
 }
 
+/** Write the record for the current token in lex into buf (if it's not 0 and
+ * there's space), and return how many bytes it needs - or 0 if it can't be stored */
+static size_t jslTokenCacheWrite(JsLex *lex, unsigned char *buf, size_t bufLen) {
+  int tk = lex->tk;
+  size_t pos = jsvStringIteratorGetIndex(&lex->tokenStart.it) - 1;
+  if (tk<0 || (tk>=128 && tk<LEX_ID) || tk-LEX_ID>=128 ||
+      tk==LEX_UNFINISHED_COMMENT ||
+      pos > JSL_TOKEN_CACHE_MAX_INDEX)
+    return 0;
+  if (tk==LEX_EOF && lex->currCh)
+    return 0; // we stopped early - probably out of memory
+  size_t textLen = 0;
+  size_t len = 3;
+  if (tk==LEX_STR) {
+    if (!lex->tokenValue) return 0;
+    textLen = jsvGetStringLength(lex->tokenValue);
+    if (textLen > JSL_TOKEN_CACHE_MAX_INDEX) return 0;
+    len += 2 + textLen;
+  } else if (jslTokenCacheHasText(tk)) {
+    textLen = (size_t)lex->tokenl;
+    len += 1 + textLen;
+    if (tk==LEX_ID) len++; // slot
+  }
+  if (!buf || len>bufLen) return len;
+  buf[0] = (unsigned char)((tk<128) ? tk : (128 + tk - LEX_ID));
+  buf[1] = (unsigned char)(pos & 0xFF);
+  buf[2] = (unsigned char)(pos >> 8);
+  if (tk==LEX_STR) {
+    buf[3] = (unsigned char)(textLen & 0xFF);
+    buf[4] = (unsigned char)(textLen >> 8);
+    JsvStringIterator it;
+    jsvStringIteratorNew(&it, lex->tokenValue, 0);
+    buf += 5;
+    while (jsvStringIteratorHasChar(&it) && textLen--) {
+      *(buf++) = (unsigned char)jsvStringIteratorGetChar(&it);
+      jsvStringIteratorNext(&it);
+    }
+    jsvStringIteratorFree(&it);
+  } else if (jslTokenCacheHasText(tk)) {
+    buf[3] = (unsigned char)textLen;
+    memcpy(&buf[4], lex->token, textLen);
+    if (tk==LEX_ID) buf[4+textLen] = JSLEX_NO_SLOT;
+  }
+  return len;
+}
+
+/** Lex all of var, and return a flat string containing the token cache for
+ * it (see above) or 0 if there wasn't enough memory or it couldn't be stored */
+JsVar *jslNewTokenCache(JsVar *var) {
+  JsLex lex;
+  // first pass - find out how big it needs to be
+  size_t size = JSL_TOKEN_CACHE_HEADER_SIZE;
+  jslInit(&lex, var);
+  while (true) {
+    size_t len = jslTokenCacheWrite(&lex, 0, 0);
+    if (!len) {
+      jslKill(&lex);
+      return 0;
+    }
+    size += len;
+    if (lex.tk==LEX_EOF) break;
+    jslGetNextToken(&lex);
+  }
+  jslKill(&lex);
+  JsVar *tokens = jsvNewFlatStringOfLength((unsigned int)size);
+  if (!tokens) return 0;
+  // second pass - actually write it
+  unsigned char *buf = (unsigned char *)jsvGetFlatStringPointer(tokens);
+  buf[0] = 0; // no slots yet
+  buf[1] = 0;
+  size_t idx = JSL_TOKEN_CACHE_HEADER_SIZE;
+  jslInit(&lex, var);
+  while (true) {
+    size_t len = jslTokenCacheWrite(&lex, &buf[idx], size-idx);
+    if (!len || idx+len>size) {
+      // this shouldn't happen, but if it does, don't use the cache
+      jslKill(&lex);
+      jsvUnLock(tokens);
+      return 0;
+    }
+    idx += len;
+    if (lex.tk==LEX_EOF) break;
+    jslGetNextToken(&lex);
+  }
+  jslKill(&lex);
+  return tokens;
+}
+
+/// Find the slot for the identifier in record rec (or make a new one) - see jslTokenCacheAssignSlots
+static unsigned int jslTokenCacheFindSlot(const unsigned char *buf, const unsigned char *rec, JsVar *function, unsigned int paramCount, size_t *firstUse, unsigned int *slotCount) {
+  size_t len = rec[3];
+  unsigned int slot = 0;
+  if (paramCount) {
+    char name[JSLEX_MAX_TOKEN_LENGTH];
+    memcpy(name, &rec[4], len);
+    name[len] = 0;
+    JsvObjectIterator it;
+    jsvObjectIteratorNew(&it, function);
+    while (jsvObjectIteratorHasValue(&it) && slot<paramCount) {
+      JsVar *param = jsvObjectIteratorGetKey(&it);
+      bool found = false;
+      if (jsvIsFunctionParameter(param)) {
+        found = jsvIsStringEqual(param, name);
+        if (!found) slot++;
+      }
+      jsvUnLock(param);
+      if (found) break;
+      jsvObjectIteratorNext(&it);
+    }
+    jsvObjectIteratorFree(&it);
+    if (slot<paramCount) return slot;
+  }
+  for (slot=paramCount;slot<*slotCount;slot++) {
+    const unsigned char *first = &buf[firstUse[slot]];
+    if (first[3]==len && !memcmp(&first[4], &rec[4], len)) return slot;
+  }
+  if (*slotCount >= JSLEX_MAX_SLOTS) return JSLEX_NO_SLOT;
+  firstUse[*slotCount] = (size_t)(rec - buf);
+  return (*slotCount)++;
+}
+
+/** Give each identifier in a token cache for function's code a slot number,
+ * so that the parser can keep the function's local variables in an array
+ * rather than having to search for them by name (see JsLex.tokenSlot). The
+ * function's parameters get the first slots, in order, and then every other
+ * identifier gets the next free slot the first time it's used (until we hit
+ * JSLEX_MAX_SLOTS). Field names (after '.') and functions defined inside the
+ * code are left alone. Returns the amount of slots, which is also stored in
+ * the cache (see jslTokenCacheGetSlotCount) */
+unsigned int jslTokenCacheAssignSlots(JsVar *tokens, JsVar *function) {
+  unsigned char *buf = (unsigned char *)jsvGetFlatStringPointer(tokens);
+  size_t firstUse[JSLEX_MAX_SLOTS]; // for slots that aren't parameters, the record of the first identifier using it
+  unsigned int paramCount = 0;
+  JsvObjectIterator it;
+  jsvObjectIteratorNew(&it, function);
+  while (jsvObjectIteratorHasValue(&it)) {
+    JsVar *param = jsvObjectIteratorGetKey(&it);
+    if (jsvIsFunctionParameter(param) && paramCount<JSLEX_MAX_SLOTS) paramCount++;
+    jsvUnLock(param);
+    jsvObjectIteratorNext(&it);
+  }
+  jsvObjectIteratorFree(&it);
+
+  unsigned int slotCount = paramCount;
+  size_t idx = JSL_TOKEN_CACHE_HEADER_SIZE;
+  int lastTk = 0;
+  bool inFunction = false; // are we skipping over a function defined in this code?
+  int depth = 0; // how many '{' deep we are in that function
+  while (true) {
+    unsigned char *rec = &buf[idx];
+    int tk = jslTokenCacheGetToken(rec);
+    if (tk==LEX_EOF) break;
+    if (inFunction) {
+      if (tk=='{') depth++;
+      else if (tk=='}' && depth>0 && --depth==0) inFunction = false;
+    } else if (tk==LEX_R_FUNCTION) {
+      inFunction = true; // skip its name, parameters and body
+    } else if (tk==LEX_ID && lastTk!='.') {
+      rec[4+rec[3]] = (unsigned char)jslTokenCacheFindSlot(buf, rec, function, paramCount, firstUse, &slotCount);
+    }
+    lastTk = tk;
+    idx += jslTokenCacheRecordSize(rec);
+  }
+  buf[0] = (unsigned char)slotCount;
+  buf[1] = (unsigned char)paramCount;
+  return slotCount;
+}
+
+/** Return the amount of slots that jslTokenCacheAssignSlots gave the
+ * identifiers in a token cache, and set paramSlots to how many of them are
+ * for the function's parameters */
+unsigned int jslTokenCacheGetSlotCount(JsVar *tokens, unsigned int *paramSlots) {
+  const unsigned char *buf = (const unsigned char *)jsvGetFlatStringPointer(tokens);
+  *paramSlots = buf[1];
+  return buf[0];
+}
+
 void jslPrintPosition(vcbprintf_callback user_callback, void *user_data, struct JsLex *lex, size_t tokenPos) {
   size_t line,col;
   jsvGetLineAndCol(lex->sourceVar, tokenPos, &line, &col);
@@ -18,9 +18,14 @@
 #include "jsvar.h"
 #include "jsvariterator.h"
 
+/// The most slots jslTokenCacheAssignSlots will give out (and so the most local variables a function can keep in an array)
+#define JSLEX_MAX_SLOTS 32
+#define JSLEX_NO_SLOT 0xFF ///< JsLex.tokenSlot for tokens without a slot
+
 typedef struct JslCharPos {
   JsvStringIterator it;
   char currCh;
+  size_t tokensIdx; ///< If the lexer is reading from a token cache, the index of this token in it
 } JslCharPos;
 
 void jslCharPosFree(JslCharPos *pos);
@@ -37,6 +42,7 @@ typedef struct JsLex
   char token[JSLEX_MAX_TOKEN_LENGTH]; ///< Data contained in the token we have here
   JsVar *tokenValue; ///< JsVar containing the current token - used only for strings
   unsigned char tokenl; ///< the current length of token
+  unsigned char tokenSlot; ///< If the token is an LEX_ID from a token cache, its slot (see jslTokenCacheAssignSlots) - otherwise JSLEX_NO_SLOT
 
   /* Where we get our data from...
    *
@@ -46,9 +52,16 @@ typedef struct JsLex
    */
   JsVar *sourceVar; // the actual string var
   JsvStringIterator it; // Iterator for the string
+
+  /* If we've been given a token cache (see jslNewTokenCache) we read tokens
+   * straight out of it, and sourceVar is only used for error messages and
+   * for getting the code of functions defined inside it */
+  JsVar *tokens; ///< The token cache (or 0)
+  size_t tokensIdx; ///< Index in the token cache of the next token
 } JsLex;
 
 void jslInit(JsLex *lex, JsVar *var);
+void jslInitFromTokens(JsLex *lex, JsVar *var, JsVar *tokens); ///< Like jslInit, but get tokens from the result of jslNewTokenCache(var)
 void jslKill(JsLex *lex);
 void jslReset(JsLex *lex);
 void jslSeekTo(JsLex *lex, size_t seekToChar);
@@ -65,7 +78,10 @@ JsVar *jslGetTokenValueAsVar(JsLex *lex);
 void jslSeek(JsLex *lex, JslCharPos seekToChar); // like jslSeekTo, but doesn't pre-fill characters
 void jslGetNextToken(JsLex *lex); ///< Get the text token from our text string
 
-JsVar *jslNewFromLexer(JslCharPos *charFrom, size_t charTo); // Create a new STRING from part of the lexer
+JsVar *jslNewFromLexer(JsLex *lex, JslCharPos *charFrom, size_t charTo); // Create a new STRING from part of the lexer
+JsVar *jslNewTokenCache(JsVar *var); ///< Lex all of var, and return a flat string of the tokens that jslInitFromTokens can use (or 0)
+unsigned int jslTokenCacheAssignSlots(JsVar *tokens, JsVar *function); ///< Number the identifiers in the token cache for function's code, so its local variables can be kept in an array
+unsigned int jslTokenCacheGetSlotCount(JsVar *tokens, unsigned int *paramSlots); ///< Get the amount of slots jslTokenCacheAssignSlots used (and how many are for parameters)
 
 void jslPrintPosition(vcbprintf_callback user_callback, void *user_data, struct JsLex *lex, size_t tokenPos);
 void jslPrintTokenLineMarker(vcbprintf_callback user_callback, void *user_data, struct JsLex *lex, size_t tokenPos);
@@ -18,11 +18,106 @@
 
 // none of this is used at the moment
 #define MAX_ARGS 12
-#ifndef ARM
+#if !defined(ARM) && !defined(LINUX)
 #define ARM
 #endif
+
+#define JSN_ARG(N,T) ((T) << (JSWAT_BITS*(N)))
+#define JSN_PARAM(N) (((N)<paramCount) ? paramData[N] : (JsVar*)0)
+
+/** Call functions with the most common argument specifiers through their
+ * real C prototype, so we don't have to decode argumentSpecifier and pack
+ * everything into argData. Returns false if it's not one we know */
+static bool jsnCallFunctionTyped(void *function, JsnArgumentType argumentSpecifier, JsVar *thisParam, JsVar **paramData, int paramCount, JsVar **result) {
+  // constants in the symbol table are just functions with no arguments
+  if ((argumentSpecifier & JSWAT_EXECUTE_IMMEDIATELY_MASK) == JSWAT_EXECUTE_IMMEDIATELY)
+    argumentSpecifier &= (JsnArgumentType)~JSWAT_EXECUTE_IMMEDIATELY_MASK;
+
+  switch ((int)argumentSpecifier) {
+    // ------------------------------------------ void
+    case JSWAT_VOID:
+      ((void (*)(void))function)();
+      *result = 0; return true;
+    case JSWAT_VOID | JSWAT_THIS_ARG:
+      ((void (*)(JsVar*))function)(thisParam);
+      *result = 0; return true;
+    case JSWAT_VOID | JSN_ARG(1,JSWAT_JSVAR):
+      ((void (*)(JsVar*))function)(JSN_PARAM(0));
+      *result = 0; return true;
+    case JSWAT_VOID | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_JSVAR):
+      ((void (*)(JsVar*,JsVar*))function)(thisParam, JSN_PARAM(0));
+      *result = 0; return true;
+    case JSWAT_VOID | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_JSVAR) | JSN_ARG(2,JSWAT_JSVAR):
+      ((void (*)(JsVar*,JsVar*,JsVar*))function)(thisParam, JSN_PARAM(0), JSN_PARAM(1));
+      *result = 0; return true;
+    case JSWAT_VOID | JSN_ARG(1,JSWAT_JSVAR) | JSN_ARG(2,JSWAT_INT32): // digitalWrite
+      ((void (*)(JsVar*,JsVarInt))function)(JSN_PARAM(0), jsvGetInteger(JSN_PARAM(1)));
+      *result = 0; return true;
+    // ------------------------------------------ JsVar
+    case JSWAT_JSVAR:
+      *result = ((JsVar *(*)(void))function)();
+      return true;
+    case JSWAT_JSVAR | JSWAT_THIS_ARG:
+      *result = ((JsVar *(*)(JsVar*))function)(thisParam);
+      return true;
+    case JSWAT_JSVAR | JSN_ARG(1,JSWAT_JSVAR):
+      *result = ((JsVar *(*)(JsVar*))function)(JSN_PARAM(0));
+      return true;
+    case JSWAT_JSVAR | JSN_ARG(1,JSWAT_JSVAR) | JSN_ARG(2,JSWAT_JSVAR):
+      *result = ((JsVar *(*)(JsVar*,JsVar*))function)(JSN_PARAM(0), JSN_PARAM(1));
+      return true;
+    case JSWAT_JSVAR | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_JSVAR):
+      *result = ((JsVar *(*)(JsVar*,JsVar*))function)(thisParam, JSN_PARAM(0));
+      return true;
+    case JSWAT_JSVAR | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_JSVAR) | JSN_ARG(2,JSWAT_JSVAR):
+      *result = ((JsVar *(*)(JsVar*,JsVar*,JsVar*))function)(thisParam, JSN_PARAM(0), JSN_PARAM(1));
+      return true;
+    case JSWAT_JSVAR | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_INT32):
+      *result = ((JsVar *(*)(JsVar*,JsVarInt))function)(thisParam, jsvGetInteger(JSN_PARAM(0)));
+      return true;
+    // ------------------------------------------ int/bool/pin
+    case JSWAT_INT32:
+      *result = jsvNewFromInteger(((JsVarInt (*)(void))function)());
+      return true;
+    case JSWAT_INT32 | JSWAT_THIS_ARG:
+      *result = jsvNewFromInteger(((JsVarInt (*)(JsVar*))function)(thisParam));
+      return true;
+    case JSWAT_INT32 | JSN_ARG(1,JSWAT_JSVAR): // digitalRead
+      *result = jsvNewFromInteger(((JsVarInt (*)(JsVar*))function)(JSN_PARAM(0)));
+      return true;
+    case JSWAT_INT32 | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_INT32):
+      *result = jsvNewFromInteger(((JsVarInt (*)(JsVar*,JsVarInt))function)(thisParam, jsvGetInteger(JSN_PARAM(0))));
+      return true;
+    case JSWAT_BOOL | JSWAT_THIS_ARG | JSN_ARG(1,JSWAT_JSVAR):
+      *result = jsvNewFromBool(((bool (*)(JsVar*,JsVar*))function)(thisParam, JSN_PARAM(0)));
+      return true;
+    case JSWAT_PIN:
+      *result = jsvNewFromPin(((Pin (*)(void))function)());
+      return true;
+    // ------------------------------------------ float
+    case JSWAT_JSVARFLOAT:
+      *result = jsvNewFromFloat(((JsVarFloat (*)(void))function)());
+      return true;
+    case JSWAT_JSVARFLOAT | JSWAT_THIS_ARG:
+      *result = jsvNewFromFloat(((JsVarFloat (*)(JsVar*))function)(thisParam));
+      return true;
+    case JSWAT_JSVARFLOAT | JSN_ARG(1,JSWAT_JSVARFLOAT): // Math.sin/etc
+      *result = jsvNewFromFloat(((JsVarFloat (*)(JsVarFloat))function)(jsvGetFloat(JSN_PARAM(0))));
+      return true;
+    case JSWAT_JSVARFLOAT | JSN_ARG(1,JSWAT_JSVARFLOAT) | JSN_ARG(2,JSWAT_JSVARFLOAT): // Math.pow/etc
+      *result = jsvNewFromFloat(((JsVarFloat (*)(JsVarFloat,JsVarFloat))function)(jsvGetFloat(JSN_PARAM(0)), jsvGetFloat(JSN_PARAM(1))));
+      return true;
+    default:
+      return false;
+  }
+}
+
 /** Call a function with the given argument specifiers */
 JsVar *jsnCallFunction(void *function, JsnArgumentType argumentSpecifier, JsVar *thisParam, JsVar **paramData, int paramCount) {
+  JsVar *typedResult;
+  if (jsnCallFunctionTyped(function, argumentSpecifier, thisParam, paramData, paramCount, &typedResult))
+    return typedResult;
+
   /*if(paramCount == 3) {
       jsiConsolePrintf("param[1] = %d\n",jsvGetInteger(paramData[1]));
       jsiConsolePrintf("param[2] = %d\n",jsvGetInteger(paramData[2]));
@@ -16,6 +16,7 @@
 #include "jswrapper.h"
 #include "jsnative.h"
 #include "jswrap_object.h" // for function_replacewith
+#include "jstimer.h"
 
 /* Info about execution when Parsing - this saves passing it on the stack
  * for each call */
@@ -64,6 +65,18 @@ bool jspHasError() {
 	return JSP_HAS_ERROR;
 }
 
+/** Could changing the value of this name change where fields are found? True
+ * for __proto__ and prototype, and for anything that could be a built-in class
+ * (eg. Array), as basic types like arrays get their prototypes from those */
+static bool jspIsPrototypeName(JsVar *name) {
+	if (!jsvIsString(name)) return false;
+	char ch = jsvGetCharInString(name, 0);
+	if (ch>='A' && ch<='Z') return true;
+	if (ch=='_') return jsvIsStringEqual(name, JSPARSE_INHERITS_VAR);
+	if (ch=='p') return jsvIsStringEqual(name, JSPARSE_PROTOTYPE_VAR);
+	return false;
+}
+
 void jspReplaceWith(JsVar *dst, JsVar *src) {
 	// If this is an index in an array buffer, write directly into the array buffer
 	if (jsvIsArrayBufferName(dst)) {
@@ -78,6 +91,8 @@ void jspReplaceWith(JsVar *dst, JsVar *src) {
 		jsExceptionHere(JSET_ERROR, "Unable to assign value to non-reference %t", dst);
 		return;
 	}
+	if (jspIsPrototypeName(dst))
+		jsvShapeChanged();
 	jsvSetValueOfName(dst, src);
 	/* If dst is flagged as a new child, it means that
 	 * it was previously undefined, and we need to add it to
@@ -102,6 +117,7 @@ void jspeiInit(JsLex *lex) {
 	execInfo.scopeCount = 0;
 	execInfo.execute = EXEC_YES;
 	execInfo.thisVar = 0;
+	execInfo.frame = 0;
 }
 
 void jspeiKill() {
@@ -128,15 +144,20 @@ void jspeiRemoveScope() {
 	jsvUnLock(execInfo.scopes[--execInfo.scopeCount]);
 }
 
-JsVar *jspeiFindInScopes(const char *name) {
+/// Like jspeiFindInScopes, but only look in the first scopeCount scopes (and root)
+static JsVar *jspeiFindInFirstScopes(const char *name, int scopeCount) {
 	int i;
-	for (i=execInfo.scopeCount-1;i>=0;i--) {
+	for (i=scopeCount-1;i>=0;i--) {
 		JsVar *ref = jsvFindChildFromString(execInfo.scopes[i], name, false);
 		if (ref) return ref;
 	}
 	return jsvFindChildFromString(execInfo.root, name, false);
 }
 
+JsVar *jspeiFindInScopes(const char *name) {
+	return jspeiFindInFirstScopes(name, execInfo.scopeCount);
+}
+
 // TODO: get rid of these, use jspeiGetTopScope instead
 JsVar *jspeiFindOnTop(const char *name, bool createIfNotFound) {
 	if (execInfo.scopeCount>0)
@@ -149,6 +170,53 @@ JsVar *jspeiFindNameOnTop(JsVar *childName, bool createIfNotFound) {
 	return jsvFindChildFromVar(execInfo.root, childName, createIfNotFound);
 }
 
+/** Is name (which we found in parent before) still one of parent's children? This
+ * is quicker than jsvIsChild, as we only have to look at name's siblings */
+static ALWAYS_INLINE bool jspeiIsStillChild(JsVar *parent, JsVar *name) {
+	return jsvGetPrevSibling(name) || jsvGetNextSibling(name) || jsvGetFirstChild(parent)==jsvGetRef(name);
+}
+
+/** If the current token is an identifier with a slot in the function call
+ * we're executing, return a pointer to that slot - otherwise 0 */
+static ALWAYS_INLINE JsVar **jspeiGetTokenSlot() {
+	JspFrame *frame = execInfo.frame;
+	unsigned char slot = execInfo.lex->tokenSlot;
+	if (!frame || slot>=frame->slotCount || frame->lex!=execInfo.lex) return 0;
+	assert(execInfo.scopeCount>0 && execInfo.scopes[execInfo.scopeCount-1]==frame->scope);
+	return &frame->slots[slot];
+}
+
+/// Put a (locked) local variable name in a slot from jspeiGetTokenSlot
+static void jspeiSetSlot(JsVar **slot, JsVar *name) {
+	if (*slot) jsvUnLock(*slot);
+	*slot = jsvLockAgain(name);
+}
+
+/** Find the variable named by the current token (an LEX_ID) in our scopes.
+ * If it's a local variable that we found before, we don't need to search */
+static JsVar *jspeiFindIdentifier() {
+	const char *name = jslGetTokenValueAsString(execInfo.lex);
+	JsVar **slot = jspeiGetTokenSlot();
+	if (!slot) return jspeiFindInScopes(name);
+	JsVar *scope = execInfo.frame->scope;
+	if (*slot && jspeiIsStillChild(scope, *slot)) return jsvLockAgain(*slot);
+	JsVar *a = jsvFindChildFromString(scope, name, false);
+	if (!a) return jspeiFindInFirstScopes(name, execInfo.scopeCount-1);
+	jspeiSetSlot(slot, a);
+	return a;
+}
+
+/** Like jspeiFindOnTop(name, true), for the variable named by the current
+ * token - but use its slot if it has one */
+static JsVar *jspeiFindIdentifierOnTop() {
+	JsVar **slot = jspeiGetTokenSlot();
+	if (slot && *slot && jspeiIsStillChild(execInfo.frame->scope, *slot))
+		return jsvLockAgain(*slot);
+	JsVar *a = jspeiFindOnTop(jslGetTokenValueAsString(execInfo.lex), true);
+	if (a && slot) jspeiSetSlot(slot, a);
+	return a;
+}
+
 
 
 /** Here we assume that we have already looked in the parent itself -
@@ -370,7 +438,7 @@ NO_INLINE JsVar *jspeFunctionDefinition(bool parseNamedFunction) {
 	// Then create var and set
 	if (actuallyCreateFunction) {
 		// code var
-		JsVar *funcCodeVar = jslNewFromLexer(&funcBegin, (size_t)(execInfo.lex->tokenLastStart+1));
+		JsVar *funcCodeVar = jslNewFromLexer(execInfo.lex, &funcBegin, (size_t)(execInfo.lex->tokenLastStart+1));
 		jsvUnLock(jsvAddNamedChild(funcVar, funcCodeVar, JSPARSE_FUNCTION_CODE_NAME));
 		jsvUnLock(funcCodeVar);
 		// scope var
@@ -400,6 +468,195 @@ NO_INLINE bool jspeParseFunctionCallBrackets() {
 	return 0;
 }
 
+/* Functions that are called more than this many times get their code
+ * tokenised once, so it doesn't need lexing again (see jslNewTokenCache) */
+#define JSP_TOKEN_CACHE_MIN_CALLS 2
+
+/** Get the token cache for a function's code, or 0 if it should just be lexed
+ * as normal. tokensName is the function's JSPARSE_FUNCTION_TOKENS_NAME child
+ * (if it has one). Until the cache is made, its value is the amount of times
+ * the function has been called. If it's anything else (eg. because the cache
+ * got freed by jspFreeTokenCaches) we don't try again. */
+static JsVar *jspeiGetFunctionTokens(JsVar *function, JsVar *tokensName, JsVar *functionCode) {
+	if (!tokensName) {
+		JsVar *calls = jsvNewFromInteger(1);
+		jsvUnLock(jsvAddNamedChild(function, calls, JSPARSE_FUNCTION_TOKENS_NAME));
+		jsvUnLock(calls);
+		return 0;
+	}
+	JsVar *tokens = jsvSkipName(tokensName);
+	if (jsvIsFlatString(tokens)) return tokens;
+	if (jsvIsInt(tokens)) {
+		JsVarInt calls = jsvGetInteger(tokens) + 1;
+		jsvUnLock(tokens);
+		tokens = 0;
+		/* Only make a cache if at least half our memory is free. If we
+		 * run low later, jsiFreeMoreMemory will throw it away */
+		if (calls >= JSP_TOKEN_CACHE_MIN_CALLS && jsvGetMemoryUsage()*2 < jsvGetMemoryTotal())
+			tokens = jslNewTokenCache(functionCode);
+		if (tokens) {
+			jslTokenCacheAssignSlots(tokens, function);
+			jsvSetValueOfName(tokensName, tokens);
+		} else if (calls >= JSP_TOKEN_CACHE_MIN_CALLS) {
+			jsvSetValueOfName(tokensName, 0); // couldn't do it - don't try again
+		} else {
+			JsVar *v = jsvNewFromInteger(calls);
+			jsvSetValueOfName(tokensName, v);
+			jsvUnLock(v);
+		}
+		return tokens;
+	}
+	jsvUnLock(tokens);
+	return 0;
+}
+
+/// Throw away the token caches of all functions (returns true if any were freed)
+bool jspFreeTokenCaches() {
+	bool freed = false;
+	JsVarRef i;
+	for (i=1;i<=jsvGetMemoryTotal();i++) {
+		JsVar *v = _jsvGetAddressOf(i);
+		if (jsvIsFlatString(v)) {
+			// skip over the string's data - it's not made of JsVars
+			i = (JsVarRef)(i + jsvGetFlatStringBlocks(v));
+		} else if (jsvIsString(v) && jsvIsName(v) && !jsvIsNameWithValue(v) &&
+				jsvGetFirstChild(v) && jsvIsStringEqual(v, JSPARSE_FUNCTION_TOKENS_NAME)) {
+			JsVar *tokensName = jsvLock(i);
+			JsVar *tokens = jsvSkipName(tokensName);
+			if (jsvIsFlatString(tokens)) {
+				jsvSetValueOfName(tokensName, 0);
+				freed = true;
+			}
+			jsvUnLock(tokens);
+			jsvUnLock(tokensName);
+		}
+	}
+	return freed;
+}
+
+/* Pool of function call scopes. When a function returns and nothing else has
+ * kept hold of its scope (eg. a function that was defined inside it), we don't
+ * free it. Instead we strip it down to the names of the parameters and the
+ * return variable, and keep it so the next call of the same function can use
+ * it rather than allocating them all again. While a scope is in the pool its
+ * return variable is set to the function, which is how we know what it's for
+ * (and which stops the function being freed). jsiFreeMoreMemory empties the
+ * pool if we need the memory. */
+#define JSP_FRAME_POOL_SIZE 4
+static JsVar *jspFramePool[JSP_FRAME_POOL_SIZE]; ///< Locked scopes (or 0)
+static unsigned int jspFramePoolNext; ///< The entry the next scope goes in
+
+/// Free everything in the frame pool - returns true if anything was in it
+bool jspClearFramePool() {
+	bool cleared = false;
+	int i;
+	for (i=0;i<JSP_FRAME_POOL_SIZE;i++) {
+		JsVar *scope = jspFramePool[i];
+		if (scope) {
+			jspFramePool[i] = 0;
+			jsvUnLock(scope);
+			cleared = true;
+		}
+	}
+	return cleared;
+}
+
+/** If there's a scope in the pool for calling function, take it out and
+ * return it (locked). Its children are the function's parameters (with no
+ * values) followed by the return variable, which goes in returnVarName */
+static JsVar *jspFramePoolTake(JsVar *function, JsVar **returnVarName) {
+	JsVarRef functionRef = jsvGetRef(function);
+	int i;
+	for (i=0;i<JSP_FRAME_POOL_SIZE;i++) {
+		JsVar *scope = jspFramePool[i];
+		if (scope && jsvGetFirstChild(_jsvGetAddressOf(jsvGetLastChild(scope)))==functionRef) {
+			jspFramePool[i] = 0;
+			*returnVarName = jsvLock(jsvGetLastChild(scope));
+			jsvSetValueOfName(*returnVarName, 0);
+			return scope;
+		}
+	}
+	return 0;
+}
+
+/** Put the scope of a call to function that has just finished in the pool, if
+ * nothing else is using it. Its first paramCount children must be the function's
+ * parameters. Returns false if it can't be pooled, in which case it should
+ * just be unlocked. */
+static bool jspFramePoolPut(JsVar *function, JsVar *scope, int paramCount, JsVar *returnVarName) {
+	if (!returnVarName || jsvGetRefs(scope) || jsvGetLocks(scope)!=1) return false;
+	// make sure nothing else has hold of the parameters
+	JsVarRef childRef = jsvGetFirstChild(scope);
+	int i;
+	for (i=0;i<paramCount;i++) {
+		if (!childRef) return false;
+		JsVar *child = _jsvGetAddressOf(childRef);
+		if (!jsvIsFunctionParameter(child) || jsvGetRefs(child)!=1 || jsvGetLocks(child)) return false;
+		childRef = jsvGetNextSibling(child);
+	}
+	// remove everything after them apart from the return variable
+	while (childRef) {
+		JsVar *child = jsvLock(childRef);
+		childRef = jsvGetNextSibling(child);
+		if (child!=returnVarName) jsvRemoveChild(scope, child);
+		jsvUnLock(child);
+	}
+	// and remove the parameters' values
+	childRef = jsvGetFirstChild(scope);
+	for (i=0;i<paramCount;i++) {
+		JsVar *child = jsvLock(childRef);
+		jsvSetValueOfName(child, 0);
+		childRef = jsvGetNextSibling(child);
+		jsvUnLock(child);
+	}
+	jsvSetValueOfName(returnVarName, function);
+	// make room, then the pool takes over our lock
+	if (jspFramePool[jspFramePoolNext]) jsvUnLock(jspFramePool[jspFramePoolNext]);
+	jspFramePool[jspFramePoolNext] = scope;
+	jspFramePoolNext = (jspFramePoolNext+1) % JSP_FRAME_POOL_SIZE;
+	return true;
+}
+
+/** Get the name of a parameter in a function call's scope. param is the
+ * function's parameter, or 0 for an extra argument. If the scope came from
+ * the frame pool, it already has the parameters' names, and nextParam is
+ * the next one to use */
+static JsVar *jspeiGetParameterName(JsVar *functionRoot, JsVar *param, JsVarRef *nextParam) {
+	JsVar *paramName;
+	if (param && *nextParam) {
+		paramName = jsvLock(*nextParam);
+		*nextParam = jsvGetNextSibling(paramName);
+		return paramName;
+	}
+	paramName = param ? jsvCopy(param) : jsvNewFromEmptyString();
+	if (!paramName) return 0; // out of memory
+	jsvMakeFunctionParameter(paramName); // force this to be called a function parameter
+	jsvAddName(functionRoot, paramName);
+	return paramName;
+}
+
+/** Set up the slots of a function call's frame (see jslTokenCacheAssignSlots).
+ * The first paramSlots are for its parameters, which are the first children
+ * of its scope, in order. The rest are filled in when they're first used. */
+static void jspeiFillSlots(JspFrame *frame, unsigned int paramSlots) {
+	unsigned int i;
+	JsVarRef childRef = jsvGetFirstChild(frame->scope);
+	for (i=0;i<frame->slotCount;i++) {
+		JsVar *child = 0;
+		if (i<paramSlots && childRef) {
+			child = jsvLock(childRef);
+			if (jsvIsFunctionParameter(child)) {
+				childRef = jsvGetNextSibling(child);
+			} else { // out of memory when adding the parameters?
+				jsvUnLock(child);
+				child = 0;
+				childRef = 0;
+			}
+		}
+		frame->slots[i] = child;
+	}
+}
+
 /** Handle a function call (assumes we've parsed the function name and we're
  * on the start bracket). 'thisArg' is the value of the 'this' variable when the
  * function is executed (it's usually the parent object)
@@ -482,10 +739,12 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 			execInfo.thisVar = oldThisVar;
 
 		} else {  //if (!jsvIsNative(function))
-			// create a new symbol table entry for execution of this function
-			// OPT: can we cache this function execution environment + param variables?
-			// OPT: Probably when calling a function ONCE, use it, otherwise when recursing, make new?
-			functionRoot = jsvNewWithFlags(JSV_FUNCTION);
+			// create a new symbol table entry for execution of this function - or reuse an old one
+			returnVarName = 0;
+			functionRoot = jspFramePoolTake(function, &returnVarName);
+			JsVarRef pooledParam = functionRoot ? jsvGetFirstChild(functionRoot) : 0; // parameter names we can reuse
+			int paramCount = 0;
+			if (!functionRoot) functionRoot = jsvNewWithFlags(JSV_FUNCTION);
 			if (!functionRoot) { // out of memory
 				jspSetError(false);
 				return 0;
@@ -493,6 +752,7 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 
 			JsVar *functionScope = 0;
 			JsVar *functionCode = 0;
+			JsVar *functionTokensName = 0;
 			JsVar *functionInternalName = 0;
 
 			/** NOTE: We expect that the function object will have:
@@ -520,11 +780,9 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 						// and if execute, copy it over
 						if (JSP_SHOULD_EXECUTE) {
 							value = jsvSkipNameAndUnLock(value);
-							JsVar *paramName = paramDefined ? jsvCopy(param) : jsvNewFromEmptyString();
+							JsVar *paramName = jspeiGetParameterName(functionRoot, paramDefined ? param : 0, &pooledParam);
 							if (paramName) { // could be out of memory
-								jsvMakeFunctionParameter(paramName); // force this to be called a function parameter
 								jsvSetValueOfName(paramName, value);
-								jsvAddName(functionRoot, paramName);
 								jsvUnLock(paramName);
 							} else
 								jspSetError(false);
@@ -533,7 +791,10 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 						if (execInfo.lex->tk!=')') JSP_MATCH(',');
 					}
 					jsvUnLock(param);
-					if (paramDefined) jsvObjectIteratorNext(&it);
+					if (paramDefined) {
+						paramCount++;
+						jsvObjectIteratorNext(&it);
+					}
 				}
 				JSP_MATCH(')');
 			} else if (JSP_SHOULD_EXECUTE) {  // and NOT isParsing
@@ -541,17 +802,18 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 				while (args<argCount) {
 					JsVar *param = jsvObjectIteratorGetKey(&it);
 					bool paramDefined = jsvIsFunctionParameter(param);
-					JsVar *paramName = paramDefined ? jsvCopy(param) : jsvNewFromEmptyString();
+					JsVar *paramName = jspeiGetParameterName(functionRoot, paramDefined ? param : 0, &pooledParam);
 					if (paramName) {
-						jsvMakeFunctionParameter(paramName); // force this to be called a function parameter
 						jsvSetValueOfName(paramName, argPtr[args]);
-						jsvAddName(functionRoot, paramName);
 						jsvUnLock(paramName);
 					} else
 						jspSetError(false);
 					args++;
 					jsvUnLock(param);
-					if (paramDefined) jsvObjectIteratorNext(&it);
+					if (paramDefined) {
+						paramCount++;
+						jsvObjectIteratorNext(&it);
+					}
 				}
 			}
 			// Now go through what's left
@@ -560,14 +822,12 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 				if (jsvIsString(param)) {
 					if (jsvIsStringEqual(param, JSPARSE_FUNCTION_SCOPE_NAME)) functionScope = jsvSkipName(param);
 					else if (jsvIsStringEqual(param, JSPARSE_FUNCTION_CODE_NAME)) functionCode = jsvSkipName(param);
+					else if (jsvIsStringEqual(param, JSPARSE_FUNCTION_TOKENS_NAME)) functionTokensName = jsvLockAgain(param);
 					else if (jsvIsStringEqual(param, JSPARSE_FUNCTION_NAME_NAME)) functionInternalName = jsvSkipName(param);
 					else if (jsvIsFunctionParameter(param)) {
-						JsVar *paramName = jsvCopy(param);
-						// paramName is already a name (it's a function parameter)
-						if (paramName) {// could be out of memory - or maybe just not supplied!
-							jsvAddName(functionRoot, paramName);
-							jsvUnLock(paramName);
-						}
+						// not supplied, so it has no value
+						jsvUnLock(jspeiGetParameterName(functionRoot, param, &pooledParam));
+						paramCount++;
 					}
 				}
 				jsvUnLock(param);
@@ -582,8 +842,9 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 				jsvUnLock(name);
 				jsvUnLock(functionInternalName);
 			}
-			// setup a return variable
-			returnVarName = jsvAddNamedChild(functionRoot, 0, JSPARSE_RETURN_VAR);
+			// setup a return variable (if we didn't get one from the pool)
+			if (!returnVarName)
+				returnVarName = jsvAddNamedChild(functionRoot, 0, JSPARSE_RETURN_VAR);
 			if (!returnVarName) // out of memory
 				jspSetError(false);
 
@@ -622,7 +883,24 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 					if (functionCode) {
 						JsLex *oldLex;
 						JsLex newLex;
-						jslInit(&newLex, functionCode);
+						JspFrame *oldFrame = execInfo.frame;
+						JspFrame frame;
+						unsigned int paramSlots = 0;
+						frame.slotCount = 0;
+						JsVar *functionTokens = jspeiGetFunctionTokens(function, functionTokensName, functionCode);
+						if (functionTokens) {
+							jslInitFromTokens(&newLex, functionCode, functionTokens);
+							frame.slotCount = jslTokenCacheGetSlotCount(functionTokens, &paramSlots);
+						} else
+							jslInit(&newLex, functionCode);
+						jsvUnLock(functionTokens);
+						if (frame.slotCount) {
+							frame.scope = functionRoot;
+							frame.lex = &newLex;
+							frame.slots = (JsVar**)alloca(sizeof(JsVar*)*frame.slotCount);
+							jspeiFillSlots(&frame, paramSlots);
+						}
+						execInfo.frame = frame.slotCount ? &frame : 0;
 
 						oldLex = execInfo.lex;
 						execInfo.lex = &newLex;
@@ -633,6 +911,9 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 						JSP_RESTORE_EXECUTE(); // because return will probably have set execute to false
 						jslKill(&newLex);
 						execInfo.lex = oldLex;
+						while (frame.slotCount)
+							jsvUnLock(frame.slots[--frame.slotCount]);
+						execInfo.frame = oldFrame;
 						if (hasError) {
 							JsVar *stackTrace = jsvObjectGetChild(execInfo.hiddenRoot, JSPARSE_STACKTRACE_VAR, JSV_STRING_0);
 							if (stackTrace) {
@@ -663,12 +944,14 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 				execInfo.scopeCount = oldScopeCount;
 			}
 			jsvUnLock(functionCode);
+			jsvUnLock(functionTokensName);
 
 			/* get the real return var before we remove it from our function */
 			returnVar = jsvSkipNameAndUnLock(returnVarName);
 			if (returnVarName) // could have failed with out of memory
 				jsvSetValueOfName(returnVarName, 0); // remove return value (which helps stops circular references)
-			jsvUnLock(functionRoot);
+			if (!jspFramePoolPut(function, functionRoot, paramCount, returnVarName))
+				jsvUnLock(functionRoot);
 		}
 
 
@@ -682,7 +965,7 @@ NO_INLINE JsVar *jspeFunctionCall(JsVar *function, JsVar *functionName, JsVar *t
 }
 
 JsVar *jspeFactorSingleId() {
-	JsVar *a = JSP_SHOULD_EXECUTE ? jspeiFindInScopes(jslGetTokenValueAsString(execInfo.lex)) : 0;
+	JsVar *a = JSP_SHOULD_EXECUTE ? jspeiFindIdentifier() : 0;
 	if (JSP_SHOULD_EXECUTE && !a) {
 		const char *tokenName = jslGetTokenValueAsString(execInfo.lex); // BEWARE - this won't hang around forever!
 		/* Special case! We haven't found the variable, so check out
@@ -713,6 +996,39 @@ JsVar *jspeFactorSingleId() {
 	return a;
 }
 
+/** Make a name on object for a field that was found somewhere else, eg. in a
+ * prototype (see jspGetNamedFieldInParents). Unlocks child. */
+static JsVar *jspNewFieldName(JsVar *object, const char *name, JsVar *child) {
+	// Get rid of existing name
+	child = jsvSkipNameAndUnLock(child);
+	// create a new name
+	JsVar *nameVar = jsvNewFromString(name);
+	JsVar *newChild = jsvCreateNewChild(object, nameVar, child);
+	jsvUnLock(nameVar);
+	jsvUnLock(child);
+	return newChild;
+}
+
+/// Some fields get created if they weren't found anywhere (see jspGetNamedFieldInParents)
+static JsVar *jspNewMissingField(JsVar *object, const char *name) {
+	JsVar *child = 0;
+	if (jsvIsFunction(object) && strcmp(name, JSPARSE_PROTOTYPE_VAR)==0) {
+		// prototype is supposed to be an object
+		JsVar *proto = jsvNewWithFlags(JSV_OBJECT);
+		// make sure it has a 'constructor' variable that points to the object it was part of
+		jsvObjectSetChild(proto, JSPARSE_CONSTRUCTOR_VAR, object);
+		child = jsvAddNamedChild(object, proto, JSPARSE_PROTOTYPE_VAR);
+		jspEnsureIsPrototype(object, child);
+		jsvUnLock(proto);
+	} else if (strcmp(name, JSPARSE_INHERITS_VAR)==0) {
+		const char *objName = jswGetBasicObjectName(object);
+		if (objName) {
+			child = jspNewPrototype(objName);
+		}
+	}
+	return child;
+}
+
 /// Used by jspGetNamedField / jspGetVarNamedField
 static NO_INLINE JsVar *jspGetNamedFieldInParents(JsVar *object, const char* name, bool returnName) {
 	// Now look in prototypes
@@ -732,34 +1048,12 @@ static NO_INLINE JsVar *jspGetNamedFieldInParents(JsVar *object, const char* nam
 	 * anyway - so in both cases, strip the name if it is there, and create
 	 * a new name.
 	 */
-	if (child && returnName) {
-		// Get rid of existing name
-		child = jsvSkipNameAndUnLock(child);
-		// create a new name
-		JsVar *nameVar = jsvNewFromString(name);
-		JsVar *newChild = jsvCreateNewChild(object, nameVar, child);
-		jsvUnLock(nameVar);
-		jsvUnLock(child);
-		child = newChild;
-	}
+	if (child && returnName)
+		child = jspNewFieldName(object, name, child);
 
 	// If not found and is the prototype, create it
-	if (!child) {
-		if (jsvIsFunction(object) && strcmp(name, JSPARSE_PROTOTYPE_VAR)==0) {
-			// prototype is supposed to be an object
-			JsVar *proto = jsvNewWithFlags(JSV_OBJECT);
-			// make sure it has a 'constructor' variable that points to the object it was part of
-			jsvObjectSetChild(proto, JSPARSE_CONSTRUCTOR_VAR, object);
-			child = jsvAddNamedChild(object, proto, JSPARSE_PROTOTYPE_VAR);
-			jspEnsureIsPrototype(object, child);
-			jsvUnLock(proto);
-		} else if (strcmp(name, JSPARSE_INHERITS_VAR)==0) {
-			const char *objName = jswGetBasicObjectName(object);
-			if (objName) {
-				child = jspNewPrototype(objName);
-			}
-		}
-	}
+	if (!child)
+		child = jspNewMissingField(object, name);
 
 	return child;
 }
@@ -841,6 +1135,156 @@ JsVar *jspCallNamedFunction(JsVar *object, char* name, int argCount, JsVar **arg
 	return jspeFunctionCall(child, 0, object, false, argCount, argPtr);
 }
 
+/* The field cache remembers where `object.name` was found the last time the
+ * code at a given position ran, so next time we don't have to search the
+ * object, its prototypes and the built-in functions again.
+ *
+ * A name that was found in the object itself is used for as long as it is
+ * still in the object. Anything else is only used while jsvGetShapeVersion is
+ * what it was when it was found, as adding or removing a field anywhere could
+ * change where it is found. Entries hold refs on the code and the name, but
+ * not on the object (so we don't keep it from being freed) - instead
+ * jspFieldCacheForget is called when it goes away. */
+#define JSP_FIELD_CACHE_SIZE 16
+
+typedef struct {
+	JsVarRef code; ///< The code the field access is in (or 0 if this entry is unused)
+	size_t codePos; ///< Where in the code the field's name is
+	JsVarRef object; ///< What the field was looked up on - or 0 if it was a built-in object like Math (see objectPtr)
+	void (*objectPtr)(void); ///< If object==0, the native function that the field was looked up on
+	JsVarRef name; ///< The name the field was found as - or 0 if it was a built-in function (see builtinPtr)
+	bool isOwn; ///< Is name a child of the object itself, rather than of a prototype?
+	void (*builtinPtr)(void); ///< If name==0, the built-in function that was found
+	unsigned short builtinArgTypes;
+	unsigned int shape; ///< jsvGetShapeVersion when this was made
+} JspFieldCacheEntry;
+
+static JspFieldCacheEntry jspFieldCache[JSP_FIELD_CACHE_SIZE];
+static unsigned int jspFieldCacheHits, jspFieldCacheMisses;
+
+/// Built-in objects like Math are new vars each time, so we remember them by their native function instead
+static bool jspFieldCacheIsBuiltInObject(JsVar *object) {
+	return jsvIsNativeFunction(object) && !jsvGetFirstChild(object);
+}
+
+static void jspFieldCacheFree(JspFieldCacheEntry *e) {
+	JsVarRef code = e->code, name = e->name;
+	if (!code) return;
+	// unreffing could free things, and get us called again - so empty the entry first
+	e->code = 0;
+	e->name = 0;
+	jsvUnRefRef(code);
+	if (name) jsvUnRefRef(name);
+}
+
+/// Make the entry remember a field that was found on object (as name, if it isn't built in)
+static void jspFieldCacheSet(JspFieldCacheEntry *e, size_t codePos, JsVar *object, JsVar *name, bool isOwn) {
+	jspFieldCacheFree(e);
+	e->code = jsvGetRef(jsvRef(execInfo.lex->sourceVar));
+	e->codePos = codePos;
+	if (jspFieldCacheIsBuiltInObject(object)) {
+		e->object = 0;
+		e->objectPtr = object->varData.native.ptr;
+	} else
+		e->object = jsvGetRef(object);
+	e->name = name ? jsvGetRef(jsvRef(name)) : 0;
+	e->isOwn = isOwn;
+	e->shape = jsvGetShapeVersion();
+}
+
+/// Is the entry's name still a child of the entry's object? (it has siblings, or is the only child)
+static bool jspFieldCacheIsStillOwn(JspFieldCacheEntry *e, JsVar *object) {
+	return jspeiIsStillChild(object, _jsvGetAddressOf(e->name));
+}
+
+/// Forget everything in the field cache - returns true if anything was in it
+bool jspClearFieldCache() {
+	bool cleared = false;
+	int i;
+	for (i=0;i<JSP_FIELD_CACHE_SIZE;i++) {
+		if (jspFieldCache[i].code) cleared = true;
+		jspFieldCacheFree(&jspFieldCache[i]);
+	}
+	return cleared;
+}
+
+/// Forget anything in the field cache that was found on this object, as it's being freed
+void jspFieldCacheForget(JsVarRef object) {
+	int i;
+	for (i=0;i<JSP_FIELD_CACHE_SIZE;i++)
+		if (jspFieldCache[i].object==object && jspFieldCache[i].code)
+			jspFieldCacheFree(&jspFieldCache[i]);
+}
+
+/// Update the references held in the field cache after vars have been moved (see jsvCompact)
+void jspRemapFieldCache(JsVarRef (*getNewRef)(JsVarRef ref)) {
+	int i;
+	for (i=0;i<JSP_FIELD_CACHE_SIZE;i++) {
+		JspFieldCacheEntry *e = &jspFieldCache[i];
+		e->code = getNewRef(e->code);
+		e->object = getNewRef(e->object);
+		e->name = getNewRef(e->name);
+	}
+}
+
+/// How many field lookups the field cache has answered
+unsigned int jspGetFieldCacheHits() {
+	return jspFieldCacheHits;
+}
+
+/// How many field lookups couldn't be answered by the field cache
+unsigned int jspGetFieldCacheMisses() {
+	return jspFieldCacheMisses;
+}
+
+/** Like jspGetNamedField(object, name, true), for `object.name` where name is
+ * the current token - but using (and filling in) the field cache */
+static JsVar *jspGetNamedFieldAtToken(JsVar *object, const char *name) {
+	bool isBuiltIn = jspFieldCacheIsBuiltInObject(object);
+	if (!isBuiltIn && !jsvHasChildren(object))
+		return jspGetNamedField(object, name, true); // eg. a String - only built-ins, which we can't remember
+	JsVarRef code = jsvGetRef(execInfo.lex->sourceVar);
+	size_t codePos = jsvStringIteratorGetIndex(&execInfo.lex->tokenStart.it);
+	JspFieldCacheEntry *e = &jspFieldCache[((size_t)code*31 + codePos) % JSP_FIELD_CACHE_SIZE];
+	if (e->code==code && e->codePos==codePos) {
+		if (isBuiltIn ? (!e->object && e->objectPtr==object->varData.native.ptr) : e->object==jsvGetRef(object)) {
+			if (e->isOwn) {
+				if (jspFieldCacheIsStillOwn(e, object)) {
+					jspFieldCacheHits++;
+					return jsvLock(e->name);
+				}
+			} else if (e->shape==jsvGetShapeVersion()) {
+				jspFieldCacheHits++;
+				JsVar *child = e->name ? jsvLock(e->name) : jsvGetNativeFunction(e->builtinPtr, e->builtinArgTypes);
+				return child ? jspNewFieldName(object, name, child) : 0;
+			}
+		}
+	}
+	jspFieldCacheMisses++;
+
+	JsVar *child = isBuiltIn ? 0 : jsvFindChildFromString(object, name, false);
+	if (child) {
+		jspFieldCacheSet(e, codePos, object, child, true);
+		return child;
+	}
+	child = jspeiFindChildFromStringInParents(object, name);
+	if (child) {
+		jspFieldCacheSet(e, codePos, object, child, false);
+		return jspNewFieldName(object, name, child);
+	}
+	child = jswFindBuiltInFunction(object, name);
+	if (child) {
+		// getters give us a value rather than a function, and have to be called each time
+		if (jsvIsNativeFunction(child) && !jsvGetFirstChild(child)) {
+			jspFieldCacheSet(e, codePos, object, 0, false);
+			e->builtinPtr = child->varData.native.ptr;
+			e->builtinArgTypes = child->varData.native.argTypes;
+		}
+		return jspNewFieldName(object, name, child);
+	}
+	return jspNewMissingField(object, name);
+}
+
 NO_INLINE JsVar *jspeFactorMember(JsVar *a, JsVar **parentResult) {
 	/* The parent if we're executing a method call */
 	JsVar *parent = 0;
@@ -853,7 +1297,7 @@ NO_INLINE JsVar *jspeFactorMember(JsVar *a, JsVar **parentResult) {
 				const char *name = jslGetTokenValueAsString(execInfo.lex);
 
 				JsVar *aVar = jsvSkipName(a);
-				JsVar *child = jspGetNamedField(aVar, name, true);
+				JsVar *child = jspGetNamedFieldAtToken(aVar, name);
 				if (!child) {
 					if (jsvHasChildren(aVar)) {
 						// if no child found, create a pointer to where it could be
@@ -1207,14 +1651,15 @@ NO_INLINE JsVar *__jspePostfixExpression(JsVar *a) {
 		int op = execInfo.lex->tk;
 		JSP_ASSERT_MATCH(op);
 		if (JSP_SHOULD_EXECUTE) {
-			JsVar *one = jsvNewFromInteger(1);
 			JsVar *oldValue = jsvAsNumberAndUnLock(jsvSkipName(a)); // keep the old value (but convert to number)
-			JsVar *res = jsvMathsOpSkipNames(oldValue, one, op==LEX_PLUSPLUS ? '+' : '-');
-			jsvUnLock(one);
-
-			// in-place add/subtract
-			jspReplaceWith(a, res);
-			jsvUnLock(res);
+			// in-place add/subtract - without making new vars if the value is stored in the name
+			if (!jsvMathsOpIntoNameInt(a, 1, op==LEX_PLUSPLUS ? '+' : '-')) {
+				JsVar *one = jsvNewFromInteger(1);
+				JsVar *res = jsvMathsOpSkipNames(oldValue, one, op==LEX_PLUSPLUS ? '+' : '-');
+				jsvUnLock(one);
+				jspReplaceWith(a, res);
+				jsvUnLock(res);
+			}
 			// but then use the old value
 			jsvUnLock(a);
 			a = oldValue;
@@ -1230,7 +1675,7 @@ NO_INLINE JsVar *jspePostfixExpression() {
 		int op = execInfo.lex->tk;
 		JSP_ASSERT_MATCH(op);
 		a = jspePostfixExpression();
-		if (JSP_SHOULD_EXECUTE) {
+		if (JSP_SHOULD_EXECUTE && !jsvMathsOpIntoNameInt(a, 1, op==LEX_PLUSPLUS ? '+' : '-')) {
 			JsVar *one = jsvNewFromInteger(1);
 			JsVar *res = jsvMathsOpSkipNames(a, one, op==LEX_PLUSPLUS ? '+' : '-');
 			jsvUnLock(one);
@@ -1473,6 +1918,9 @@ NO_INLINE JsVar *__jspeAssignmentExpression(JsVar *lhs) {
 					}
 					jsvUnLock(currentValue);
 				}
+				JsVarInt rhsInt;
+				if (op && jsvGetImmediateInteger(rhs, &rhsInt) && jsvMathsOpIntoNameInt(lhs, rhsInt, op))
+					op = 0; // done it without making new vars
 				if (op) {
 					/* Fallback which does a proper add */
 					JsVar *res = jsvMathsOpSkipNames(lhs,rhs,op);
@@ -1555,7 +2003,7 @@ NO_INLINE JsVar *jspeStatementVar() {
 	while (hasComma && execInfo.lex->tk == LEX_ID && !jspIsInterrupted()) {
 		JsVar *a = 0;
 		if (JSP_SHOULD_EXECUTE) {
-			a = jspeiFindOnTop(jslGetTokenValueAsString(execInfo.lex), true);
+			a = jspeiFindIdentifierOnTop();
 			if (!a) { // out of memory
 				jspSetError(false);
 				return lastDefined;
@@ -2226,6 +2674,9 @@ void jspSoftInit() {
 }
 
 void jspSoftKill() {
+	jspClearFieldCache(); // it holds refs, which we don't want saved
+	jspClearFramePool(); // and this holds locks
+	jsvClearNativeFunctionCache(); // as does this
 	jsvUnLock(execInfo.hiddenRoot);
 	execInfo.hiddenRoot = 0;
 	jsvUnLock(execInfo.root);
@@ -2235,6 +2686,8 @@ void jspSoftKill() {
 
 void jspInit() {
 	jspSoftInit();
+	jspFieldCacheHits = 0;
+	jspFieldCacheMisses = 0;
 }
 
 void jspKill() {
@@ -2355,3 +2808,186 @@ JsVar *jspGetPrototypeOwner(JsVar *proto) {
 	}
 	return 0;
 }
+
+#ifndef SAVE_ON_FLASH
+/* Sampling profiler. When it's on (see E.setProfile), a repeating Utility
+ * Timer task looks at which code is executing and where in it we are, and
+ * counts how many times it has seen each place. This happens in an IRQ, so we
+ * can't allocate or lock anything - we just remember the reference of the
+ * code and the character index, and work out which function and line those
+ * were when E.getProfile is called. A place is looked for in only a few
+ * entries, so if the table is full the sample is just counted as lost. */
+#ifndef JSP_PROFILE_ENTRIES
+#define JSP_PROFILE_ENTRIES 64 ///< How many different places in the code we can count samples of
+#endif
+#define JSP_PROFILE_MAX_PROBES 8 ///< How many entries to look at before we give up on a sample
+typedef struct {
+	unsigned int position; ///< Index of the character after the start of the token we were at (see jspGetNamedFieldAtToken)
+	JsVarRef code; ///< The code that was executing (or 0 if this entry is unused)
+	unsigned short count; ///< How many samples were taken here
+} JspProfileEntry;
+static JspProfileEntry jspProfile[JSP_PROFILE_ENTRIES];
+static unsigned int jspProfileSamples; ///< How many samples we've taken
+static unsigned int jspProfileIdle; ///< How many samples were taken when no JS was executing
+static unsigned int jspProfileLost; ///< How many samples we couldn't count because the table was full
+
+/// Called from the Utility Timer IRQ - count a sample of where we are executing
+static void jspProfileSample(JsSysTime time) {
+	NOT_USED(time);
+	jspProfileSamples++;
+	JsLex *lex = execInfo.lex;
+	if (!lex || !lex->sourceVar) {
+		jspProfileIdle++;
+		return;
+	}
+	JsVarRef code = jsvGetRef(lex->sourceVar);
+	unsigned int position = (unsigned int)jsvStringIteratorGetIndex(&lex->tokenStart.it);
+	unsigned int i, h = (unsigned int)code*31 + position;
+	for (i=0;i<JSP_PROFILE_MAX_PROBES;i++) {
+		JspProfileEntry *e = &jspProfile[(h+i) % JSP_PROFILE_ENTRIES];
+		if (!e->code) {
+			e->code = code;
+			e->position = position;
+		}
+		if (e->code==code && e->position==position) {
+			if (e->count < 0xFFFF) e->count++;
+			return;
+		}
+	}
+	jspProfileLost++;
+}
+
+/// Start sampling where code is executing every 'period' (clearing the old samples), or stop if period is 0
+void jspSetProfile(JsSysTime period) {
+	jstStopExecuteFn(jspProfileSample);
+	if (!period) return;
+	jshInterruptOff();
+	memset(jspProfile, 0, sizeof(jspProfile));
+	jspProfileSamples = 0;
+	jspProfileIdle = 0;
+	jspProfileLost = 0;
+	jshInterruptOn();
+	jstExecuteFn(jspProfileSample, period);
+}
+
+/// Update the references held by the profiler after vars have been moved (see jsvCompact)
+void jspRemapProfile(JsVarRef (*getNewRef)(JsVarRef ref)) {
+	int i;
+	jshInterruptOff(); // the IRQ writes to the table too
+	for (i=0;i<JSP_PROFILE_ENTRIES;i++)
+		if (jspProfile[i].code)
+			jspProfile[i].code = getNewRef(jspProfile[i].code);
+	jshInterruptOn();
+}
+
+/** Return the samples taken by the profiler as an object, with an array of
+ * the functions and lines that the samples were in, most samples first */
+JsVar *jspGetProfile() {
+	JspProfileEntry profile[JSP_PROFILE_ENTRIES];
+	JsVarRef codes[JSP_PROFILE_ENTRIES]; ///< The different pieces of code that were sampled
+	JsVar *functions[JSP_PROFILE_ENTRIES]; ///< The function each piece of code belongs to, if we find one
+	bool codeFound[JSP_PROFILE_ENTRIES];
+	int entryCode[JSP_PROFILE_ENTRIES]; ///< Index in codes of each entry's code, or -1 if we're not using it
+	size_t lines[JSP_PROFILE_ENTRIES];
+	unsigned int counts[JSP_PROFILE_ENTRIES]; ///< Samples for each entry, including those of entries on the same line
+	unsigned int samples, idle, lost;
+	int i, j, codeCount = 0;
+	jshInterruptOff();
+	memcpy(profile, jspProfile, sizeof(profile));
+	samples = jspProfileSamples;
+	idle = jspProfileIdle;
+	lost = jspProfileLost;
+	jshInterruptOn();
+
+	for (i=0;i<JSP_PROFILE_ENTRIES;i++) {
+		entryCode[i] = -1;
+		counts[i] = profile[i].count;
+		if (!profile[i].code) continue;
+		for (j=0;j<codeCount && codes[j]!=profile[i].code;j++);
+		if (j==codeCount) {
+			codes[codeCount] = profile[i].code;
+			functions[codeCount] = 0;
+			codeFound[codeCount] = false;
+			codeCount++;
+		}
+		entryCode[i] = j;
+	}
+
+	/* The code we sampled may since have been freed (and its var reused), so
+	 * we only use code that is still a string. We go through all the vars
+	 * rather than just looking, as a reference could now be in the middle of
+	 * a flat string's data. While we're there, find out which function each
+	 * piece of code belongs to. */
+	JsVarRef ref;
+	for (ref=1;ref<=jsvGetMemoryTotal();ref++) {
+		JsVar *v = _jsvGetAddressOf(ref);
+		if (jsvIsString(v)) {
+			for (j=0;j<codeCount;j++)
+				if (codes[j]==ref) codeFound[j] = true;
+		} else if (jsvIsFunction(v)) {
+			JsVar *function = jsvLock(ref);
+			JsVar *codeName = jsvFindChildFromString(function, JSPARSE_FUNCTION_CODE_NAME, false);
+			JsVarRef code = codeName ? jsvGetFirstChild(codeName) : 0;
+			jsvUnLock(codeName);
+			for (j=0;j<codeCount;j++)
+				if (code && codes[j]==code && !functions[j])
+					functions[j] = jsvLockAgain(function);
+			jsvUnLock(function);
+		}
+		if (jsvIsFlatString(v))
+			ref = (JsVarRef)(ref+jsvGetFlatStringBlocks(v)); // skip over the string's data - it's not made of JsVars
+	}
+
+	// Work out the lines, and add together entries that are on the same line
+	for (i=0;i<JSP_PROFILE_ENTRIES;i++) {
+		if (entryCode[i]<0 || !codeFound[entryCode[i]]) {
+			entryCode[i] = -1;
+			continue;
+		}
+		JsVar *code = jsvLock(profile[i].code);
+		size_t col;
+		// the position is of the character after the token's first one
+		jsvGetLineAndCol(code, profile[i].position ? profile[i].position-1 : 0, &lines[i], &col);
+		jsvUnLock(code);
+		for (j=0;j<i;j++) {
+			if (entryCode[j]==entryCode[i] && lines[j]==lines[i]) {
+				counts[j] += counts[i];
+				entryCode[i] = -1;
+				break;
+			}
+		}
+	}
+
+	JsVar *result = jsvNewWithFlags(JSV_OBJECT);
+	JsVar *places = jsvNewWithFlags(JSV_ARRAY);
+	if (result && places) {
+		jsvUnLock(jsvObjectSetChild(result, "samples", jsvNewFromInteger((JsVarInt)samples)));
+		jsvUnLock(jsvObjectSetChild(result, "idle", jsvNewFromInteger((JsVarInt)idle)));
+		jsvUnLock(jsvObjectSetChild(result, "lost", jsvNewFromInteger((JsVarInt)lost)));
+		jsvObjectSetChild(result, "lines", places);
+		while (true) {
+			// pick the entry with the most samples that we haven't added yet
+			int best = -1;
+			for (i=0;i<JSP_PROFILE_ENTRIES;i++)
+				if (entryCode[i]>=0 && (best<0 || counts[i]>counts[best]))
+					best = i;
+			if (best<0) break;
+			JsVar *function = functions[entryCode[best]];
+			entryCode[best] = -1;
+			JsVar *place = jsvNewWithFlags(JSV_OBJECT);
+			if (!place) break; // out of memory
+			if (function) {
+				JsVar *name = jsvGetPathTo(execInfo.root, function, 4, 0);
+				if (name) jsvUnLock(jsvObjectSetChild(place, "name", name));
+			}
+			jsvUnLock(jsvObjectSetChild(place, "line", jsvNewFromInteger((JsVarInt)lines[best])));
+			jsvUnLock(jsvObjectSetChild(place, "count", jsvNewFromInteger((JsVarInt)counts[best])));
+			jsvArrayPushAndUnLock(places, place);
+		}
+	}
+	jsvUnLock(places);
+	for (j=0;j<codeCount;j++)
+		jsvUnLock(functions[j]);
+	return result;
+}
+#endif
@@ -52,6 +52,26 @@ void jspSetException(JsVar *value);
 JsVar *jspGetException();
 /** Return a stack trace string if there was one (and clear it) */
 JsVar *jspGetStackTrace();
+/// Throw away the token caches of all functions (returns true if any were freed)
+bool jspFreeTokenCaches();
+/// Forget where fields were found by `object.name` (returns true if anything was remembered)
+bool jspClearFieldCache();
+/// Forget anything in the field cache that was found on this object, as it's being freed
+void jspFieldCacheForget(JsVarRef object);
+/// Update the references held in the field cache after vars have been moved (see jsvCompact)
+void jspRemapFieldCache(JsVarRef (*getNewRef)(JsVarRef ref));
+unsigned int jspGetFieldCacheHits(); ///< How many field lookups the field cache has answered
+unsigned int jspGetFieldCacheMisses(); ///< How many field lookups couldn't be answered by the field cache
+/// Free the scopes kept for reuse by function calls (returns true if there were any)
+bool jspClearFramePool();
+#ifndef SAVE_ON_FLASH
+/// Start sampling where code is executing every 'period' (see E.setProfile), or stop if period is 0
+void jspSetProfile(JsSysTime period);
+/// Return the samples taken by the profiler as an object (see E.getProfile)
+JsVar *jspGetProfile();
+/// Update the references held by the profiler after vars have been moved (see jsvCompact)
+void jspRemapProfile(JsVarRef (*getNewRef)(JsVarRef ref));
+#endif
 
 /** Execute code form a variable and return the result. If parseTwice is set,
  * we run over the variable twice - once to pick out function declarations,
@@ -109,6 +129,15 @@ typedef enum  {
   EXEC_CTRL_C_MASK = EXEC_CTRL_C | EXEC_CTRL_C_WAIT, // Ctrl-C was pressed at some point
 } JsExecFlags;
 
+/** A function call whose local variables can be found by slot number, rather
+ * than by searching for them by name (see jslTokenCacheAssignSlots) */
+typedef struct JspFrame {
+  JsVar *scope; ///< The function's scope, which its local variables are in
+  JsLex *lex; ///< The lexer for the function's code - the slot numbers are from its token cache
+  JsVar **slots; ///< Locked names of the local variables, by slot number (or 0 if we haven't found one yet)
+  unsigned int slotCount;
+} JspFrame;
+
 /** This structure is used when parsing the JavaScript. It contains
  * everything that should be needed. */
 typedef struct {
@@ -121,6 +150,8 @@ typedef struct {
   int scopeCount;
   /// Value of 'this' reserved word
   JsVar *thisVar;
+  /// The function call we're executing, if it keeps its local variables in slots (or 0)
+  JspFrame *frame;
 
   JsExecFlags execute;
 } JsExecInfo;
@@ -228,6 +228,33 @@ bool jstGetLastBufferTimerTask(JsVar *var, UtilTimerTask *task) {
 }
 #endif
 
+#ifndef SAVE_ON_FLASH
+/** Call markRef for every var that a buffer task may read from. The IRQ reads
+ * them without locking, so jsvCompact uses this to know not to move them */
+void jstMarkBufferTimerTasks(void (*markRef)(JsVarRef ref)) {
+	JsVarRef refs[UTILTIMERTASK_TASKS*3];
+	unsigned int i, count = 0;
+	// the IRQ may finish tasks or swap buffers, so just copy the refs with it off
+	jshInterruptOff();
+	unsigned char ptr = utilTimerTasksTail;
+	while (ptr != utilTimerTasksHead) {
+		UtilTimerTask *task = &utilTimerTasks[ptr];
+		if (UET_IS_BUFFER_EVENT(task->type)) {
+			if (task->data.buffer.var)
+				refs[count++] = jsvGetRef(task->data.buffer.var);
+			if (task->data.buffer.currentBuffer)
+				refs[count++] = task->data.buffer.currentBuffer;
+			if (task->data.buffer.nextBuffer)
+				refs[count++] = task->data.buffer.nextBuffer;
+		}
+		ptr = (ptr+1) & (UTILTIMERTASK_TASKS-1);
+	}
+	jshInterruptOn();
+	for (i=0;i<count;i++)
+		markRef(refs[i]);
+}
+#endif
+
 /// Is the timer full - can it accept any other signals?
 static bool utilTimerIsFull() {
 	unsigned char nextHead = (utilTimerTasksHead+1) & (UTILTIMERTASK_TASKS-1);
@@ -371,9 +398,8 @@ bool jstStartSignal(JsSysTime startTime, JsSysTime period, Pin pin, JsVar *curre
 	return utilTimerInsertTask(&task);
 }
 
-/// Return true if a timer task for the given variable exists (and set 'task' to it)
-bool jstStopBufferTimerTask(JsVar *var) {
-	JsVarRef ref = jsvGetRef(var);
+/// Remove the first timer task for which isTask returns true - return true if one was found
+static bool jstStopTimerTask(bool (*isTask)(UtilTimerTask *task, void *data), void *data) {
 	jshInterruptOff();
 	unsigned char ptr = utilTimerTasksHead;
 	if (ptr != utilTimerTasksTail) {
@@ -381,20 +407,18 @@ bool jstStopBufferTimerTask(JsVar *var) {
 		ptr = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
 		// now we're at the last timer task - work back until we've just gone back past utilTimerTasksTail
 		while (ptr != endPtr) {
-			if (UET_IS_BUFFER_EVENT(utilTimerTasks[ptr].type)) {
-				if (utilTimerTasks[ptr].data.buffer.currentBuffer==ref || utilTimerTasks[ptr].data.buffer.nextBuffer==ref) {
-					// shift tail back along
-					unsigned char next = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
-					while (next!=endPtr) {
-						utilTimerTasks[ptr] = utilTimerTasks[next];
-						ptr = next;
-						next = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
-					}
-					// move 'end' pointer back
-					utilTimerTasksTail = (utilTimerTasksTail+1) & (UTILTIMERTASK_TASKS-1);
-					jshInterruptOn();
-					return true;
+			if (isTask(&utilTimerTasks[ptr], data)) {
+				// shift tail back along
+				unsigned char next = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
+				while (next!=endPtr) {
+					utilTimerTasks[ptr] = utilTimerTasks[next];
+					ptr = next;
+					next = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
 				}
+				// move 'end' pointer back
+				utilTimerTasksTail = (utilTimerTasksTail+1) & (UTILTIMERTASK_TASKS-1);
+				jshInterruptOn();
+				return true;
 			}
 			ptr = (ptr+UTILTIMERTASK_TASKS-1) & (UTILTIMERTASK_TASKS-1);
 		}
@@ -402,6 +426,38 @@ bool jstStopBufferTimerTask(JsVar *var) {
 	jshInterruptOn();
 	return false;
 }
+
+static bool jstIsBufferTimerTask(UtilTimerTask *task, void *data) {
+	JsVarRef ref = *(JsVarRef*)data;
+	return UET_IS_BUFFER_EVENT(task->type) &&
+			(task->data.buffer.currentBuffer==ref || task->data.buffer.nextBuffer==ref);
+}
+
+/// Stop the timer task that's reading or writing the given variable - return true if there was one
+bool jstStopBufferTimerTask(JsVar *var) {
+	JsVarRef ref = jsvGetRef(var);
+	return jstStopTimerTask(jstIsBufferTimerTask, &ref);
+}
+
+/// Start calling fn (from the Utility Timer IRQ) every 'period'
+bool jstExecuteFn(void (*fn)(JsSysTime time), JsSysTime period) {
+	UtilTimerTask task;
+	task.time = jshGetSystemTime() + period;
+	task.repeatInterval = (unsigned int)period;
+	task.type = UET_EXECUTE;
+	task.data.execute = fn;
+	WAIT_UNTIL(!utilTimerIsFull(), "Utility Timer");
+	return utilTimerInsertTask(&task);
+}
+
+static bool jstIsExecuteFnTask(UtilTimerTask *task, void *data) {
+	return task->type==UET_EXECUTE && (void*)task->data.execute==data;
+}
+
+/// Stop calling fn from the Utility Timer - return true if we were
+bool jstStopExecuteFn(void (*fn)(JsSysTime time)) {
+	return jstStopTimerTask(jstIsExecuteFnTask, (void*)fn);
+}
 #endif
 
 void jstReset() {
@@ -118,6 +118,15 @@ bool jstStartSignal(JsSysTime startTime, JsSysTime period, Pin pin, JsVar *curre
 /// Stop a timer task
 bool jstStopBufferTimerTask(JsVar *var);
 
+/// Start calling fn (from the Utility Timer IRQ) every 'period'
+bool jstExecuteFn(void (*fn)(JsSysTime time), JsSysTime period);
+
+/// Stop calling fn from the Utility Timer - return true if we were
+bool jstStopExecuteFn(void (*fn)(JsSysTime time));
+
+/// Call markRef for every var that a buffer task may read from (so jsvCompact doesn't move them)
+void jstMarkBufferTimerTasks(void (*markRef)(JsVarRef ref));
+
 /// Stop ALL timer tasks (including digitalPulse - use this when resetting the VM)
 void jstReset();
 
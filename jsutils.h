@@ -23,7 +23,7 @@
 #endif
 #include <stdarg.h> // for va_args
 #include <stdint.h>
-#ifndef ARM
+#if !defined(ARM) && !defined(LINUX)
 #define ARM
 #endif
 #if defined(LINUX) || defined(ARDUINO_AVR)
@@ -167,6 +167,7 @@ typedef  uint64_t JsSysTime;
 #define JS_HIDDEN_CHAR '>' // initial character of var name determines that we shouldn't see this stuff
 #define JS_HIDDEN_CHAR_STR ">"
 #define JSPARSE_FUNCTION_CODE_NAME JS_HIDDEN_CHAR_STR"cod" // the function's code!
+#define JSPARSE_FUNCTION_TOKENS_NAME JS_HIDDEN_CHAR_STR"tok" // the function's code, already tokenised (see jslNewTokenCache)
 #define JSPARSE_FUNCTION_SCOPE_NAME JS_HIDDEN_CHAR_STR"sco" // the scope of the function's definition
 #define JSPARSE_FUNCTION_NAME_NAME JS_HIDDEN_CHAR_STR"nam" // for named functions (a = function foo() { foo(); })
 #define JSPARSE_EXCEPTION_VAR "except" // when exceptions are thrown, they're stored in the root scope
@@ -409,6 +410,7 @@ typedef enum {
   JSERR_CALLBACK = 4, ///< A callback (on data/watch/timer) caused an error and was removed
   JSERR_LOW_MEMORY = 8, ///< Memory is running low - Espruino had to run a garbage collection pass or remove some of the command history
   JSERR_MEMORY = 16, ///< Espruino ran out of memory and was unable to allocate some data that it needed.
+  JSERR_EVENT_QUEUE_FULL = 32, ///< The event queue was full, so an event (callback) was dropped
 } PACKED_FLAGS JsErrorFlags;
 
 /** Error flags for things that we don't really want to report on the console,
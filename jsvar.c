@@ -20,6 +20,7 @@
 #include "jswrap_math.h" // for jswrap_math_mod
 #include "jswrap_object.h" // for jswrap_object_toString
 #include "jswrap_arraybuffer.h" // for jsvNewTypedArray
+#include "jstimer.h" // for jstMarkBufferTimerTasks
 
 /** Basically, JsVars are stored in one big array, so save the need for
  * lots of memory allocation. On Linux, the arrays are in blocks, so that
@@ -38,8 +39,158 @@ JsVar jsVars[JSVAR_CACHE_SIZE];
 unsigned int jsVarsSize = JSVAR_CACHE_SIZE;
 #endif
 
+/* Free vars are kept in a linked list (through nextSibling) so allocation is
+ * quick. Vars can be allocated and freed from IRQs, so where the processor
+ * lets us, the head of the list is changed with load-linked/store-conditional
+ * rather than by turning interrupts off:
+ *
+ *  - Cortex-M3/M4: LDREX/STREX. Taking an exception clears the exclusive
+ *    monitor, so if an IRQ touches the list between the two, STREX fails
+ *    and we just try again.
+ *  - Linux: the head is stored with a count of how many times it has been
+ *    changed, and replaced with a compare-and-swap. A stale head (even one
+ *    that has been taken off and put back) never matches.
+ *  - Anything else (eg. Cortex-M0): interrupts off. */
+#if defined(__GNUC__) && (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__))
+#define JSV_FREE_LIST_LDREX
+#define JSV_FREE_LIST_ATOMIC
+#elif defined(__GNUC__) && defined(LINUX) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define JSV_FREE_LIST_CAS
+#define JSV_FREE_LIST_ATOMIC
+#endif
+#define JSV_FREE_LIST_TAKE_MAX 16 ///< Most vars jsvFreeListTakeMany will take at once
+
+#ifdef JSV_FREE_LIST_CAS
+typedef uint64_t JsvFreeList; ///< The head of the free list (bottom 32 bits) and how many times it has been changed
+static JsvFreeList jsvFreeList;
+
+static ALWAYS_INLINE JsvFreeList jsvFreeListLoad() {
+  return __atomic_load_n(&jsvFreeList, __ATOMIC_ACQUIRE);
+}
+static ALWAYS_INLINE JsVarRef jsvFreeListGetRef(JsvFreeList head) {
+  return (JsVarRef)(head & 0xFFFFFFFF);
+}
+/// Make 'ref' the head of the free list if it hasn't changed since we loaded 'head'
+static ALWAYS_INLINE bool jsvFreeListStore(JsvFreeList head, JsVarRef ref) {
+  JsvFreeList newHead = (((head>>32)+1)<<32) | ref;
+  return __atomic_compare_exchange_n(&jsvFreeList, &head, newHead, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+static ALWAYS_INLINE void jsvFreeListCancel() {
+}
+static ALWAYS_INLINE JsVarRef jsvGetFirstEmpty() {
+  return jsvFreeListGetRef(jsvFreeListLoad());
+}
+/// Only when nothing else can be using the free list
+static ALWAYS_INLINE void jsvSetFirstEmpty(JsVarRef ref) {
+  jsvFreeList = (((jsvFreeList>>32)+1)<<32) | ref;
+}
+#else
+typedef JsVarRef JsvFreeList;
 JsVarRef jsVarFirstEmpty; ///< reference of first unused variable (variables are in a linked list)
 
+#ifdef JSV_FREE_LIST_LDREX
+static ALWAYS_INLINE JsvFreeList jsvFreeListLoad() {
+  uint32_t r;
+  if (sizeof(JsVarRef)==1)
+    __asm__ volatile ("ldrexb %0, [%1]" : "=r" (r) : "r" (&jsVarFirstEmpty) : "memory");
+  else if (sizeof(JsVarRef)==2)
+    __asm__ volatile ("ldrexh %0, [%1]" : "=r" (r) : "r" (&jsVarFirstEmpty) : "memory");
+  else
+    __asm__ volatile ("ldrex %0, [%1]" : "=r" (r) : "r" (&jsVarFirstEmpty) : "memory");
+  return (JsVarRef)r;
+}
+/// Make 'ref' the head of the free list if nothing has touched it since jsvFreeListLoad
+static ALWAYS_INLINE bool jsvFreeListStore(JsvFreeList head, JsVarRef ref) {
+  uint32_t failed;
+  NOT_USED(head);
+  if (sizeof(JsVarRef)==1)
+    __asm__ volatile ("strexb %0, %2, [%1]" : "=&r" (failed) : "r" (&jsVarFirstEmpty), "r" ((uint32_t)ref) : "memory");
+  else if (sizeof(JsVarRef)==2)
+    __asm__ volatile ("strexh %0, %2, [%1]" : "=&r" (failed) : "r" (&jsVarFirstEmpty), "r" ((uint32_t)ref) : "memory");
+  else
+    __asm__ volatile ("strex %0, %2, [%1]" : "=&r" (failed) : "r" (&jsVarFirstEmpty), "r" ((uint32_t)ref) : "memory");
+  return failed==0;
+}
+static ALWAYS_INLINE void jsvFreeListCancel() {
+  __asm__ volatile ("clrex" ::: "memory");
+}
+#endif
+
+static ALWAYS_INLINE JsVarRef jsvFreeListGetRef(JsvFreeList head) {
+  return head;
+}
+static ALWAYS_INLINE JsVarRef jsvGetFirstEmpty() {
+  return jsVarFirstEmpty;
+}
+/// Only when nothing else can be using the free list
+static ALWAYS_INLINE void jsvSetFirstEmpty(JsVarRef ref) {
+  jsVarFirstEmpty = ref;
+}
+#endif
+
+/* Rearranging memory (jsvCompact, and finding space for a flat string) walks
+ * over every var, which takes too long to do with IRQs off. Instead the free
+ * list is detached first: IRQs then find it empty, so they can't allocate
+ * anything. A var they free goes on a list of its own, and looks like a
+ * locked var (which can't be moved) until jsvFreeListAttach puts it back on
+ * the free list - so nothing rearranging memory uses it, and it isn't lost if
+ * the free list has been rebuilt past it already. */
+static volatile bool jsvFreeListDetached;
+static JsVarRef jsvFreeListPending; ///< Vars freed while the free list was detached, linked through nextSibling
+/// What a var on jsvFreeListPending looks like: a locked null that jsvCompact won't move
+#define JSV_FREE_PENDING ((JsVarFlags)(JSV_NULL|JSV_GARBAGE_COLLECT|JSV_LOCK_ONE))
+
+/// Empty the free list so IRQs can't use it, returning what was in it (see jsvFreeListAttach)
+static JsVarRef jsvFreeListDetach() {
+  JsVarRef first;
+  jsvFreeListDetached = true;
+#ifdef JSV_FREE_LIST_ATOMIC
+  JsvFreeList head;
+  do {
+    head = jsvFreeListLoad();
+    first = jsvFreeListGetRef(head);
+  } while (!jsvFreeListStore(head, 0));
+#else
+  jshInterruptOff();
+  first = jsVarFirstEmpty;
+  jsVarFirstEmpty = 0;
+  jshInterruptOn();
+#endif
+  return first;
+}
+
+/* Heap statistics, kept up to date as vars are allocated and freed so asking
+ * about memory doesn't mean walking over every var. They're only counted from
+ * scratch in jsvCreateEmptyVarList, when memory has been loaded or reset - a
+ * walk over the vars can't be used to count them while IRQs can still free
+ * things, as it wouldn't know what was freed behind it. Locked vars aren't counted, as that would put more work on every
+ * jsvLock and jsvUnLock - see jsvGetMemoryLocked. */
+static unsigned int jsvUsedBlocks; ///< Blocks in use, including flat string data
+static unsigned int jsvFlatStringBlocks; ///< Blocks used by flat strings (headers and data)
+static unsigned int jsvLargestFreeRun; ///< Longest run of free blocks - only if jsvLargestFreeRunValid
+static bool jsvLargestFreeRunValid;
+
+/** Add to or take from one of the heap statistics. Vars can be freed from
+ * IRQs too, so this must not lose an IRQ's change */
+static ALWAYS_INLINE void jsvStatAdd(unsigned int *stat, unsigned int n) {
+#ifdef JSV_FREE_LIST_ATOMIC
+  __atomic_fetch_add(stat, n, __ATOMIC_RELAXED);
+#else
+  jshInterruptOff();
+  *stat += n;
+  jshInterruptOn();
+#endif
+}
+static ALWAYS_INLINE void jsvStatSub(unsigned int *stat, unsigned int n) {
+#ifdef JSV_FREE_LIST_ATOMIC
+  __atomic_fetch_sub(stat, n, __ATOMIC_RELAXED);
+#else
+  jshInterruptOff();
+  *stat -= n;
+  jshInterruptOn();
+#endif
+}
+
 /** Return a pointer - UNSAFE for null refs.
  * This is effectively a Lock without locking! */
 static ALWAYS_INLINE JsVar *jsvGetAddressOf(JsVarRef ref) {
@@ -56,6 +207,88 @@ JsVar *_jsvGetAddressOf(JsVarRef ref) {
   return jsvGetAddressOf(ref);
 }
 
+/** State for the incremental garbage collector (see jsvGarbageCollectStep).
+ * A var is 'white' while JSV_GARBAGE_COLLECT is set. Marking clears the flag
+ * and pushes the var onto jsvGCStack ('grey') until whatever it links to has
+ * been shaded too ('black'). If the stack fills up, vars are marked but not
+ * pushed, and we rescan every marked var once the stack is empty. The full
+ * collection (jsvGarbageCollect) marks with the same stack, so neither ever
+ * recurses. */
+typedef enum {
+  JSVGC_IDLE,  ///< No collection in progress
+  JSVGC_CLEAR, ///< Setting JSV_GARBAGE_COLLECT on every used var
+  JSVGC_ROOTS, ///< Shading every locked var
+  JSVGC_MARK,  ///< Scanning grey vars, then checking for locked vars that are still white
+  JSVGC_SWEEP, ///< Freeing everything that is still white
+} PACKED_FLAGS JsvGCPhase;
+
+#define JSV_GC_STACK_SIZE 32 ///< How many grey vars we can remember before we have to rescan
+#define JSV_GC_TIME_CHECK 16 ///< How many vars we look at between checks of the system time
+
+static JsvGCPhase jsvGCPhase = JSVGC_IDLE;
+static unsigned int jsvGCCursor; ///< Next var to look at when walking over all vars
+static bool jsvGCRescanning; ///< In JSVGC_MARK, are we walking over all vars because the stack overflowed?
+static bool jsvGCCheckingLocks; ///< In JSVGC_MARK, are we walking over all vars looking for locked ones that are still white?
+static bool jsvGCStackOverflowed; ///< Some vars have been marked but not pushed onto jsvGCStack
+static unsigned char jsvGCStackSize;
+static JsVarRef jsvGCStack[JSV_GC_STACK_SIZE];
+static unsigned int jsvGCFreed; ///< Blocks freed so far in this collection
+static unsigned int jsvGCLastFreed; ///< Blocks freed by the last completed collection
+static unsigned int jsvGCCount; ///< Number of collections (full or incremental) that have completed
+static JsSysTime jsvGCMaxStepTime; ///< Longest step so far in this collection
+static JsSysTime jsvGCLastMaxStepTime; ///< Longest step in the last completed collection
+
+static unsigned int jsvShapeVersion; ///< See jsvGetShapeVersion
+
+/// If a var is white, mark it and push it onto the stack so what it links to gets marked later
+static void jsvGarbageCollectShade(JsVarRef ref) {
+  if (!ref) return;
+  JsVar *var = jsvGetAddressOf(ref);
+  if (!(var->flags & JSV_GARBAGE_COLLECT)) return;
+  var->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
+  if (jsvGCStackSize < JSV_GC_STACK_SIZE)
+    jsvGCStack[jsvGCStackSize++] = ref;
+  else
+    jsvGCStackOverflowed = true; // we'll find what it links to when we rescan
+}
+
+/** Write barrier for the incremental garbage collector. Every time a reference
+ * to a var is stored (jsvAddName, jsvSetValueOfName, and so on) it goes through
+ * jsvRef, which calls this. While marking, that means a var that has already
+ * been scanned can never end up pointing at a white var. */
+static ALWAYS_INLINE void jsvGarbageCollectWriteBarrier(JsVar *var) {
+  if ((jsvGCPhase==JSVGC_ROOTS || jsvGCPhase==JSVGC_MARK) &&
+      (var->flags & JSV_GARBAGE_COLLECT))
+    jsvGarbageCollectShade(jsvGetRef(var));
+}
+
+/** Lock barrier for the incremental garbage collector. Locking a white var
+ * while marking shades it, so every locked var is either black or grey - the
+ * program could otherwise find a white var through one we haven't scanned,
+ * lock it, and unlink it before we got there. Only needed when the first lock
+ * is taken, as a var that was already locked was shaded as a root. */
+static ALWAYS_INLINE void jsvGarbageCollectLockBarrier(JsVar *var) {
+  if ((var->flags & JSV_GARBAGE_COLLECT) &&
+      (jsvGCPhase==JSVGC_ROOTS || jsvGCPhase==JSVGC_MARK))
+    jsvGarbageCollectShade(jsvGetRef(var));
+}
+
+/** Write barrier for when a list of children is relinked without a new
+ * reference being made (eg. removing a child makes its parent or previous
+ * sibling point straight at its next sibling). That var may only have been
+ * reachable through the one we unlinked, which might not have been scanned. */
+static ALWAYS_INLINE void jsvGarbageCollectWriteBarrierRef(JsVarRef ref) {
+  if (ref && (jsvGCPhase==JSVGC_ROOTS || jsvGCPhase==JSVGC_MARK))
+    jsvGarbageCollectShade(ref);
+}
+
+/** A flat string has just been put at 'ref'. If a collection is part way
+ * through walking over it, skip to the end so we never treat its data as vars */
+static void jsvGarbageCollectSkipFlatString(JsVarRef ref, size_t blocks) {
+  if (jsvGCPhase!=JSVGC_IDLE && jsvGCCursor>ref && jsvGCCursor<=ref+blocks)
+    jsvGCCursor = (unsigned int)(ref+blocks+1);
+}
+
 #ifdef JSVARREF_PACKED_BITS
 #define JSVARREF_PACKED_BIT_MASK ((1U<<JSVARREF_PACKED_BITS)-1)
 JsVarRef jsvGetFirstChild(const JsVar *v) { return (JsVarRef)(v->varData.ref.firstChild | (((v->varData.ref.pack)&JSVARREF_PACKED_BIT_MASK))<<8); }
@@ -97,11 +330,13 @@ void jsvSetMaxVarsUsed(unsigned int size) {
   jsVarsSize = size;
 }
 
-// maps the empty variables in...
-void jsvCreateEmptyVarList() {
-  jsVarFirstEmpty = 0;
+/// Link all the unused vars together and return the first
+static JsVarRef jsvLinkEmptyVars() {
+  JsVarRef firstEmpty = 0;
   JsVar *lastEmpty = 0;
   JsVarRef i;
+  unsigned int run = 0;
+  jsvLargestFreeRun = 0;
   for (i=1;i<=jsVarsSize;i++) {
     JsVar *var = jsvGetAddressOf(i);
     if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED) {
@@ -109,18 +344,323 @@ void jsvCreateEmptyVarList() {
       if (lastEmpty)
         jsvSetNextSibling(lastEmpty, i);
       else
-        jsVarFirstEmpty = i;
+        firstEmpty = i;
       lastEmpty = var;
-    } else if (jsvIsFlatString(var)) {
-      // skip over used blocks for flat strings
+      if (++run > jsvLargestFreeRun) jsvLargestFreeRun = run;
+    } else {
+      run = 0;
+      if (jsvIsFlatString(var)) // skip over used blocks for flat strings
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+  }
+  jsvLargestFreeRunValid = true;
+  return firstEmpty;
+}
+
+// maps the empty variables in (and counts everything for the heap statistics)
+void jsvCreateEmptyVarList() {
+  unsigned int used = 0, flatStrings = 0;
+  JsVarRef i;
+  jsvSetFirstEmpty(jsvLinkEmptyVars());
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      used++;
+      if (jsvIsFlatString(var)) {
+        unsigned int blocks = (unsigned int)jsvGetFlatStringBlocks(var);
+        i = (JsVarRef)(i+blocks);
+        used += blocks;
+        flatStrings += blocks+1;
+      }
+    }
+  }
+  jshInterruptOff(); // so an IRQ never sees one updated and not the other
+  jsvUsedBlocks = used;
+  jsvFlatStringBlocks = flatStrings;
+  jshInterruptOn();
+}
+
+
+/* Names too long to fit in one var keep the rest of their characters in
+ * StringExts. Lots of objects tend to have the same keys, so rather than each
+ * name having its own copy we intern them: names with the same characters
+ * share one chain of StringExts. The first StringExt in an interned chain has
+ * JSV_NATIVE set, so it's never freed along with a name (other names may
+ * still use it) - the garbage collector frees it once nothing links to it,
+ * and takes it out of this table as it does. Only names with a full first
+ * var are interned, so two interned names are the same if their first vars
+ * match and they link to the same StringExts. The table is a hash (of the
+ * characters in the StringExts) with linear probing.
+ *
+ * Substrings that run to the end of a long string share its StringExts in
+ * the same way (see jsvNewFromStringVar), and every StringExt from there to
+ * the end has JSV_NATIVE set. A string that shares StringExts gets its own
+ * copy of them before anything is written to it (jsvUnshareStringExts). */
+#ifndef JSV_INTERN_TABLE_SIZE
+#define JSV_INTERN_TABLE_SIZE 64 ///< How many chains of StringExts we can intern. Must be a power of 2
+#endif
+static JsVarRef jsvInternTable[JSV_INTERN_TABLE_SIZE];
+static unsigned int jsvInternCount; ///< Used buckets in jsvInternTable
+static unsigned int jsvInternHits; ///< Names that have shared StringExts that were already interned
+
+/// Might other strings link to this StringExt too? (the first of an interned chain, or part of the end of a string that substrings share)
+static ALWAYS_INLINE bool jsvIsSharedStringExt(const JsVar *v) {
+  return jsvIsStringExt(v) && (v->flags & JSV_NATIVE);
+}
+
+/// If this is a name whose StringExts have been interned, return them (or 0)
+static JsVarRef jsvGetInternedStringExt(const JsVar *v) {
+  if (!jsvIsName(v) || !jsvIsString(v)) return 0;
+  JsVarRef ref = jsvGetLastChild(v);
+  return (ref && jsvIsSharedStringExt(jsvGetAddressOf(ref))) ? ref : 0;
+}
+
+/// Hash the characters in a chain of StringExts (or in str if ref==0)
+static unsigned int jsvInternHash(JsVarRef ref, const char *str) {
+  unsigned int hash = 5381;
+  if (!ref) {
+    while (*str)
+      hash = (hash<<5) + hash + (unsigned char)*(str++);
+  }
+  while (ref) {
+    JsVar *v = jsvGetAddressOf(ref);
+    size_t i, l = jsvGetCharactersInVar(v);
+    for (i=0;i<l;i++)
+      hash = (hash<<5) + hash + (unsigned char)v->varData.str[i];
+    ref = jsvGetLastChild(v);
+  }
+  return hash;
+}
+
+/// Get the next character from a chain of StringExts, or -1 at the end. StringExts needn't be full
+static int jsvInternGetChar(JsVar **v, size_t *i) {
+  while (*v && *i>=jsvGetCharactersInVar(*v)) {
+    JsVarRef next = jsvGetLastChild(*v);
+    *v = next ? jsvGetAddressOf(next) : 0;
+    *i = 0;
+  }
+  return *v ? (unsigned char)(*v)->varData.str[(*i)++] : -1;
+}
+
+/// Do two chains of StringExts (or the chain 'a' and str, if b==0) contain the same characters?
+static bool jsvInternIsEqual(JsVarRef a, JsVarRef b, const char *str) {
+  JsVar *va = jsvGetAddressOf(a);
+  JsVar *vb = b ? jsvGetAddressOf(b) : 0;
+  size_t ia = 0, ib = 0;
+  while (true) {
+    int ca = jsvInternGetChar(&va, &ia);
+    int cb = b ? jsvInternGetChar(&vb, &ib) : (*str ? (unsigned char)*(str++) : -1);
+    if (ca != cb) return false;
+    if (ca < 0) return true;
+  }
+}
+
+/** Find the bucket holding the interned StringExts with the same characters as
+ * 'ref' (or str if ref==0). If there aren't any, it's the empty bucket they'd go in */
+static unsigned int jsvInternFind(JsVarRef ref, const char *str) {
+  unsigned int mask = JSV_INTERN_TABLE_SIZE-1;
+  unsigned int i = jsvInternHash(ref, str) & mask;
+  // we always keep some buckets empty, so this stops
+  while (jsvInternTable[i] && !jsvInternIsEqual(jsvInternTable[i], ref, str))
+    i = (i+1) & mask;
+  return i;
+}
+
+/** Get the interned StringExts that a name of the characters in str would
+ * link to, or 0 if there aren't any (in which case no interned name is str) */
+static JsVarRef jsvInternFindString(const char *str) {
+  if (strlen(str) <= JSVAR_DATA_STRING_LEN) return 0;
+  return jsvInternTable[jsvInternFind(0, &str[JSVAR_DATA_STRING_LEN])];
+}
+
+/** Make the table of interned StringExts from whatever is in memory (eg.
+ * after loading from flash), as we can't have interned StringExts that
+ * aren't in the table. We find them from the names that use them, as
+ * StringExts that substrings share are marked the same way */
+static void jsvInternTableBuild() {
+  JsVarRef i;
+  memset(jsvInternTable, 0, sizeof(jsvInternTable));
+  jsvInternCount = 0;
+  jsvInternHits = 0;
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    JsVarRef ref = jsvGetInternedStringExt(var);
+    if (ref) {
+      unsigned int bucket = jsvInternFind(ref, 0);
+      if (!jsvInternTable[bucket] && jsvInternCount+1 < JSV_INTERN_TABLE_SIZE) {
+        jsvInternTable[bucket] = ref;
+        jsvInternCount++;
+      }
+    } else if (jsvIsFlatString(var))
       i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+  }
+}
+
+/** The garbage collector is about to free everything that's still marked as
+ * garbage, so take the interned StringExts that nothing links to out of the table */
+static void jsvInternForgetGarbage() {
+  JsVarRef live[JSV_INTERN_TABLE_SIZE];
+  unsigned int i, count = 0;
+  for (i=0;i<JSV_INTERN_TABLE_SIZE;i++)
+    if (jsvInternTable[i] && !(jsvGetAddressOf(jsvInternTable[i])->flags & JSV_GARBAGE_COLLECT))
+      live[count++] = jsvInternTable[i];
+  if (count == jsvInternCount) return;
+  memset(jsvInternTable, 0, sizeof(jsvInternTable));
+  jsvInternCount = count;
+  while (count--)
+    jsvInternTable[jsvInternFind(live[count], 0)] = live[count];
+}
+
+/// Get the number of chains of StringExts that names share
+unsigned int jsvGetInternedNameCount() {
+  return jsvInternCount;
+}
+
+/// Get the number of names that have shared StringExts that were already interned
+unsigned int jsvGetInternedNameHits() {
+  return jsvInternHits;
+}
+
+/* Appending to a string (or getting its length) means walking along all of
+ * its StringExts to the end. So that building a long string a bit at a time
+ * isn't O(n^2), we remember where the end of the last few long strings was,
+ * and how many characters came before it. Taking substrings of a long string
+ * means walking to the start of each one, so we also remember the last var
+ * we looked something up in, so that working through a string with
+ * substr/slice/charAt doesn't keep going back to the beginning. Entries are
+ * forgotten when their string is freed (or might have been, by the garbage
+ * collector). */
+#define JSV_STRING_END_CACHE_SIZE 4
+#define JSV_STRING_END_CACHE_MIN_BLOCKS 4 ///< Only remember strings we had to walk at least this many blocks of
+typedef struct {
+  JsVarRef str; ///< The string, or 0 if unused
+  JsVarRef end; ///< The last var of the string (when we last looked - something may have been added since), or 0
+  size_t endIndex; ///< The number of characters before 'end'
+  JsVarRef mid; ///< The var of the string we last looked up a character in, or 0
+  size_t midIndex; ///< The number of characters before 'mid'
+} JsvStringEndCacheEntry;
+static JsvStringEndCacheEntry jsvStringEndCache[JSV_STRING_END_CACHE_SIZE];
+static unsigned char jsvStringEndCacheNext; ///< The entry we'll replace next
+
+/// Forget everything in the string end cache
+static void jsvClearStringEndCache() {
+  memset(jsvStringEndCache, 0, sizeof(jsvStringEndCache));
+}
+
+/// Forget where the end of this string was (if we knew), eg. because it's being freed
+static void jsvStringEndForget(JsVarRef str) {
+  unsigned int i;
+  for (i=0;i<JSV_STRING_END_CACHE_SIZE;i++)
+    if (jsvStringEndCache[i].str == str)
+      jsvStringEndCache[i].str = 0;
+}
+
+/// Find this string's entry in the string end cache, or -1
+static int jsvStringEndFind(JsVarRef str) {
+  int i;
+  for (i=0;i<JSV_STRING_END_CACHE_SIZE;i++)
+    if (jsvStringEndCache[i].str == str)
+      return i;
+  return -1;
+}
+
+/// Start remembering things about this string, replacing the oldest entry in the string end cache
+static int jsvStringEndAdd(JsVarRef str) {
+  int i = jsvStringEndCacheNext;
+  jsvStringEndCacheNext = (unsigned char)((i+1) % JSV_STRING_END_CACHE_SIZE);
+  memset(&jsvStringEndCache[i], 0, sizeof(JsvStringEndCacheEntry));
+  jsvStringEndCache[i].str = str;
+  return i;
+}
+
+/** Lock and return the last var of a string (the string itself if it has no
+ * StringExts), and set *endIndex to the number of characters before it */
+JsVar *jsvLockStringEnd(JsVar *str, size_t *endIndex) {
+  JsVarRef ref = jsvGetRef(str);
+  JsVar *block = 0;
+  size_t index = 0;
+  unsigned int blocks = 0;
+  int i = jsvGetLastChild(str) ? jsvStringEndFind(ref) : -1;
+  if (i>=0) {
+    if (jsvStringEndCache[i].end) {
+      block = jsvLock(jsvStringEndCache[i].end);
+      index = jsvStringEndCache[i].endIndex;
+    } else if (jsvStringEndCache[i].mid) {
+      block = jsvLock(jsvStringEndCache[i].mid);
+      index = jsvStringEndCache[i].midIndex;
+    }
+  }
+  if (!block) block = jsvLockAgain(str);
+  // there may be more on the end since we looked
+  while (jsvGetLastChild(block)) {
+    JsVarRef next = jsvGetLastChild(block);
+    index += jsvGetCharactersInVar(block);
+    jsvUnLock(block);
+    block = jsvLock(next);
+    blocks++;
+  }
+  if (i<0 && blocks >= JSV_STRING_END_CACHE_MIN_BLOCKS)
+    jsvStringEndAdd(ref);
+  jsvStringEndMoved(str, block, index);
+  *endIndex = index;
+  return block;
+}
+
+/** Lock and return the var of a string that contains character idx (the last
+ * var if the string is shorter than that), and set *blockIndex to the number
+ * of characters before it. The string must not be a flat string or a StringExt */
+JsVar *jsvLockStringBlock(JsVar *str, size_t idx, size_t *blockIndex) {
+  assert(!jsvIsFlatString(str) && !jsvIsStringExt(str));
+  JsVarRef ref = jsvGetRef(str);
+  JsVar *block = 0;
+  size_t index = 0;
+  unsigned int blocks = 0;
+  int i = jsvGetLastChild(str) ? jsvStringEndFind(ref) : -1;
+  if (i>=0) {
+    // start from whichever var we know of that's nearest before idx
+    if (jsvStringEndCache[i].end && jsvStringEndCache[i].endIndex<=idx) {
+      block = jsvLock(jsvStringEndCache[i].end);
+      index = jsvStringEndCache[i].endIndex;
+    } else if (jsvStringEndCache[i].mid && jsvStringEndCache[i].midIndex<=idx) {
+      block = jsvLock(jsvStringEndCache[i].mid);
+      index = jsvStringEndCache[i].midIndex;
     }
   }
+  if (!block) block = jsvLockAgain(str);
+  while (jsvGetLastChild(block) && index+jsvGetCharactersInVar(block) <= idx) {
+    JsVarRef next = jsvGetLastChild(block);
+    index += jsvGetCharactersInVar(block);
+    jsvUnLock(block);
+    block = jsvLock(next);
+    blocks++;
+  }
+  if (i<0 && blocks >= JSV_STRING_END_CACHE_MIN_BLOCKS)
+    i = jsvStringEndAdd(ref);
+  if (i>=0 && blocks) {
+    jsvStringEndCache[i].mid = jsvGetRef(block);
+    jsvStringEndCache[i].midIndex = index;
+  }
+  *blockIndex = index;
+  return block;
 }
 
+/// We've added to the end of a string, so if we're remembering where its end was, update it
+void jsvStringEndMoved(JsVar *str, JsVar *end, size_t endIndex) {
+  JsVarRef ref = jsvGetRef(str);
+  unsigned int i;
+  for (i=0;i<JSV_STRING_END_CACHE_SIZE;i++) {
+    if (jsvStringEndCache[i].str == ref) {
+      jsvStringEndCache[i].end = jsvGetRef(end);
+      jsvStringEndCache[i].endIndex = endIndex;
+    }
+  }
+}
 
 void jsvSoftInit() {
+  jsvGCPhase = JSVGC_IDLE;
   jsvCreateEmptyVarList();
+  jsvInternTableBuild();
+  jsvClearStringEndCache();
 }
 
 void jsvSoftKill() {
@@ -128,7 +668,7 @@ void jsvSoftKill() {
 
 /** This links all JsVars together, so we can have our nice
  * linked list of free JsVars. It returns the ref of the first
- * item - that we should set jsVarFirstEmpty to (if it is 0) */
+ * item - that we should make the head of the free list (if it is empty) */
 static JsVarRef jsvInitJsVars(JsVarRef start, unsigned int count) {
   JsVarRef i;
   for (i=start;i<start+count;i++) {
@@ -148,7 +688,7 @@ void jsvInit() {
   jsVarBlocks[0] = malloc(sizeof(JsVar) * JSVAR_BLOCK_SIZE);
 #endif
 
-  jsVarFirstEmpty = jsvInitJsVars(1/*first*/, jsVarsSize);
+  jsvSetFirstEmpty(jsvInitJsVars(1/*first*/, jsVarsSize));
   jsvSoftInit();
 }
 
@@ -176,20 +716,51 @@ JsVar *jsvFindOrCreateRoot() {
 
 /// Get number of memory records (JsVars) used
 unsigned int jsvGetMemoryUsage() {
-  unsigned int usage = 0;
+  return jsvUsedBlocks;
+}
+
+/// Get number of memory records used by flat strings (including their headers)
+unsigned int jsvGetMemoryFlatStringUsage() {
+  return jsvFlatStringBlocks;
+}
+
+/// Get number of JsVars that are currently locked (this walks over every var)
+unsigned int jsvGetMemoryLocked() {
+  unsigned int locked = 0;
+  JsVarRef i;
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *v = jsvGetAddressOf(i);
+    if ((v->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      if (jsvGetLocks(v)) locked++;
+      if (jsvIsFlatString(v))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(v));
+    }
+  }
+  return locked;
+}
+
+/** Get the biggest number of free memory records that are next to each other.
+ * This is remembered from the last time we walked over all vars (eg. a garbage
+ * collection), and only worked out again if something has been allocated or
+ * freed since. */
+unsigned int jsvGetMemoryLargestFreeRun() {
+  if (jsvLargestFreeRunValid) return jsvLargestFreeRun;
+  unsigned int run = 0, largest = 0;
   unsigned int i;
   for (i=1;i<=jsVarsSize;i++) {
     JsVar *v = jsvGetAddressOf((JsVarRef)i);
-    if ((v->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
-      usage++;
-      if (jsvIsFlatString(v)) {
-        unsigned int b = (unsigned int)jsvGetFlatStringBlocks(v);
-        i+=b;
-        usage+=b;
-      }
+    if ((v->flags&JSV_VARTYPEMASK) == JSV_UNUSED) {
+      run++;
+      if (run>largest) largest = run;
+    } else {
+      run = 0;
+      if (jsvIsFlatString(v))
+        i += (unsigned int)jsvGetFlatStringBlocks(v);
     }
   }
-  return usage;
+  jsvLargestFreeRun = largest;
+  jsvLargestFreeRunValid = true;
+  return largest;
 }
 
 /// Get total amount of memory records
@@ -212,10 +783,11 @@ void jsvSetMemoryTotal(unsigned int jsNewVarCount) {
   unsigned int i;
   for (i=oldBlockCount;i<newBlockCount;i++)
     jsVarBlocks[i] = malloc(sizeof(JsVar) * JSVAR_BLOCK_SIZE);
-  /** and now reset all the newly allocated vars. We know jsVarFirstEmpty
-   * is 0 (because jsiFreeMoreMemory returned 0) so we can just assign it.  */
-  assert(!jsVarFirstEmpty);
-  jsVarFirstEmpty = jsvInitJsVars(oldSize+1, jsVarsSize-oldSize);
+  /** and now reset all the newly allocated vars. We know the free list
+   * is empty (because jsiFreeMoreMemory returned 0) so we can just assign it.  */
+  assert(!jsvGetFirstEmpty());
+  jsvSetFirstEmpty(jsvInitJsVars(oldSize+1, jsVarsSize-oldSize));
+  jsvLargestFreeRunValid = false;
   // jsiConsolePrintf("Resized memory from %d blocks to %d\n", oldBlockCount, newBlockCount);
 #else
   NOT_USED(jsNewVarCount);
@@ -225,7 +797,7 @@ void jsvSetMemoryTotal(unsigned int jsNewVarCount) {
 
 /// Get whether memory is full or not
 bool jsvIsMemoryFull() {
-  return !jsVarFirstEmpty;
+  return !jsvGetFirstEmpty();
 }
 
 // Show what is still allocated, for debugging memory problems
@@ -257,7 +829,8 @@ bool jsvHasSingleChild(const JsVar *v) {
          (jsvIsName(v) && !jsvIsNameWithValue(v));
 }
 
-void jsvResetVariable(JsVar *v, JsVarFlags flags) {
+/// Clear out a var we've taken from the free list and give it the given flags (but no locks)
+static ALWAYS_INLINE void jsvResetVariableUnlocked(JsVar *v, JsVarFlags flags) {
   assert((v->flags&JSV_VARTYPEMASK) == JSV_UNUSED);
   // make sure we clear all data...
   ((unsigned int*)&v->varData.integer)[0] = 0;
@@ -270,21 +843,214 @@ void jsvResetVariable(JsVar *v, JsVarFlags flags) {
   jsvSetLastChild(v, 0);
   // set flags
   assert(!(flags & JSV_LOCK_MASK));
-  v->flags = flags | JSV_LOCK_ONE;
+  v->flags = flags;
+  /* If the GC is still making everything white, new vars must be white too
+   * (after that they're black, so we never free something we haven't scanned) */
+  if (jsvGCPhase==JSVGC_CLEAR)
+    v->flags |= JSV_GARBAGE_COLLECT;
 }
 
-JsVar *jsvNewWithFlags(JsVarFlags flags) {
-  if (jsVarFirstEmpty!=0) {
-    assert(jsvGetAddressOf(jsVarFirstEmpty)->flags == JSV_UNUSED);
-    jshInterruptOff(); // to allow this to be used from an IRQ
-    JsVar *v = jsvLock(jsVarFirstEmpty);
-    jsVarFirstEmpty = jsvGetNextSibling(v); // move our reference to the next in the free list
+void jsvResetVariable(JsVar *v, JsVarFlags flags) {
+  jsvResetVariableUnlocked(v, flags);
+  v->flags |= JSV_LOCK_ONE;
+}
+
+/// Take a var off the free list, or return 0 if it is empty. Safe to use from an IRQ
+static ALWAYS_INLINE JsVar *jsvFreeListTake() {
+  JsVar *v;
+#ifdef JSV_FREE_LIST_ATOMIC
+  JsvFreeList head;
+  do {
+    head = jsvFreeListLoad();
+    if (!jsvFreeListGetRef(head)) {
+      jsvFreeListCancel();
+      return 0;
+    }
+    v = jsvGetAddressOf(jsvFreeListGetRef(head));
+  } while (!jsvFreeListStore(head, jsvGetNextSibling(v)));
+  __atomic_fetch_add(&jsvUsedBlocks, 1, __ATOMIC_RELAXED);
+#else
+  jshInterruptOff(); // to allow this to be used from an IRQ
+  if (!jsVarFirstEmpty) {
+    jshInterruptOn();
+    return 0;
+  }
+  v = jsvGetAddressOf(jsVarFirstEmpty);
+  jsVarFirstEmpty = jsvGetNextSibling(v); // move our reference to the next in the free list
+  jsvUsedBlocks++;
+  jshInterruptOn();
+#endif
+  jsvLargestFreeRunValid = false;
+  assert(v->flags == JSV_UNUSED);
+  return v;
+}
+
+/** Take up to 'count' vars off the free list in one go (so we only turn IRQs
+ * off or swap the head of the list once). They're still linked together
+ * through nextSibling, starting from 'first'. Returns how many we got - this
+ * is limited to JSV_FREE_LIST_TAKE_MAX so we never keep IRQs off for long,
+ * and is 0 if the free list is empty. Safe to use from an IRQ */
+static size_t jsvFreeListTakeMany(size_t count, JsVarRef *first) {
+  JsVar *last;
+  size_t n;
+  if (count > JSV_FREE_LIST_TAKE_MAX) count = JSV_FREE_LIST_TAKE_MAX;
+#ifdef JSV_FREE_LIST_ATOMIC
+  JsvFreeList head;
+  do {
+    head = jsvFreeListLoad();
+    *first = jsvFreeListGetRef(head);
+    if (!*first) {
+      jsvFreeListCancel();
+      return 0;
+    }
+    last = jsvGetAddressOf(*first);
+    n = 1;
+    /* If an IRQ changes the list while we walk it we may read rubbish, but the
+     * store below will then fail - we just mustn't follow a ref that's out of range */
+    while (n<count && jsvGetNextSibling(last) && jsvGetNextSibling(last)<=jsVarsSize) {
+      last = jsvGetAddressOf(jsvGetNextSibling(last));
+      n++;
+    }
+  } while (!jsvFreeListStore(head, jsvGetNextSibling(last)));
+  __atomic_fetch_add(&jsvUsedBlocks, n, __ATOMIC_RELAXED);
+#else
+  jshInterruptOff(); // to allow this to be used from an IRQ
+  *first = jsVarFirstEmpty;
+  if (!*first) {
+    jshInterruptOn();
+    return 0;
+  }
+  last = jsvGetAddressOf(*first);
+  n = 1;
+  while (n<count && jsvGetNextSibling(last)) {
+    last = jsvGetAddressOf(jsvGetNextSibling(last));
+    n++;
+  }
+  jsVarFirstEmpty = jsvGetNextSibling(last);
+  jsvUsedBlocks += (unsigned int)n;
+  jshInterruptOn();
+#endif
+  jsvLargestFreeRunValid = false;
+  return n;
+}
+
+/// Put a var back on the free list. Safe to use from an IRQ
+static ALWAYS_INLINE void jsvFreeListGive(JsVar *var) {
+  JsVarRef ref = jsvGetRef(var);
+  if (jsvFreeListDetached) {
+    // keep it out of the way until jsvFreeListAttach (which updates jsvUsedBlocks)
+    var->flags = JSV_FREE_PENDING;
+#ifdef JSV_FREE_LIST_ATOMIC
+    JsVarRef pending = __atomic_load_n(&jsvFreeListPending, __ATOMIC_RELAXED);
+    do {
+      jsvSetNextSibling(var, pending);
+    } while (!__atomic_compare_exchange_n(&jsvFreeListPending, &pending, ref, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#else
+    jshInterruptOff();
+    jsvSetNextSibling(var, jsvFreeListPending);
+    jsvFreeListPending = ref;
     jshInterruptOn();
+#endif
+    return;
+  }
+#ifdef JSV_FREE_LIST_ATOMIC
+  JsvFreeList head;
+  do {
+    head = jsvFreeListLoad();
+    jsvSetNextSibling(var, jsvFreeListGetRef(head));
+  } while (!jsvFreeListStore(head, ref));
+  __atomic_fetch_sub(&jsvUsedBlocks, 1, __ATOMIC_RELAXED);
+#else
+  jshInterruptOff(); // to allow this to be used from an IRQ
+  jsvSetNextSibling(var, jsVarFirstEmpty);
+  jsVarFirstEmpty = ref;
+  jsvUsedBlocks--;
+  jshInterruptOn();
+#endif
+  jsvLargestFreeRunValid = false;
+}
+
+/** Make the free list start at 'first' again after jsvFreeListDetach, and
+ * put back anything that was freed in the meantime */
+static void jsvFreeListAttach(JsVarRef first) {
+  JsVarRef pending;
+#ifdef JSV_FREE_LIST_ATOMIC
+  JsvFreeList head;
+  do {
+    head = jsvFreeListLoad();
+  } while (!jsvFreeListStore(head, first));
+#else
+  jshInterruptOff();
+  jsVarFirstEmpty = first;
+  jshInterruptOn();
+#endif
+  jsvFreeListDetached = false;
+  // Nothing goes on the pending list now, so we can take all of it
+#ifdef JSV_FREE_LIST_ATOMIC
+  pending = __atomic_exchange_n(&jsvFreeListPending, 0, __ATOMIC_ACQUIRE);
+#else
+  jshInterruptOff();
+  pending = jsvFreeListPending;
+  jsvFreeListPending = 0;
+  jshInterruptOn();
+#endif
+  while (pending) {
+    JsVar *var = jsvGetAddressOf(pending);
+    pending = jsvGetNextSibling(var);
+    var->flags = JSV_UNUSED;
+    jsvFreeListGive(var);
+  }
+}
+
+/** Add new String extension blocks on to the end of 'block' (the last block of
+ * a string), enough for 'chars' more characters if we can get them all in
+ * one go. The first new block is returned locked and the rest are linked on
+ * after it, so use jsvLockNextStringExt to carry on writing into them.
+ * Returns 0 if we're out of memory. */
+static JsVar *jsvNewStringExts(JsVar *block, size_t chars) {
+  assert(!jsvGetLastChild(block));
+  JsVarRef ref;
+  size_t count = jsvFreeListTakeMany((chars+JSVAR_DATA_STRING_MAX_LEN-1) / JSVAR_DATA_STRING_MAX_LEN, &ref);
+  if (!count) {
+    // free list is empty - let jsvNewWithFlags garbage collect for us
+    JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
+    if (next) jsvSetLastChild(block, jsvGetRef(next));
+    return next;
+  }
+  // we don't ref, because StringExts are never reffed as they only have one owner (and ALWAYS have an owner)
+  jsvSetLastChild(block, ref);
+  JsVar *first = jsvGetAddressOf(ref);
+  JsVar *v = first;
+  while (true) {
+    JsVarRef nextRef = jsvGetNextSibling(v);
+    jsvResetVariableUnlocked(v, JSV_STRING_EXT_0);
+    if (!--count) break;
+    jsvSetLastChild(v, nextRef);
+    v = jsvGetAddressOf(nextRef);
+  }
+  jsvLockAgain(first);
+  return first;
+}
+
+/** Lock the block after 'block' to carry on writing a string into - using
+ * one that jsvNewStringExts already linked on, or allocating more */
+static ALWAYS_INLINE JsVar *jsvLockNextStringExt(JsVar *block, size_t chars) {
+  JsVarRef ref = jsvGetLastChild(block);
+  if (ref) return jsvLock(ref);
+  return jsvNewStringExts(block, chars);
+}
+
+JsVar *jsvNewWithFlags(JsVarFlags flags) {
+  JsVar *v = jsvFreeListTake();
+  if (v) {
     jsvResetVariable(v, flags); // setup variable, and add one lock
     // return pointer
     return v;
   }
   jsErrorFlags |= JSERR_LOW_MEMORY;
+  /* If the free list is detached we're an IRQ that interrupted something
+   * rearranging memory, so we can't garbage collect */
+  if (jsvFreeListDetached) return 0;
   /* we don't have memory - second last hope - run garbage collector */
   if (jsvGarbageCollect())
     return jsvNewWithFlags(flags); // if it freed something, continue
@@ -306,17 +1072,24 @@ JsVar *jsvNewWithFlags(JsVarFlags flags) {
 #endif
 }
 
-ALWAYS_INLINE void jsvFreePtrInternal(JsVar *var) {
+static ALWAYS_INLINE void jsvFreePtrInternal(JsVar *var) {
   assert(jsvGetLocks(var)==0);
   var->flags = JSV_UNUSED;
   // add this to our free list
-  jshInterruptOff(); // to allow this to be used from an IRQ
-  jsvSetNextSibling(var, jsVarFirstEmpty);
-  jsVarFirstEmpty = jsvGetRef(var);
-  jshInterruptOn();
+  jsvFreeListGive(var);
 }
 
-ALWAYS_INLINE void jsvFreePtr(JsVar *var) {
+static ALWAYS_INLINE void jsvFreePtr(JsVar *var) {
+    if (jsvHasChildren(var))
+      jspFieldCacheForget(jsvGetRef(var));
+
+    // An array's index is the only thing that uses its nextSibling
+    if (jsvIsArray(var) && jsvGetNextSibling(var)) {
+      JsVarRef indexRef = jsvGetNextSibling(var);
+      jsvSetNextSibling(var, 0);
+      jsvUnRefRef(indexRef);
+    }
+
     /* To be here, we're not supposed to be part of anything else. If
      * we were, we'd have been freed by jsvGarbageCollect */
     assert((!jsvGetNextSibling(var) && !jsvGetPrevSibling(var)) || // check that next/prevSibling are not set
@@ -341,7 +1114,9 @@ ALWAYS_INLINE void jsvFreePtr(JsVar *var) {
       // Free the string without recursing
       JsVarRef stringDataRef = jsvGetLastChild(var);
       jsvSetLastChild(var, 0);
-      while (stringDataRef) {
+      if (stringDataRef) jsvStringEndForget(jsvGetRef(var));
+      // other strings may share our StringExts from some point on, so the garbage collector frees those
+      while (stringDataRef && !jsvIsSharedStringExt(jsvGetAddressOf(stringDataRef))) {
         JsVar *child = jsvGetAddressOf(stringDataRef);
         assert(jsvIsStringExt(child));
         stringDataRef = jsvGetLastChild(child);
@@ -352,6 +1127,7 @@ ALWAYS_INLINE void jsvFreePtr(JsVar *var) {
         // in which case we need to free all the blocks.
         size_t count = jsvGetFlatStringBlocks(var);
         JsVarRef i = (JsVarRef)(jsvGetRef(var)+count);
+        jsvStatSub(&jsvFlatStringBlocks, (unsigned int)count+1);
         // do it in reverse, so the free list ends up in kind of the right order
         while (count--) {
           JsVar *p = jsvGetAddressOf(i--);
@@ -419,6 +1195,8 @@ JsVar *jsvLock(JsVarRef ref) {
   JsVar *var = jsvGetAddressOf(ref);
   //var->locks++;
   assert(jsvGetLocks(var) < JSV_LOCK_MAX);
+  if (!(var->flags & JSV_LOCK_MASK))
+    jsvGarbageCollectLockBarrier(var);
   var->flags += JSV_LOCK_ONE;
 #ifdef DEBUG
   if (jsvGetLocks(var)==0) {
@@ -433,6 +1211,8 @@ JsVar *jsvLock(JsVarRef ref) {
 JsVar *jsvLockAgain(JsVar *var) {
   assert(var);
   assert(jsvGetLocks(var) < JSV_LOCK_MAX);
+  if (!(var->flags & JSV_LOCK_MASK))
+    jsvGarbageCollectLockBarrier(var);
   var->flags += JSV_LOCK_ONE;
   return var;
 }
@@ -470,6 +1250,7 @@ void jsvUnLock(JsVar *var) {
 JsVar *jsvRef(JsVar *var) {
   assert(var && jsvHasRef(var));
   jsvSetRefs(var, (JsVarRefCounter)(jsvGetRefs(var)+1));
+  jsvGarbageCollectWriteBarrier(var);
   return var;
 }
 
@@ -503,15 +1284,20 @@ JsVarRef jsvUnRefRef(JsVarRef ref) {
   return 0;
 }
 
-JsVar *jsvNewFlatStringOfLength(unsigned int byteLength) {
+static JsVar *jsvNewFlatStringOfLengthInternal(unsigned int byteLength, bool canCompact) {
   // Work out how many blocks we need. One for the header, plus some for the characters
   size_t blocks = 1 + ((byteLength+sizeof(JsVar)-1) / sizeof(JsVar));
   // Now try and find them
   unsigned int blockCount = 0;
+  unsigned int freeCount = 0;
   JsVarRef i;
+  /* Detach the free list while we look, so an IRQ can't take the vars we're
+   * claiming (or use the list while we rebuild it) */
+  JsVarRef firstEmpty = jsvFreeListDetach();
   for (i=1;i<=jsVarsSize;i++)  {
     JsVar *var = jsvGetAddressOf(i);
     if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED) {
+      freeCount++;
       blockCount++;
       if (blockCount>=blocks) { // Wohoo! We found enough blocks
         var = jsvGetAddressOf((JsVarRef)(unsigned int)((unsigned)i+1-blocks)); // the first block
@@ -520,8 +1306,11 @@ JsVar *jsvNewFlatStringOfLength(unsigned int byteLength) {
         var->varData.integer = (JsVarInt)byteLength;
         // clear data
         memset(sizeof(JsVar)+(char*)var, 0, sizeof(JsVar)*(blocks-1));
+        jsvGarbageCollectSkipFlatString(jsvGetRef(var), blocks-1);
+        jsvStatAdd(&jsvUsedBlocks, (unsigned int)blocks);
+        jsvStatAdd(&jsvFlatStringBlocks, (unsigned int)blocks);
         // Now re-link all the free variables
-        jsvCreateEmptyVarList();
+        jsvFreeListAttach(jsvLinkEmptyVars());
         return var;
       }
     } else {
@@ -530,10 +1319,19 @@ JsVar *jsvNewFlatStringOfLength(unsigned int byteLength) {
         i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
     }
   }
+  jsvFreeListAttach(firstEmpty); // we didn't take anything
+  /* There are enough free blocks, they're just not next to each other. Move
+   * things around so they are, and try again */
+  if (canCompact && freeCount>=blocks && jsvCompact())
+    return jsvNewFlatStringOfLengthInternal(byteLength, false);
   // can't make it - return undefined
   return 0;
 }
 
+JsVar *jsvNewFlatStringOfLength(unsigned int byteLength) {
+  return jsvNewFlatStringOfLengthInternal(byteLength, true);
+}
+
 JsVar *jsvNewFromString(const char *str) {
   // Create a var
   JsVar *first = jsvNewWithFlags(JSV_STRING_0);
@@ -543,6 +1341,7 @@ JsVar *jsvNewFromString(const char *str) {
   }
   // Now we copy the string, but keep creating new jsVars if we go
   // over the end
+  size_t length = strlen(str);
   JsVar *var = jsvLockAgain(first);
   while (*str) {
     // quickly set contents to 0
@@ -551,22 +1350,21 @@ JsVar *jsvNewFromString(const char *str) {
     size_t i, l = jsvGetMaxCharactersInVar(var);
     for (i=0;i<l && *str;i++)
       var->varData.str[i] = *(str++);
+    length -= i;
     // we already set the variable data to 0, so no need for adding one
 
     // we've stopped if the string was empty
     jsvSetCharactersInVar(var, i);
 
     // if there is still some left, it's because we filled up our var...
-    // make a new one, link it in, and unlock the old one.
+    // move on to the next one, and unlock the old one.
     if (*str) {
-      JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
+      JsVar *next = jsvLockNextStringExt(var, length);
       if (!next) {
         jsWarn("Truncating string as not enough memory");
         jsvUnLock(var);
         return first;
       }
-      // we don't ref, because  StringExts are never reffed as they only have one owner (and ALWAYS have an owner)
-      jsvSetLastChild(var, jsvGetRef(next));
       jsvUnLock(var);
       var = next;
     }
@@ -597,16 +1395,14 @@ JsVar *jsvNewStringOfLength(unsigned int byteLength) {
       jsvSetCharactersInVar(var, i);
 
       // if there is still some left, it's because we filled up our var...
-      // make a new one, link it in, and unlock the old one.
+      // move on to the next one, and unlock the old one.
       if (byteLength>0) {
-        JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
+        JsVar *next = jsvLockNextStringExt(var, byteLength);
         if (!next) {
           jsWarn("Truncating string as not enough memory");
           jsvUnLock(var);
           return first;
         }
-        // we don't ref, because  StringExts are never reffed as they only have one owner (and ALWAYS have an owner)
-        jsvSetLastChild(var, jsvGetRef(next));
         jsvUnLock(var);
         var = next;
       }
@@ -642,6 +1438,38 @@ JsVar *jsvNewFromLongInteger(long long value) {
 }
 
 
+/// Make a new name share its StringExts with any other names that have the same characters
+static void jsvInternName(JsVar *name) {
+  JsVarRef ref = jsvGetLastChild(name);
+  if (!ref || jsvGetCharactersInVar(name)<JSVAR_DATA_STRING_LEN) return;
+  JsVar *ext = jsvGetAddressOf(ref);
+  if (jsvIsSharedStringExt(ext)) return;
+  // if something's still reading our StringExts (eg. a string iterator) leave them alone
+  JsVarRef r = ref;
+  while (r) {
+    JsVar *v = jsvGetAddressOf(r);
+    if (jsvGetLocks(v)) return;
+    r = jsvGetLastChild(v);
+  }
+  unsigned int i = jsvInternFind(ref, 0);
+  if (jsvInternTable[i]) {
+    jsvStringEndForget(jsvGetRef(name));
+    jsvSetLastChild(name, jsvInternTable[i]);
+    // they may have been waiting for the garbage collector
+    jsvGarbageCollectWriteBarrier(jsvGetAddressOf(jsvInternTable[i]));
+    while (ref) {
+      JsVar *v = jsvGetAddressOf(ref);
+      ref = jsvGetLastChild(v);
+      jsvFreePtrInternal(v);
+    }
+    jsvInternHits++;
+  } else if (jsvInternCount+1 <= JSV_INTERN_TABLE_SIZE*3/4) {
+    jsvInternTable[i] = ref;
+    jsvInternCount++;
+    ext->flags = (JsVarFlags)(ext->flags | JSV_NATIVE);
+  }
+}
+
 JsVar *jsvMakeIntoVariableName(JsVar *var, JsVar *valueOrZero) {
   if (!var) return 0;
   assert(jsvGetRefs(var)==0); // make sure it's unused
@@ -658,6 +1486,8 @@ JsVar *jsvMakeIntoVariableName(JsVar *var, JsVar *valueOrZero) {
     }
     var->flags = (JsVarFlags)(var->flags & ~JSV_VARTYPEMASK) | t;
   } else if ((var->flags & JSV_VARTYPEMASK)>=JSV_STRING_0 && (var->flags & JSV_VARTYPEMASK)<=JSV_STRING_MAX) {
+    // a name's StringExts must be its own (or interned)
+    jsvUnshareStringExts(var);
     size_t t = JSV_NAME_STRING_0;
     if (jsvIsInt(valueOrZero) && !jsvIsPin(valueOrZero)) {
       JsVarInt v = valueOrZero->varData.integer;
@@ -668,6 +1498,7 @@ JsVar *jsvMakeIntoVariableName(JsVar *var, JsVar *valueOrZero) {
       }
     }
     var->flags = (var->flags & (JsVarFlags)~JSV_VARTYPEMASK) | (t+jsvGetCharactersInVar(var));
+    jsvInternName(var);
   } else assert(0);
 
   if (valueOrZero)
@@ -707,6 +1538,51 @@ JsVar *jsvNewNativeFunction(void (*ptr)(void), unsigned short argTypes) {
   return func;
 }
 
+/* Built-in functions are looked up by name every time they're used (eg.
+ * each time `Math.sin(x)` runs), and each lookup would make a new native
+ * function var that is freed again straight after the call. Instead we keep
+ * (locked) the last few that were made and give them out again. One that's
+ * already locked a lot (eg. by recursion) isn't given out again, so we can't
+ * run out of locks. Neither is one that has had properties set on it (eg.
+ * `Math.sin.x = 1`): each lookup gives a new var, so those never stuck - and
+ * they mustn't only stick until the function drops out of the cache.
+ * jsiFreeMoreMemory can empty the cache. */
+#define JSV_NATIVE_FUNCTION_CACHE_SIZE 16
+#define JSV_NATIVE_FUNCTION_CACHE_MAX_LOCKS 8
+static JsVar *jsvNativeFunctionCache[JSV_NATIVE_FUNCTION_CACHE_SIZE]; ///< Locked native functions (or 0)
+
+/// Like jsvNewNativeFunction, but may return the same var as a previous call with the same arguments
+JsVar *jsvGetNativeFunction(void (*ptr)(void), unsigned short argTypes) {
+  JsVar **entry = &jsvNativeFunctionCache[((size_t)ptr/sizeof(short) + argTypes) % JSV_NATIVE_FUNCTION_CACHE_SIZE];
+  JsVar *func = *entry;
+  if (jsvIsNativeFunction(func) && func->varData.native.ptr==ptr && func->varData.native.argTypes==argTypes &&
+      !jsvGetFirstChild(func)) {
+    if (jsvGetLocks(func) < JSV_NATIVE_FUNCTION_CACHE_MAX_LOCKS)
+      return jsvLockAgain(func);
+    return jsvNewNativeFunction(ptr, argTypes);
+  }
+  func = jsvNewNativeFunction(ptr, argTypes);
+  if (func) {
+    jsvUnLock(*entry);
+    *entry = jsvLockAgain(func);
+  }
+  return func;
+}
+
+/// Empty the cache used by jsvGetNativeFunction - returns true if there was anything in it
+bool jsvClearNativeFunctionCache() {
+  bool cleared = false;
+  int i;
+  for (i=0;i<JSV_NATIVE_FUNCTION_CACHE_SIZE;i++) {
+    if (jsvNativeFunctionCache[i]) {
+      jsvUnLock(jsvNativeFunctionCache[i]);
+      jsvNativeFunctionCache[i] = 0;
+      cleared = true;
+    }
+  }
+  return cleared;
+}
+
 void *jsvGetNativeFunctionPtr(const JsVar *function) {
   /* see descriptions in jsvar.h. If we have a child called JSPARSE_FUNCTION_CODE_NAME
    * then we execute code straight from that */
@@ -724,6 +1600,7 @@ void *jsvGetNativeFunctionPtr(const JsVar *function) {
 JsVar *jsvNewArrayBufferFromString(JsVar *str, unsigned int lengthOrZero) {
   JsVar *arr = jsvNewWithFlags(JSV_ARRAYBUFFER);
   if (!arr) return 0;
+  jsvUnshareStringExts(str); // as it'll be written to
   jsvSetFirstChild(arr, jsvGetRef(jsvRef(str)));
   arr->varData.arraybuffer.type = ARRAYBUFFERVIEW_ARRAYBUFFER;
   arr->varData.arraybuffer.byteOffset = 0;
@@ -756,6 +1633,10 @@ bool jsvIsBasicVarEqual(JsVar *a, JsVar *b) {
       }
     }
   } else if (jsvIsString(a) && jsvIsString(b)) {
+    JsVarRef exta = jsvGetInternedStringExt(a);
+    JsVarRef extb = jsvGetInternedStringExt(b);
+    if (exta && extb) // no need to look at the StringExts
+      return exta==extb && memcmp(a->varData.str, b->varData.str, JSVAR_DATA_STRING_LEN)==0;
     JsvStringIterator ita, itb;
     jsvStringIteratorNew(&ita, a, 0);
     jsvStringIteratorNew(&itb, b, 0);
@@ -880,6 +1761,7 @@ size_t jsvGetStringChars(const JsVar *v, size_t startChar, char *str, size_t len
 void jsvSetString(JsVar *v, char *str, size_t len) {
   assert(jsvHasCharacterData(v));
   assert(len == jsvGetStringLength(v));
+  jsvUnshareStringExts(v);
 
   JsvStringIterator it;
   jsvStringIteratorNew(&it, v, 0);
@@ -1006,22 +1888,13 @@ bool jsvIsEmptyString(JsVar *v) {
 }
 
 size_t jsvGetStringLength(JsVar *v) {
-  size_t strLength = 0;
-  JsVar *var = v;
-  JsVarRef ref = 0;
-
   if (!jsvHasCharacterData(v)) return 0;
+  if (!jsvGetLastChild(v)) return jsvGetCharactersInVar(v);
 
-  while (var) {
-    JsVarRef refNext = jsvGetLastChild(var);
-    strLength += jsvGetCharactersInVar(var);
-
-    // Go to next
-    if (ref) jsvUnLock(var); // note use of if (ref), not var
-    ref = refNext;
-    var = ref ? jsvLock(ref) : 0;
-  }
-  if (ref) jsvUnLock(var); // note use of if (ref), not var
+  size_t strLength;
+  JsVar *end = jsvLockStringEnd(v, &strLength);
+  strLength += jsvGetCharactersInVar(end);
+  jsvUnLock(end);
   return strLength;
 }
 
@@ -1033,7 +1906,7 @@ size_t jsvGetFlatStringBlocks(JsVar *v) {
 char *jsvGetFlatStringPointer(JsVar *v) {
   assert(jsvIsFlatString(v));
   if (!jsvIsFlatString(v)) return 0;
-  return (char*)v+1; // pointer to the next JsVar
+  return (char*)(v+1); // pointer to the next JsVar
 }
 
 //  IN A STRING  get the number of lines in the string (min=1)
@@ -1121,49 +1994,15 @@ size_t jsvGetIndexFromLineAndCol(JsVar *v, size_t line, size_t col) {
 }
 
 void jsvAppendString(JsVar *var, const char *str) {
-  assert(jsvIsString(var));
-  JsVar *block = jsvLockAgain(var);
-  // Find the block at end of the string...
-  while (jsvGetLastChild(block)) {
-    JsVarRef next = jsvGetLastChild(block);
-    jsvUnLock(block);
-    block = jsvLock(next);
-  }
-  // find how full the block is
-  size_t blockChars = jsvGetCharactersInVar(block);
-  // now start appending
-  while (*str) {
-    // copy data in
-    size_t i, l=jsvGetMaxCharactersInVar(block);
-    for (i=blockChars;i<l && *str;i++) {
-      block->varData.str[i] = *(str++);
-    }
-    jsvSetCharactersInVar(block, i);
-    // if there is still some left, it's because we filled up our var...
-    // make a new one, link it in, and unlock the old one.
-    if (*str) {
-      JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
-      if (!next) break;
-      // we don't ref, because  StringExts are never reffed as they only have one owner (and ALWAYS have an owner)
-      jsvSetLastChild(block, jsvGetRef(next));
-      jsvUnLock(block);
-      block = next;
-      blockChars=0; // it's new, so empty
-    }
-  }
-  jsvUnLock(block);
+  jsvAppendStringBuf(var, str, strlen(str));
 }
 
 // Append the given string to this one - but does not use null-terminated strings. returns false on failure (from out of memory)
 bool jsvAppendStringBuf(JsVar *var, const char *str, size_t length) {
   assert(jsvIsString(var));
-  JsVar *block = jsvLockAgain(var);
   // Find the block at end of the string...
-  while (jsvGetLastChild(block)) {
-    JsVarRef next = jsvGetLastChild(block);
-    jsvUnLock(block);
-    block = jsvLock(next);
-  }
+  size_t blockIndex;
+  JsVar *block = jsvLockStringEndUnshared(var, &blockIndex);
   // find how full the block is
   size_t blockChars = jsvGetCharactersInVar(block);
   // now start appending
@@ -1176,21 +2015,20 @@ bool jsvAppendStringBuf(JsVar *var, const char *str, size_t length) {
     }
     jsvSetCharactersInVar(block, i);
     // if there is still some left, it's because we filled up our var...
-    // make a new one, link it in, and unlock the old one.
+    // move on to the next one, and unlock the old one.
     if (length) {
-      JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
+      JsVar *next = jsvLockNextStringExt(block, length);
       if (!next) {
-        jsvSetLastChild(block, 0);
         jsvUnLock(block);
         return false;
       }
-      // we don't ref, because  StringExts are never reffed as they only have one owner (and ALWAYS have an owner)
-      jsvSetLastChild(block, jsvGetRef(next));
       jsvUnLock(block);
       block = next;
+      blockIndex += l;
       blockChars=0; // it's new, so empty
     }
   }
+  jsvStringEndMoved(var, block, blockIndex);
   jsvUnLock(block);
   return true;
 }
@@ -1232,21 +2070,16 @@ JsVar *jsvVarPrintf( const char *fmt, ...) {
 
 /** Append str to var. Both must be strings. stridx = start char or str, maxLength = max number of characters (can be JSVAPPENDSTRINGVAR_MAXLENGTH) */
 void jsvAppendStringVar(JsVar *var, const JsVar *str, size_t stridx, size_t maxLength) {
-  JsVar *block = jsvLockAgain(var);
   assert(jsvIsString(var));
   // Find the block at end of the string...
-  while (jsvGetLastChild(block)) {
-    JsVarRef next = jsvGetLastChild(block);
-    jsvUnLock(block);
-    block = jsvLock(next);
-  }
+  size_t blockIndex;
+  JsVar *block = jsvLockStringEndUnshared(var, &blockIndex);
   // find how full the block is
   size_t blockChars = jsvGetCharactersInVar(block);
   // now start appending
   JsvStringIterator it;
   jsvStringIteratorNewConst(&it, str, stridx);
-  while (jsvStringIteratorHasChar(&it) && (maxLength-->0)) {
-    char ch = jsvStringIteratorGetChar(&it);
+  while (jsvStringIteratorHasChar(&it) && maxLength>0) {
     if (blockChars >= jsvGetMaxCharactersInVar(block)) {
       jsvSetCharactersInVar(block, blockChars);
       JsVar *next = jsvNewWithFlags(JSV_STRING_EXT_0);
@@ -1255,20 +2088,119 @@ void jsvAppendStringVar(JsVar *var, const JsVar *str, size_t stridx, size_t maxL
       jsvSetLastChild(block, jsvGetRef(next));
       jsvUnLock(block);
       block = next;
+      blockIndex += blockChars;
       blockChars=0; // it's new, so empty
     }
-    block->varData.str[blockChars++] = ch;
+    // copy as many characters as we can from this var of str in one go
+    size_t n = it.charsInVar - it.charIdx;
+    if (n > jsvGetMaxCharactersInVar(block) - blockChars)
+      n = jsvGetMaxCharactersInVar(block) - blockChars;
+    if (n > maxLength) n = maxLength;
+    if (it.var == block) n = 1; // appending a string to itself
+    memcpy(&block->varData.str[blockChars], &it.var->varData.str[it.charIdx], n);
+    blockChars += n;
+    maxLength -= n;
+    it.charIdx += n-1;
     jsvStringIteratorNext(&it);
   }
   jsvStringIteratorFree(&it);
   jsvSetCharactersInVar(block, blockChars);
+  jsvStringEndMoved(var, block, blockIndex);
+  jsvUnLock(block);
+}
+
+#define JSV_SHARE_STRINGEXTS_MIN_CHARS (4*JSVAR_DATA_STRING_MAX_LEN) ///< Only share the end of a string with a substring if it's at least this long
+
+/** If the characters of str from stridx on (up to maxLength of them) are the
+ * end of a long string, lock and return the first StringExt that starts at or
+ * after stridx, and set *extIndex to the index of its first character - a
+ * substring can share that StringExt and the ones after it. Otherwise return 0 */
+static JsVar *jsvLockShareableStringExt(JsVar *str, size_t stridx, size_t maxLength, size_t *extIndex) {
+  // names' StringExts may be interned, and flat strings don't have any
+  if (jsvIsName(str) || jsvIsFlatString(str) || !jsvGetLastChild(str)) return 0;
+  size_t length = jsvGetStringLength(str);
+  if (stridx >= length || maxLength < length-stridx) return 0;
+  size_t blockIndex;
+  JsVar *block = jsvLockStringBlock(str, stridx, &blockIndex);
+  if (block==str || blockIndex<stridx) {
+    JsVarRef next = jsvGetLastChild(block);
+    blockIndex += jsvGetCharactersInVar(block);
+    jsvUnLock(block);
+    block = next ? jsvLock(next) : 0;
+  }
+  if (block && length-blockIndex < JSV_SHARE_STRINGEXTS_MIN_CHARS) {
+    jsvUnLock(block);
+    block = 0;
+  }
+  *extIndex = blockIndex;
+  return block;
+}
+
+/// Mark the StringExts from ext to the end of its string as shared, so they're never changed or freed along with a string
+static void jsvShareStringExts(JsVar *ext) {
+  JsVarRef ref = jsvGetRef(ext);
+  while (ref) {
+    JsVar *v = jsvGetAddressOf(ref);
+    if (jsvIsSharedStringExt(v)) break; // so are all the ones after it
+    v->flags = (JsVarFlags)(v->flags | JSV_NATIVE);
+    ref = jsvGetLastChild(v);
+  }
+}
+
+/** If this string shares StringExts with other strings (see
+ * jsvNewFromStringVar), give it its own copy of them so it can be changed */
+void jsvUnshareStringExts(JsVar *str) {
+  if (!jsvIsString(str) || jsvIsName(str) || jsvIsFlatString(str)) return;
+  JsVar *block = jsvLockAgain(str);
+  while (jsvGetLastChild(block) && !jsvIsSharedStringExt(jsvGetAddressOf(jsvGetLastChild(block)))) {
+    JsVar *next = jsvLock(jsvGetLastChild(block));
+    jsvUnLock(block);
+    block = next;
+  }
+  if (jsvGetLastChild(block)) {
+    JsVar *shared = jsvLock(jsvGetLastChild(block));
+    jsvSetLastChild(block, 0);
+    jsvStringEndForget(jsvGetRef(str));
+    jsvAppendStringVar(str, shared, 0, JSVAPPENDSTRINGVAR_MAXLENGTH);
+    jsvUnLock(shared);
+  }
   jsvUnLock(block);
 }
 
-/** Create a new variable from a substring. argument must be a string. stridx = start char or str, maxLength = max number of characters (can be JSVAPPENDSTRINGVAR_MAXLENGTH) */
+/// Like jsvLockStringEnd, but if the string shares StringExts with others it gets its own copy first - use this before appending
+JsVar *jsvLockStringEndUnshared(JsVar *str, size_t *endIndex) {
+  JsVar *end = jsvLockStringEnd(str, endIndex);
+  // only the end of a string is ever shared, so if its last var isn't, none are
+  if (jsvIsSharedStringExt(end) && !jsvIsName(str)) {
+    jsvUnLock(end);
+    jsvUnshareStringExts(str);
+    end = jsvLockStringEnd(str, endIndex);
+  }
+  return end;
+}
+
+/** Create a new variable from a substring. argument must be a string. stridx = start char or str, maxLength = max number of characters (can be JSVAPPENDSTRINGVAR_MAXLENGTH).
+ * If the substring is the end of a long string, we only copy characters up
+ * to the start of one of its StringExts, and share the rest */
 JsVar *jsvNewFromStringVar(const JsVar *str, size_t stridx, size_t maxLength) {
   JsVar *var = jsvNewFromEmptyString();
-  if (var) jsvAppendStringVar(var, str, stridx, maxLength);
+  if (!var) return 0;
+  size_t extIndex;
+  JsVar *ext = jsvLockShareableStringExt((JsVar*)str, stridx, maxLength, &extIndex);
+  if (!ext) {
+    jsvAppendStringVar(var, str, stridx, maxLength);
+    return var;
+  }
+  jsvAppendStringVar(var, str, stridx, extIndex-stridx);
+  size_t endIndex;
+  JsVar *end = jsvLockStringEnd(var, &endIndex);
+  if (endIndex+jsvGetCharactersInVar(end) == extIndex-stridx) { // or we ran out of memory
+    jsvShareStringExts(ext);
+    jsvSetLastChild(end, jsvGetRef(ext)); // no ref for stringext
+    jsvGarbageCollectWriteBarrier(ext);
+  }
+  jsvUnLock(end);
+  jsvUnLock(ext);
   return var;
 }
 
@@ -1669,6 +2601,274 @@ int jsvCompareInteger(JsVar *va, JsVar *vb) {
     return 0;
 }
 
+/* Objects with lots of children get a hash index of them, so we don't have to
+ * search through every child to find one. It's a flat string stored as the
+ * first child (so we can find it quickly) under a hidden name. The data is an
+ * array of JsVarRefs: the owner (so we can spot copies), the number of
+ * children in it, then the buckets (each the ref of a child's name, or 0) */
+#define JSV_CHILD_INDEX_NAME JS_HIDDEN_CHAR_STR"idx"
+#define JSV_CHILD_INDEX_MIN_CHILDREN 32 ///< Only make an index when we've had to look through this many children
+#define JSV_CHILD_INDEX_OWNER 0
+#define JSV_CHILD_INDEX_COUNT 1
+#define JSV_CHILD_INDEX_BUCKETS 2
+
+/// Hash a string for the child index. jsvHashStringVar must give the same result for the same characters
+static unsigned int jsvHashString(const char *str) {
+  unsigned int hash = 5381;
+  while (*str)
+    hash = (hash<<5) + hash + (unsigned char)*(str++);
+  return hash;
+}
+
+/// Hash a string var for the child index. jsvHashString must give the same result for the same characters
+static unsigned int jsvHashStringVar(JsVar *var) {
+  unsigned int hash = 5381;
+  JsvStringIterator it;
+  jsvStringIteratorNew(&it, var, 0);
+  while (jsvStringIteratorHasChar(&it)) {
+    hash = (hash<<5) + hash + (unsigned char)jsvStringIteratorGetChar(&it);
+    jsvStringIteratorNext(&it);
+  }
+  jsvStringIteratorFree(&it);
+  return hash;
+}
+
+/** Is the name 'child' equal to str? nameExt is what jsvInternFindString(str)
+ * returned, so if child's StringExts are interned we needn't look at them */
+static bool jsvIsNameEqualString(JsVar *child, const char *str, JsVarRef nameExt) {
+  JsVarRef childExt = jsvGetInternedStringExt(child);
+  if (childExt)
+    return childExt==nameExt && memcmp(child->varData.str, str, JSVAR_DATA_STRING_LEN)==0;
+  return jsvIsStringEqual(child, str);
+}
+
+/// Is this the name of a child index?
+static bool jsvIsChildIndexName(JsVar *v) {
+  return (v->flags&JSV_VARTYPEMASK)==JSV_NAME_STRING_0+4 &&
+         memcmp(v->varData.str, JSV_CHILD_INDEX_NAME, 4)==0;
+}
+
+/// If parent has a child index, return its data and set 'buckets' to the number of buckets in it
+static JsVarRef *jsvGetChildIndex(JsVar *parent, unsigned int *buckets) {
+  if (!(jsvIsObject(parent) || jsvIsRoot(parent)) || !jsvGetFirstChild(parent))
+    return 0;
+  JsVar *name = jsvGetAddressOf(jsvGetFirstChild(parent));
+  if (!jsvIsChildIndexName(name) || !jsvGetFirstChild(name)) return 0;
+  JsVar *indexVar = jsvGetAddressOf(jsvGetFirstChild(name));
+  if (!jsvIsFlatString(indexVar)) return 0;
+  JsVarRef *index = (JsVarRef*)jsvGetFlatStringPointer(indexVar);
+  if (index[JSV_CHILD_INDEX_OWNER] != jsvGetRef(parent)) return 0; // copied from something else, or thrown away
+  *buckets = (unsigned int)(jsvGetStringLength(indexVar)/sizeof(JsVarRef)) - JSV_CHILD_INDEX_BUCKETS;
+  return index;
+}
+
+/// Look up a child in the index by name (or by nameVar if name==0). Returns 0 if not found
+static JsVarRef jsvChildIndexFind(JsVarRef *index, unsigned int buckets, const char *name, JsVar *nameVar) {
+  unsigned int mask = buckets-1;
+  unsigned int i = (name ? jsvHashString(name) : jsvHashStringVar(nameVar)) & mask;
+  JsVarRef nameExt = name ? jsvInternFindString(name) : 0;
+  while (index[JSV_CHILD_INDEX_BUCKETS+i]) {
+    JsVarRef childref = index[JSV_CHILD_INDEX_BUCKETS+i];
+    JsVar *child = jsvGetAddressOf(childref);
+    if (name ? jsvIsNameEqualString(child, name, nameExt) : jsvIsBasicVarEqual(child, nameVar))
+      return childref;
+    i = (i+1) & mask;
+  }
+  return 0;
+}
+
+/// Add a child to the index - returns false if the index is too full
+static bool jsvChildIndexAdd(JsVarRef *index, unsigned int buckets, JsVar *child) {
+  // keep some buckets empty so searches stay short
+  if ((unsigned int)index[JSV_CHILD_INDEX_COUNT]+1 > buckets*3/4) return false;
+  unsigned int mask = buckets-1;
+  unsigned int i = jsvHashStringVar(child) & mask;
+  while (index[JSV_CHILD_INDEX_BUCKETS+i])
+    i = (i+1) & mask;
+  index[JSV_CHILD_INDEX_BUCKETS+i] = jsvGetRef(child);
+  index[JSV_CHILD_INDEX_COUNT]++;
+  return true;
+}
+
+/// Remove a child from the index (if it was in it)
+static void jsvChildIndexRemove(JsVarRef *index, unsigned int buckets, JsVar *child) {
+  unsigned int mask = buckets-1;
+  JsVarRef childref = jsvGetRef(child);
+  unsigned int i = jsvHashStringVar(child) & mask;
+  while (index[JSV_CHILD_INDEX_BUCKETS+i] != childref) {
+    if (!index[JSV_CHILD_INDEX_BUCKETS+i]) return; // not in the index
+    i = (i+1) & mask;
+  }
+  index[JSV_CHILD_INDEX_COUNT]--;
+  /* Fill the gap with anything after it that would have liked to go there,
+   * so searches don't stop early at an empty bucket */
+  unsigned int j = i;
+  while (true) {
+    j = (j+1) & mask;
+    JsVarRef r = index[JSV_CHILD_INDEX_BUCKETS+j];
+    if (!r) break;
+    unsigned int k = jsvHashStringVar(jsvGetAddressOf(r)) & mask; // where it wanted to go
+    if ((i<=j) ? (i<k && k<=j) : (i<k || k<=j)) continue; // it's fine where it is
+    index[JSV_CHILD_INDEX_BUCKETS+i] = r;
+    i = j;
+  }
+  index[JSV_CHILD_INDEX_BUCKETS+i] = 0;
+}
+
+/// Make (or remake) the child index for parent. If we can't, we just don't have one
+static void jsvChildIndexBuild(JsVar *parent, unsigned int children) {
+  unsigned int buckets = 8;
+  while (buckets < children*2) buckets <<= 1;
+  JsVar *indexVar = jsvNewFlatStringOfLength((unsigned int)((JSV_CHILD_INDEX_BUCKETS+buckets)*sizeof(JsVarRef)));
+  if (!indexVar) return;
+  JsVar *name;
+  if (jsvIsChildIndexName(jsvGetAddressOf(jsvGetFirstChild(parent)))) {
+    name = jsvLock(jsvGetFirstChild(parent)); // reuse the old one
+  } else {
+    name = jsvMakeIntoVariableName(jsvNewFromString(JSV_CHILD_INDEX_NAME), 0);
+    if (!name) {
+      jsvUnLock(indexVar);
+      return;
+    }
+    // put it first, so we can find it quickly
+    jsvRef(name);
+    JsVar *firstChild = jsvLock(jsvGetFirstChild(parent));
+    jsvSetPrevSibling(firstChild, jsvGetRef(name));
+    jsvUnLock(firstChild);
+    jsvSetNextSibling(name, jsvGetFirstChild(parent));
+    jsvSetFirstChild(parent, jsvGetRef(name));
+  }
+  jsvSetValueOfName(name, indexVar);
+  JsVarRef *index = (JsVarRef*)jsvGetFlatStringPointer(indexVar);
+  index[JSV_CHILD_INDEX_OWNER] = jsvGetRef(parent);
+  JsVarRef childref = jsvGetNextSibling(name);
+  while (childref) {
+    JsVar *child = jsvGetAddressOf(childref);
+    if (jsvIsString(child))
+      jsvChildIndexAdd(index, buckets, child);
+    childref = jsvGetNextSibling(child);
+  }
+  jsvUnLock(name);
+  jsvUnLock(indexVar);
+}
+
+/* Arrays can also get an index, so we don't have to search through the
+ * children to find an element. It's a flat string whose ref is kept in the
+ * array's nextSibling (which arrays don't otherwise use), and the data is just
+ * an array of JsVarRefs - the ref of the name for each element, or 0. It's
+ * only made when the array is mostly packed (no big gaps). Array functions
+ * like splice and sort renumber names without telling us, so anything we find
+ * in it is checked, and if it looks wrong we throw the index away. */
+#define JSV_ARRAY_INDEX_MIN_EXTRA 4 ///< Room for this many more elements (at least) when making an index
+
+/// If arr has an index, return its data and set 'length' to the number of elements it has room for
+static JsVarRef *jsvGetArrayDenseIndex(JsVar *arr, unsigned int *length) {
+  if (!jsvIsArray(arr) || !jsvGetNextSibling(arr)) return 0;
+  JsVar *indexVar = jsvGetAddressOf(jsvGetNextSibling(arr));
+  *length = (unsigned int)(jsvGetStringLength(indexVar)/sizeof(JsVarRef));
+  return (JsVarRef*)jsvGetFlatStringPointer(indexVar);
+}
+
+/// Throw away an array's index (if it has one). It'll be made again when it's needed
+static void jsvArrayDenseIndexFree(JsVar *arr) {
+  if (!jsvIsArray(arr) || !jsvGetNextSibling(arr)) return;
+  JsVarRef indexRef = jsvGetNextSibling(arr);
+  jsvSetNextSibling(arr, 0);
+  jsvUnRefRef(indexRef);
+}
+
+/** Look up an element's name in the array's index. Returns 0 if it isn't
+ * there, in which case it may still be in the array (so search it) */
+static JsVarRef jsvArrayDenseIndexFind(JsVar *arr, JsVarInt index) {
+  unsigned int length;
+  JsVarRef *items = jsvGetArrayDenseIndex(arr, &length);
+  if (!items || index<0 || index>=(JsVarInt)length || !items[index]) return 0;
+  JsVar *child = jsvGetAddressOf(items[index]);
+  if (jsvIsName(child) && jsvIsInt(child) && child->varData.integer==index)
+    return items[index];
+  // the array has been renumbered since the index was made
+  jsvArrayDenseIndexFree(arr);
+  return 0;
+}
+
+/// A name has been added to the array - add it to the index (or throw the index away)
+static void jsvArrayDenseIndexAdd(JsVar *arr, JsVar *child) {
+  unsigned int length;
+  JsVarRef *items = jsvGetArrayDenseIndex(arr, &length);
+  if (!items || !jsvIsInt(child)) return;
+  JsVarInt index = child->varData.integer;
+  if (index>=0 && index<(JsVarInt)length && !items[index])
+    items[index] = jsvGetRef(child);
+  else // no room - make a bigger one next time we need it
+    jsvArrayDenseIndexFree(arr);
+}
+
+/// A name is being removed from the array - remove it from the index (or throw the index away)
+static void jsvArrayDenseIndexRemove(JsVar *arr, JsVar *child) {
+  unsigned int length;
+  JsVarRef *items = jsvGetArrayDenseIndex(arr, &length);
+  if (!items || !jsvIsInt(child)) return;
+  JsVarInt index = child->varData.integer;
+  if (index>=0 && index<(JsVarInt)length && items[index]==jsvGetRef(child))
+    items[index] = 0;
+  else // it was renumbered, so we don't know where it is
+    jsvArrayDenseIndexFree(arr);
+}
+
+/// Make an index for the array, if it is packed enough to be worth it. If we can't, we just don't have one
+static void jsvArrayDenseIndexBuild(JsVar *arr) {
+  assert(!jsvGetNextSibling(arr));
+  unsigned int elements = 0;
+  JsVarInt maxIndex = -1;
+  JsVarRef childref = jsvGetFirstChild(arr);
+  while (childref) {
+    JsVar *child = jsvGetAddressOf(childref);
+    if (jsvIsInt(child)) {
+      if (child->varData.integer<0) return; // not a real element
+      elements++;
+      if (child->varData.integer > maxIndex) maxIndex = child->varData.integer;
+    }
+    childref = jsvGetNextSibling(child);
+  }
+  // No elements, or too sparse? Then it would use more memory than it saves time
+  if (maxIndex<0 || (unsigned int)maxIndex+1 > elements*2) return;
+  // leave some room to push onto the end
+  unsigned int length = (unsigned int)(maxIndex+1);
+  length += length/2 + JSV_ARRAY_INDEX_MIN_EXTRA;
+  JsVar *indexVar = jsvNewFlatStringOfLength((unsigned int)(length*sizeof(JsVarRef)));
+  if (!indexVar) return;
+  JsVarRef *items = (JsVarRef*)jsvGetFlatStringPointer(indexVar);
+  childref = jsvGetFirstChild(arr);
+  while (childref) {
+    JsVar *child = jsvGetAddressOf(childref);
+    if (jsvIsInt(child))
+      items[child->varData.integer] = childref;
+    childref = jsvGetNextSibling(child);
+  }
+  jsvSetNextSibling(arr, jsvGetRef(jsvRef(indexVar)));
+  jsvUnLock(indexVar);
+}
+
+/** Copy the extra bits of src's string (if there were any) for dst. If they're
+ * interned and dst is a name, dst just shares them */
+static void jsvCopyStringExts(JsVar *dst, JsVar *src) {
+  JsVarRef ref = jsvGetLastChild(src);
+  if (!ref) return;
+  if (jsvIsName(dst) && jsvGetInternedStringExt(src)) {
+    jsvSetLastChild(dst, ref);
+    jsvGarbageCollectWriteBarrier(jsvGetAddressOf(ref));
+    return;
+  }
+  JsVar *child = jsvLock(ref);
+  JsVar *childCopy = jsvCopy(child);
+  if (childCopy) { // could be out of memory
+    childCopy->flags &= (JsVarFlags)~JSV_NATIVE; // a copy isn't interned
+    jsvSetLastChild(dst, jsvGetRef(childCopy)); // no ref for stringext
+    jsvUnLock(childCopy);
+  }
+  jsvUnLock(child);
+}
+
 /** Copy only a name, not what it points to. ALTHOUGH the link to what it points to is maintained unless linkChildren=false
     If keepAsName==false, this will be converted into a normal variable */
 JsVar *jsvCopyNameOnly(JsVar *src, bool linkChildren, bool keepAsName) {
@@ -1701,16 +2901,7 @@ JsVar *jsvCopyNameOnly(JsVar *src, bool linkChildren, bool keepAsName) {
   }
   // Copy extra string data if there was any
   if (jsvHasStringExt(src)) {
-      // copy extra bits of string if there were any
-      if (jsvGetLastChild(src)) {
-        JsVar *child = jsvLock(jsvGetLastChild(src));
-        JsVar *childCopy = jsvCopy(child);
-        if (childCopy) { // could be out of memory
-          jsvSetLastChild(dst, jsvGetRef(childCopy)); // no ref for stringext
-          jsvUnLock(childCopy);
-        }
-        jsvUnLock(child);
-      }
+      jsvCopyStringExts(dst, src);
   } else {
     assert(jsvIsBasic(src)); // in case we missed something!
   }
@@ -1718,6 +2909,13 @@ JsVar *jsvCopyNameOnly(JsVar *src, bool linkChildren, bool keepAsName) {
 }
 
 JsVar *jsvCopy(JsVar *src) {
+  if (jsvIsFlatString(src)) {
+    // the data is in the blocks after src, so we must make another flat string
+    size_t len = jsvGetStringLength(src);
+    JsVar *dst = jsvNewFlatStringOfLength((unsigned int)len);
+    if (dst) memcpy(jsvGetFlatStringPointer(dst), jsvGetFlatStringPointer(src), len);
+    return dst;
+  }
   JsVar *dst = jsvNewWithFlags(src->flags & JSV_VARIABLEINFOMASK);
   if (!dst) return 0; // out of memory
   if (!jsvIsStringExt(src)) {
@@ -1747,23 +2945,15 @@ JsVar *jsvCopy(JsVar *src) {
   }
 
   if (jsvHasStringExt(src)) {
-    // copy extra bits of string if there were any
-    if (jsvGetLastChild(src)) {
-      JsVar *child = jsvLock(jsvGetLastChild(src));
-      JsVar *childCopy = jsvCopy(child);
-      if (childCopy) {// could be out of memory
-        jsvSetLastChild(dst, jsvGetRef(childCopy)); // no ref for stringext
-        jsvUnLock(childCopy);
-      }
-      jsvUnLock(child);
-    }
+    jsvCopyStringExts(dst, src);
   } else if (jsvHasChildren(src)) {
     // Copy children..
     JsVarRef vr;
     vr = jsvGetFirstChild(src);
     while (vr) {
       JsVar *name = jsvLock(vr);
-      JsVar *child = jsvCopyNameOnly(name, true/*link children*/, true/*keep as name*/); // NO DEEP COPY!
+      JsVar *child = jsvIsChildIndexName(name) ? 0 : // the copy makes its own index if it needs one
+                     jsvCopyNameOnly(name, true/*link children*/, true/*keep as name*/); // NO DEEP COPY!
       if (child) { // could have been out of memory
         jsvAddName(dst, child);
         jsvUnLock(child);
@@ -1830,6 +3020,17 @@ void jsvAddName(JsVar *parent, JsVar *namedChild) {
     jsvSetFirstChild(parent, r);
     jsvSetLastChild(parent, r);
   }
+
+  if (jsvIsString(namedChild)) {
+    unsigned int buckets;
+    JsVarRef *index = jsvGetChildIndex(parent, &buckets);
+    if (index && !jsvChildIndexAdd(index, buckets, namedChild))
+      index[JSV_CHILD_INDEX_OWNER] = 0; // full - forget it, and make a bigger one next time we need it
+  } else if (jsvIsArray(parent))
+    jsvArrayDenseIndexAdd(parent, namedChild);
+  // a new field could hide one that was found further up the prototype chain
+  if (jsvIsString(namedChild) && jsvGetRefs(parent))
+    jsvShapeVersion++;
 }
 
 JsVar *jsvAddNamedChild(JsVar *parent, JsVar *child, const char *name) {
@@ -1913,20 +3114,43 @@ JsVar *jsvFindChildFromString(JsVar *parent, const char *name, bool addIfNotFoun
   }
 
   assert(jsvHasChildren(parent));
-  JsVarRef childref = jsvGetFirstChild(parent);
-  while (childref) {
-    // Don't Lock here, just use GetAddressOf - to try and speed up the finding
-    // TODO: We can do this now, but when/if we move to cacheing vars, it'll break
-    JsVar *child = jsvGetAddressOf(childref);
-    if (*(int*)fastCheck==*(int*)child->varData.str && // speedy check of first 4 bytes
-        jsvIsStringEqual(child, name)) {
-       // found it! unlock parent but leave child locked
-       return jsvLockAgain(child);
+  JsVar *child = 0;
+  unsigned int buckets;
+  JsVarRef *index = jsvGetChildIndex(parent, &buckets);
+  if (index) {
+    JsVarRef childref = jsvChildIndexFind(index, buckets, name, 0);
+    if (childref) return jsvLock(childref);
+  } else {
+    unsigned int children = 0;
+    JsVarRef nameExt = jsvInternFindString(name);
+    JsVarRef childref = jsvGetFirstChild(parent);
+    while (childref) {
+      // Don't Lock here, just use GetAddressOf - to try and speed up the finding
+      // TODO: We can do this now, but when/if we move to cacheing vars, it'll break
+      child = jsvGetAddressOf(childref);
+      if (*(int*)fastCheck==*(int*)child->varData.str && // speedy check of first 4 bytes
+          jsvIsNameEqualString(child, name, nameExt)) {
+         // found it! unlock parent but leave child locked
+         child = jsvLockAgain(child);
+         break;
+      }
+      children++;
+      childref = jsvGetNextSibling(child);
+      child = 0;
     }
-    childref = jsvGetNextSibling(child);
+    // if that took a while, make an index so it's faster next time
+    if (children >= JSV_CHILD_INDEX_MIN_CHILDREN && (jsvIsObject(parent) || jsvIsRoot(parent))) {
+      if (child) { // make sure we count everything
+        while (childref) {
+          children++;
+          childref = jsvGetNextSibling(jsvGetAddressOf(childref));
+        }
+      }
+      jsvChildIndexBuild(parent, children);
+    }
+    if (child) return child;
   }
 
-  JsVar *child = 0;
   if (addIfNotFound) {
     child = jsvMakeIntoVariableName(jsvNewFromString(name), 0);
     if (child) // could be out of memory
@@ -1964,20 +3188,45 @@ JsVar *jsvAsName(JsVar *var) {
 
 /** Non-recursive finding */
 JsVar *jsvFindChildFromVar(JsVar *parent, JsVar *childName, bool addIfNotFound) {
-  JsVar *child;
-  JsVarRef childref = jsvGetFirstChild(parent);
-
-  while (childref) {
-    child = jsvLock(childref);
-    if (jsvIsBasicVarEqual(child, childName)) {
-      // found it! unlock parent but leave child locked
-      return child;
+  JsVar *child = 0;
+  unsigned int buckets;
+  JsVarRef *index = jsvIsString(childName) ? jsvGetChildIndex(parent, &buckets) : 0;
+  bool isArrayIndex = jsvIsArray(parent) && jsvIsInt(childName);
+  JsVarRef arrayChildRef = isArrayIndex ? jsvArrayDenseIndexFind(parent, childName->varData.integer) : 0;
+  if (arrayChildRef) {
+    return jsvLock(arrayChildRef);
+  } else if (index) {
+    JsVarRef childref = jsvChildIndexFind(index, buckets, 0, childName);
+    if (childref) return jsvLock(childref);
+  } else {
+    unsigned int children = 0;
+    JsVarRef childref = jsvGetFirstChild(parent);
+    while (childref) {
+      child = jsvLock(childref);
+      if (jsvIsBasicVarEqual(child, childName)) {
+        // found it! unlock parent but leave child locked
+        break;
+      }
+      children++;
+      childref = jsvGetNextSibling(child);
+      jsvUnLock(child);
+      child = 0;
     }
-    childref = jsvGetNextSibling(child);
-    jsvUnLock(child);
+    // if that took a while, make an index so it's faster next time
+    if (children >= JSV_CHILD_INDEX_MIN_CHILDREN && jsvIsString(childName) && (jsvIsObject(parent) || jsvIsRoot(parent))) {
+      if (child) { // make sure we count everything
+        while (childref) {
+          children++;
+          childref = jsvGetNextSibling(jsvGetAddressOf(childref));
+        }
+      }
+      jsvChildIndexBuild(parent, children);
+    }
+    if (children >= JSV_CHILD_INDEX_MIN_CHILDREN && isArrayIndex && !jsvGetNextSibling(parent))
+      jsvArrayDenseIndexBuild(parent);
+    if (child) return child;
   }
 
-  child = 0;
   if (addIfNotFound && childName) {
     child = jsvAsName(childName);
     jsvAddName(parent, child);
@@ -1987,8 +3236,16 @@ JsVar *jsvFindChildFromVar(JsVar *parent, JsVar *childName, bool addIfNotFound)
 
 void jsvRemoveChild(JsVar *parent, JsVar *child) {
     assert(jsvHasChildren(parent));
+    if (jsvIsString(child)) {
+      unsigned int buckets;
+      JsVarRef *index = jsvGetChildIndex(parent, &buckets);
+      if (index) jsvChildIndexRemove(index, buckets, child);
+    } else if (jsvIsArray(parent))
+      jsvArrayDenseIndexRemove(parent, child);
     JsVarRef childref = jsvGetRef(child);
     bool wasChild = false;
+    // whatever comes before the child is about to point at whatever comes after it
+    jsvGarbageCollectWriteBarrierRef(jsvGetNextSibling(child));
     // unlink from parent
     if (jsvGetFirstChild(parent) == childref) {
       jsvSetFirstChild(parent, jsvGetNextSibling(child));
@@ -2018,6 +3275,8 @@ void jsvRemoveChild(JsVar *parent, JsVar *child) {
     jsvSetNextSibling(child, 0);
     if (wasChild)
       jsvUnRef(child);
+    if (jsvIsString(child) && jsvGetRefs(parent))
+      jsvShapeVersion++;
 }
 
 void jsvRemoveAllChildren(JsVar *parent) {
@@ -2037,6 +3296,14 @@ void jsvRemoveNamedChild(JsVar *parent, const char *name) {
   }
 }
 
+unsigned int jsvGetShapeVersion() {
+  return jsvShapeVersion;
+}
+
+void jsvShapeChanged() {
+  jsvShapeVersion++;
+}
+
 /// Check if the given name is a child of the parent
 bool jsvIsChild(JsVar *parent, JsVar *child) {
   assert(jsvIsArray(parent) || jsvIsObject(parent));
@@ -2155,6 +3422,8 @@ static size_t _jsvCountJsVarsUsedRecursive(JsVar *v, bool resetRecursionFlag) {
       childref = jsvGetNextSibling(child);
       jsvUnLock(child);
     }
+    if (jsvIsArray(v) && jsvGetNextSibling(v)) // an array's index
+      count += 1 + jsvGetFlatStringBlocks(jsvGetAddressOf(jsvGetNextSibling(v)));
   } else if (jsvIsFlatString(v))
     count += jsvGetFlatStringBlocks(v);
   if (jsvHasCharacterData(v)) {
@@ -2184,7 +3453,11 @@ size_t jsvCountJsVarsUsed(JsVar *v) {
 
 
 JsVar *jsvGetArrayItem(const JsVar *arr, JsVarInt index) {
-  JsVarRef childref = jsvGetLastChild(arr);
+  JsVar *array = (JsVar*)arr; // we may add an index, but the array itself won't change
+  JsVarRef childref = jsvArrayDenseIndexFind(array, index);
+  if (childref)
+    return jsvSkipNameAndUnLock(jsvLock(childref));
+  childref = jsvGetLastChild(arr);
   JsVarInt lastArrayIndex = 0;
   // Look at last non-string element!
   while (childref) {
@@ -2205,6 +3478,8 @@ JsVar *jsvGetArrayItem(const JsVar *arr, JsVarInt index) {
   // it's not in this array - don't search the whole lot...
   if (index > lastArrayIndex)
     return 0;
+  JsVar *found = 0;
+  unsigned int children = 0;
   // otherwise is it more than halfway through?
   if (index > lastArrayIndex/2) {
     // it's in the final half of the array (probably) - search backwards
@@ -2213,8 +3488,10 @@ JsVar *jsvGetArrayItem(const JsVar *arr, JsVarInt index) {
 
       assert(jsvIsInt(child));
       if (child->varData.integer == index) {
-        return jsvSkipNameAndUnLock(child);
+        found = child;
+        break;
       }
+      children++;
       childref = jsvGetPrevSibling(child);
       jsvUnLock(child);
     }
@@ -2226,13 +3503,18 @@ JsVar *jsvGetArrayItem(const JsVar *arr, JsVarInt index) {
 
       assert(jsvIsInt(child));
       if (child->varData.integer == index) {
-        return jsvSkipNameAndUnLock(child);
+        found = child;
+        break;
       }
+      children++;
       childref = jsvGetNextSibling(child);
       jsvUnLock(child);
     }
   }
-  return 0; // undefined
+  // if that took a while, make an index so it's faster next time
+  if (children >= JSV_CHILD_INDEX_MIN_CHILDREN && jsvIsArray(arr) && !jsvGetNextSibling(arr))
+    jsvArrayDenseIndexBuild(array);
+  return jsvSkipNameAndUnLock(found); // undefined if not found
 }
 
 /// Get the index of the value in the array (matchExact==use pointer, not equality check)
@@ -2340,10 +3622,12 @@ JsVar *jsvArrayPop(JsVar *arr) {
 /// Removes the first element of an array, and returns that element (or 0 if empty). DOES NOT RENUMBER.
 JsVar *jsvArrayPopFirst(JsVar *arr) {
   assert(jsvIsArray(arr));
+  jsvArrayDenseIndexFree(arr); // everything is about to be renumbered anyway
   if (jsvGetFirstChild(arr)) {
     JsVar *child = jsvLock(jsvGetFirstChild(arr));
     if (jsvGetFirstChild(arr) == jsvGetLastChild(arr))
       jsvSetLastChild(arr, 0); // if 1 item in array
+    jsvGarbageCollectWriteBarrierRef(jsvGetNextSibling(child));
     jsvSetFirstChild(arr, jsvGetNextSibling(child)); // unlink from end of array
     jsvUnRef(child); // as no longer in array
     if (jsvGetNextSibling(child)) {
@@ -2420,6 +3704,7 @@ JsVar *jsvArrayJoin(JsVar *arr, JsVar *filler) {
 /// Insert a new element before beforeIndex, DOES NOT UPDATE INDICES
 void jsvArrayInsertBefore(JsVar *arr, JsVar *beforeIndex, JsVar *element) {
   if (beforeIndex) {
+    jsvArrayDenseIndexFree(arr); // everything after this is about to be renumbered
     JsVar *idxVar = jsvMakeIntoVariableName(jsvNewFromInteger(0), element);
     if (!idxVar) return; // out of memory
 
@@ -2437,14 +3722,54 @@ void jsvArrayInsertBefore(JsVar *arr, JsVar *beforeIndex, JsVar *element) {
     }
     jsvSetPrevSibling(beforeIndex, idxRef);
     jsvSetNextSibling(idxVar, jsvGetRef(jsvRef(beforeIndex)));
+    // idxVar may be new (so black) and is now all that links to beforeIndex
+    jsvGarbageCollectWriteBarrierRef(idxRef);
+    jsvGarbageCollectWriteBarrierRef(jsvGetRef(beforeIndex));
     jsvUnLock(idxVar);
   } else
     jsvArrayPush(arr, element);
 }
 
+JsVar *jsvMathsOpError(int op, const char *datatype) {
+    char opName[32];
+    jslTokenAsString(op, opName, sizeof(opName));
+    jsError("Operation %s not supported on the %s datatype", opName, datatype);
+    return 0;
+}
+
+/// The integer part of jsvMathsOp
+static JsVar *jsvMathsOpIntegers(JsVarInt da, JsVarInt db, int op) {
+  switch (op) {
+      case '+': return jsvNewFromLongInteger((long long)da + (long long)db);
+      case '-': return jsvNewFromLongInteger((long long)da - (long long)db);
+      case '*': return jsvNewFromLongInteger((long long)da * (long long)db);
+      case '/': return jsvNewFromFloat((JsVarFloat)da/(JsVarFloat)db);
+      case '&': return jsvNewFromInteger(da&db);
+      case '|': return jsvNewFromInteger(da|db);
+      case '^': return jsvNewFromInteger(da^db);
+      case '%': return db ? jsvNewFromInteger(da%db) : jsvNewFromFloat(NAN);
+      case LEX_LSHIFT: return jsvNewFromInteger(da << db);
+      case LEX_RSHIFT: return jsvNewFromInteger(da >> db);
+      case LEX_RSHIFTUNSIGNED: return jsvNewFromInteger((JsVarInt)(((JsVarIntUnsigned)da) >> db));
+      case LEX_EQUAL:
+      case LEX_TYPEEQUAL: return jsvNewFromBool(da==db);
+      case LEX_NEQUAL:
+      case LEX_NTYPEEQUAL: return jsvNewFromBool(da!=db);
+      case '<':           return jsvNewFromBool(da<db);
+      case LEX_LEQUAL:    return jsvNewFromBool(da<=db);
+      case '>':           return jsvNewFromBool(da>db);
+      case LEX_GEQUAL:    return jsvNewFromBool(da>=db);
+      default: return jsvMathsOpError(op, "Integer");
+  }
+}
+
 /** Same as jsvMathsOpPtr, but if a or b are a name, skip them
  * and go to what they point to. */
 JsVar *jsvMathsOpSkipNames(JsVar *a, JsVar *b, int op) {
+  // if they're both integers we don't need to make vars for the values of any names
+  JsVarInt da, db;
+  if (jsvGetImmediateInteger(a, &da) && jsvGetImmediateInteger(b, &db))
+    return jsvMathsOpIntegers(da, db, op);
   JsVar *pa = jsvSkipName(a);
   JsVar *pb = jsvSkipName(b);
   JsVar *res = jsvMathsOp(pa,pb,op);
@@ -2453,14 +3778,25 @@ JsVar *jsvMathsOpSkipNames(JsVar *a, JsVar *b, int op) {
   return res;
 }
 
-
-JsVar *jsvMathsOpError(int op, const char *datatype) {
-    char opName[32];
-    jslTokenAsString(op, opName, sizeof(opName));
-    jsError("Operation %s not supported on the %s datatype", opName, datatype);
-    return 0;
+bool jsvMathsOpIntoNameInt(JsVar *name, JsVarInt b, int op) {
+  if (!jsvIsNameInt(name) || b<JSVARREF_MIN || b>JSVARREF_MAX) return false;
+  long long a = (long long)jsvGetFirstChildSigned(name);
+  long long r;
+  switch (op) {
+    case '+': r = a + b; break;
+    case '-': r = a - b; break;
+    case '*': r = a * b; break;
+    case '&': r = a & b; break;
+    case '|': r = a | b; break;
+    case '^': r = a ^ b; break;
+    default: return false;
+  }
+  if (r<JSVARREF_MIN || r>JSVARREF_MAX) return false;
+  jsvSetFirstChild(name, (JsVarRef)r);
+  return true;
 }
 
+
 JsVar *jsvMathsOp(JsVar *a, JsVar *b, int op) {
     // Type equality check
     if (op == LEX_TYPEEQUAL || op == LEX_NTYPEEQUAL) {
@@ -2510,28 +3846,9 @@ JsVar *jsvMathsOp(JsVar *a, JsVar *b, int op) {
       if (needsInt || (jsvIsIntegerish(a) && jsvIsIntegerish(b))) {  //2
             // note that int+undefined should be handled as a double
             // use ints
-            JsVarInt da = jsvGetInteger(a);
-            JsVarInt db = jsvGetInteger(b);
-            switch (op) {
-                case '+': return jsvNewFromLongInteger((long long)da + (long long)db);
-                case '-': return jsvNewFromLongInteger((long long)da - (long long)db);
-                case '*': return jsvNewFromLongInteger((long long)da * (long long)db);
-                case '/': return jsvNewFromFloat((JsVarFloat)da/(JsVarFloat)db);
-                case '&': return jsvNewFromInteger(da&db);
-                case '|': return jsvNewFromInteger(da|db);
-                case '^': return jsvNewFromInteger(da^db);
-                case '%': return db ? jsvNewFromInteger(da%db) : jsvNewFromFloat(NAN);
-                case LEX_LSHIFT: return jsvNewFromInteger(da << db);
-                case LEX_RSHIFT: return jsvNewFromInteger(da >> db);
-                case LEX_RSHIFTUNSIGNED: return jsvNewFromInteger((JsVarInt)(((JsVarIntUnsigned)da) >> db));
-                case LEX_EQUAL:     return jsvNewFromBool(da==db && jsvIsNull(a)==jsvIsNull(b));
-                case LEX_NEQUAL:    return jsvNewFromBool(da!=db || jsvIsNull(a)!=jsvIsNull(b));
-                case '<':           return jsvNewFromBool(da<db);
-                case LEX_LEQUAL:    return jsvNewFromBool(da<=db);
-                case '>':           return jsvNewFromBool(da>db);
-                case LEX_GEQUAL:    return jsvNewFromBool(da>=db);
-                default: return jsvMathsOpError(op, "Integer");
-            }
+            if ((op==LEX_EQUAL || op==LEX_NEQUAL) && jsvIsNull(a)!=jsvIsNull(b))
+              return jsvNewFromBool(op==LEX_NEQUAL);
+            return jsvMathsOpIntegers(jsvGetInteger(a), jsvGetInteger(b), op);
         } else {            //2
             // use doubles
             JsVarFloat da = jsvGetFloat(a);
@@ -2627,6 +3944,7 @@ JsVar *jsvGetPathTo(JsVar *root, JsVar *element, int maxDepth, JsVar *ignorePare
     JsVar *el = jsvIteratorGetValue(&it);
     if (el == element && root != ignoreParent) {
       // if we found it - send the key name back!
+      jsvUnLock(el);
       JsVar *name = jsvAsString(jsvIteratorGetKey(&it), true);
       jsvIteratorFree(&it);
       return name;
@@ -2639,10 +3957,12 @@ JsVar *jsvGetPathTo(JsVar *root, JsVar *element, int maxDepth, JsVar *ignorePare
         JsVar *name = jsvVarPrintf(jsvIsObject(el) ? "%v.%v" : "%v[%q]",keyName,n);
         jsvUnLock(keyName);
         jsvUnLock(n);
+        jsvUnLock(el);
         jsvIteratorFree(&it);
         return name;
       }
     }
+    jsvUnLock(el);
     jsvIteratorNext(&it);
   }
   jsvIteratorFree(&it);
@@ -2774,42 +4094,56 @@ void jsvTrace(JsVar *var, int indent) {
 }
 
 
-/** Recursively mark the variable */
-static void jsvGarbageCollectMarkUsed(JsVar *var) {
-  var->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
-
-  if (jsvHasCharacterData(var)) {
-    // non-recursively scan strings
-    JsVarRef child = jsvGetLastChild(var);
-    while (child) {
-      JsVar *childVar;
-      childVar = jsvGetAddressOf(child);
-      childVar->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
-      child = jsvGetLastChild(childVar);
-    }
-  }
-  // intentionally no else
-  if (jsvHasSingleChild(var)) {
-    if (jsvGetFirstChild(var)) {
-      JsVar *childVar = jsvGetAddressOf(jsvGetFirstChild(var));
-      if (childVar->flags & JSV_GARBAGE_COLLECT)
-        jsvGarbageCollectMarkUsed(childVar);
-    }
-  } else if (jsvHasChildren(var)) {
-    JsVarRef child = jsvGetFirstChild(var);
-    while (child) {
-      JsVar *childVar;
-      childVar = jsvGetAddressOf(child);
-      if (childVar->flags & JSV_GARBAGE_COLLECT)
-        jsvGarbageCollectMarkUsed(childVar);
-      child = jsvGetNextSibling(childVar);
+/** Free a var that the garbage collector has found isn't used (as well as
+ * its data blocks if it is a flat string). Returns the number of blocks freed */
+static unsigned int jsvGarbageCollectFreeVar(JsVar *var) {
+  unsigned int count = 1;
+  if (jsvHasStringExt(var) && jsvGetLastChild(var))
+    jsvStringEndForget(jsvGetRef(var));
+  if (jsvIsFlatString(var)) {
+    size_t blocks = jsvGetFlatStringBlocks(var);
+    JsVarRef i = (JsVarRef)(jsvGetRef(var)+blocks);
+    count += (unsigned int)blocks;
+    jsvStatSub(&jsvFlatStringBlocks, count);
+    // do it in reverse, so the free list ends up in kind of the right order
+    while (blocks--) {
+      JsVar *p = jsvGetAddressOf(i--);
+      p->flags = JSV_UNUSED; // it was just string data
+      jsvFreePtrInternal(p);
     }
   }
+  jsvFreePtrInternal(var);
+  return count;
+}
+
+/// Shade everything that this var links to, for the incremental garbage collector
+static void jsvGarbageCollectScan(JsVar *var) {
+  if (jsvHasCharacterData(var))
+    jsvGarbageCollectShade(jsvGetLastChild(var)); // the next StringExt
+  if (jsvHasSingleChild(var) || jsvHasChildren(var))
+    jsvGarbageCollectShade(jsvGetFirstChild(var));
+  /* The rest of our parent's children. We do them one at a time like this so
+   * scanning any var is a small, fixed amount of work. For jsvIsNewChild this
+   * is the parent itself. */
+  if ((jsvIsName(var) && !jsvIsRefUsedForData(var)) || jsvIsArray(var))
+    jsvGarbageCollectShade(jsvGetNextSibling(var)); // or an array's index
+}
+
+/// Scan vars from the mark stack (shading what they link to) until it's empty
+static void jsvGarbageCollectMarkStack() {
+  while (jsvGCStackSize)
+    jsvGarbageCollectScan(jsvGetAddressOf(jsvGCStack[--jsvGCStackSize]));
 }
 
 /** Run a garbage collection sweep - return true if things have been freed */
 bool jsvGarbageCollect() {
   JsVarRef i;
+  // we're going to do everything in one go, so forget any incremental collection
+  jsvGCPhase = JSVGC_IDLE;
+  jsvGCStackSize = 0;
+  jsvGCStackOverflowed = false;
+  // the field cache doesn't stop things being freed, so it mustn't point at garbage
+  jspClearFieldCache();
   // clear garbage collect flags
   for (i=1;i<=jsVarsSize;i++)  {
     JsVar *var = jsvGetAddressOf(i);
@@ -2820,33 +4154,468 @@ bool jsvGarbageCollect() {
         i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
     }
   }
-  // recursively add 'native' vars
+  // mark 'native' vars and everything they link to
   for (i=1;i<=jsVarsSize;i++)  {
     JsVar *var = jsvGetAddressOf(i);
     if ((var->flags & JSV_GARBAGE_COLLECT) && // not already GC'd
-        jsvGetLocks(var)>0) // or it is locked
-      jsvGarbageCollectMarkUsed(var);
+        jsvGetLocks(var)>0) { // or it is locked
+      jsvGarbageCollectShade(i);
+      jsvGarbageCollectMarkStack();
+    }
     // if we have a flat string, skip that many blocks
     if (jsvIsFlatString(var))
       i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
   }
-  // now sweep for things that we can GC!
-  bool freedSomething = false;
+  // and anything waiting in the event queue
+  jsiMarkEvents(jsvGarbageCollectShade);
+  jsvGarbageCollectMarkStack();
+  /* If the stack filled up, some marked vars haven't been scanned. Scanning a
+   * var twice does no harm, so just scan every marked var until nothing more
+   * gets left out. */
+  while (jsvGCStackOverflowed) {
+    jsvGCStackOverflowed = false;
+    for (i=1;i<=jsVarsSize;i++)  {
+      JsVar *var = jsvGetAddressOf(i);
+      if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+        if (!(var->flags & JSV_GARBAGE_COLLECT)) {
+          jsvGarbageCollectScan(var);
+          jsvGarbageCollectMarkStack();
+        }
+        if (jsvIsFlatString(var))
+          i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+      }
+    }
+  }
+  jsvInternForgetGarbage();
+  // now sweep for things that we can GC! (and find the biggest free space while we're at it)
+  unsigned int freed = 0;
+  unsigned int run = 0, largest = 0;
   for (i=1;i<=jsVarsSize;i++)  {
     JsVar *var = jsvGetAddressOf(i);
     if (var->flags & JSV_GARBAGE_COLLECT) {
-      freedSomething = true;
-      // free!
-      var->flags = JSV_UNUSED;
-      // add this to our free list
-      jsvSetNextSibling(var, jsVarFirstEmpty);
-      jsVarFirstEmpty = jsvGetRef(var);
+      // free! (and if it's a flat string, its blocks are now unused too)
+      freed += jsvGarbageCollectFreeVar(var);
+    }
+    if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED) {
+      if (++run > largest) largest = run;
+    } else {
+      run = 0;
+      // if we have a flat string, skip that many blocks
+      if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+  }
+  jsvLargestFreeRun = largest;
+  jsvLargestFreeRunValid = true;
+  jsvGCLastFreed = freed;
+  jsvGCCount++;
+  return freed != 0;
+}
+
+/** Do one small piece of work for the incremental garbage collector. Returns
+ * how many vars were looked at, and sets *finished at the end of a collection */
+static unsigned int jsvGarbageCollectStepOnce(bool *finished) {
+  JsVar *var;
+  if (jsvGCPhase==JSVGC_MARK) {
+    if (jsvGCStackSize) {
+      JsVarRef ref = jsvGCStack[--jsvGCStackSize];
+      var = jsvGetAddressOf(ref);
+      // it may have been freed since it was shaded - that's fine
+      if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED)
+        jsvGarbageCollectScan(var);
+      return 1;
+    }
+    if (!jsvGCRescanning && !jsvGCCheckingLocks) {
+      /* Nothing left to scan. If the stack overflowed, scan everything that's
+       * marked. Otherwise check over all vars for any that are locked but
+       * still white. The lock barrier should mean there are none, but if we
+       * find one we go back to marking. */
+      if (jsvGCStackOverflowed) {
+        jsvGCStackOverflowed = false;
+        jsvGCRescanning = true;
+      } else
+        jsvGCCheckingLocks = true;
+      jsvGCCursor = 1;
+    }
+  }
+
+  if (jsvGCCursor > jsVarsSize) {
+    // we've got to the end of all vars - move on to the next phase
+    switch (jsvGCPhase) {
+      case JSVGC_CLEAR: jsvGCPhase = JSVGC_ROOTS; break;
+      case JSVGC_ROOTS:
+        jsiMarkEvents(jsvGarbageCollectShade); // the event queue is a root too
+        jsvGCPhase = JSVGC_MARK;
+        jsvGCRescanning = false;
+        jsvGCCheckingLocks = false;
+        break;
+      case JSVGC_MARK:
+        if (jsvGCCheckingLocks) {
+          jsiMarkEvents(jsvGarbageCollectShade); // anything queued since ROOTS
+          // if nothing new was shaded, everything that's still white is garbage
+          if (!jsvGCStackSize && !jsvGCStackOverflowed) {
+            jspClearFieldCache(); // it may point to some of that garbage
+            jsvInternForgetGarbage();
+            jsvGCPhase = JSVGC_SWEEP;
+          }
+        }
+        jsvGCRescanning = false;
+        jsvGCCheckingLocks = false;
+        break;
+      default:
+        jsvGCPhase = JSVGC_IDLE;
+        *finished = true;
+        break;
+    }
+    jsvGCCursor = 1;
+    return 0;
+  }
+
+  var = jsvGetAddressOf((JsVarRef)jsvGCCursor);
+  if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+    switch (jsvGCPhase) {
+      case JSVGC_CLEAR:
+        var->flags |= (JsVarFlags)JSV_GARBAGE_COLLECT;
+        break;
+      case JSVGC_ROOTS:
+        if (jsvGetLocks(var)>0)
+          jsvGarbageCollectShade((JsVarRef)jsvGCCursor);
+        break;
+      case JSVGC_MARK:
+        if (jsvGCCheckingLocks) {
+          if (jsvGetLocks(var)>0)
+            jsvGarbageCollectShade((JsVarRef)jsvGCCursor);
+        } else if (!(var->flags & JSV_GARBAGE_COLLECT)) // rescanning
+          jsvGarbageCollectScan(var);
+        break;
+      default: // JSVGC_SWEEP
+        if ((var->flags & JSV_GARBAGE_COLLECT) && jsvGetLocks(var)==0) {
+          // flat string data is freed here too, so there's nothing to skip
+          jsvGCFreed += jsvGarbageCollectFreeVar(var);
+          jsvGCCursor++;
+          return 1;
+        }
+        var->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
+        break;
     }
     // if we have a flat string, skip that many blocks
+    if (jsvIsFlatString(var))
+      jsvGCCursor += (unsigned int)jsvGetFlatStringBlocks(var);
+  }
+  jsvGCCursor++;
+  return 1;
+}
+
+/** Run part of an incremental garbage collection, taking roughly no more than
+ * 'budget' (in system time units). Returns true if a collection finished */
+bool jsvGarbageCollectStep(JsSysTime budget) {
+  JsSysTime startTime = jshGetSystemTime();
+  if (jsvGCPhase==JSVGC_IDLE) {
+    jsvGCPhase = JSVGC_CLEAR;
+    jsvGCCursor = 1;
+    jsvGCStackSize = 0;
+    jsvGCStackOverflowed = false;
+    jsvGCRescanning = false;
+    jsvGCCheckingLocks = false;
+    jsvGCFreed = 0;
+    jsvGCMaxStepTime = 0;
+  }
+  bool finished = false;
+  unsigned int work = 0;
+  JsSysTime stepTime = 0;
+  while (!finished) {
+    work += jsvGarbageCollectStepOnce(&finished);
+    // check the time every so often (we always do something, so we make progress)
+    if (work >= JSV_GC_TIME_CHECK) {
+      work = 0;
+      stepTime = jshGetSystemTime() - startTime;
+      if (stepTime >= budget) break;
+    }
+  }
+  stepTime = jshGetSystemTime() - startTime;
+  if (stepTime > jsvGCMaxStepTime)
+    jsvGCMaxStepTime = stepTime;
+  if (finished) {
+    jsvGCCount++;
+    jsvGCLastFreed = jsvGCFreed;
+    jsvGCLastMaxStepTime = jsvGCMaxStepTime;
+  }
+  return finished;
+}
+
+/// Is an incremental garbage collection part way through?
+bool jsvGarbageCollectInProgress() {
+  return jsvGCPhase != JSVGC_IDLE;
+}
+
+/// Get the number of blocks freed by the last garbage collection that finished
+unsigned int jsvGarbageCollectGetLastFreed() {
+  return jsvGCLastFreed;
+}
+
+/// Get the number of garbage collections (full or incremental) that have finished
+unsigned int jsvGarbageCollectGetCount() {
+  return jsvGCCount;
+}
+
+/// Get the longest time (in system time units) taken by one step of the last incremental garbage collection
+JsSysTime jsvGarbageCollectGetLastMaxStepTime() {
+  return jsvGCLastMaxStepTime;
+}
+
+/// Flags left behind in a var's old position when jsvCompact moves it. nextSibling is where it went
+#define JSV_COMPACT_FORWARD ((JsVarFlags)(JSV_UNUSED|JSV_GARBAGE_COLLECT))
+/* A flat string can't leave JSV_COMPACT_FORWARD behind (it may overlap where it
+ * was), but its own nextSibling isn't used - so jsvCompact works out where each
+ * one will slide to and keeps it there (or 0 if it's staying put) until every
+ * reference has been updated */
+/// References to vars that are stored outside of any var, and need updating when vars move
+static JsVarRef *const jsvCompactHandles[] = {
+  &timerArray,
+  &timerHeap,
+  &watchArray,
+  &watchIndex,
+};
+
+/// Get the new reference for a var that jsvCompact may have moved
+static JsVarRef jsvCompactGetNewRef(JsVarRef ref) {
+  if (!ref) return 0;
+  JsVar *v = jsvGetAddressOf(ref);
+  if (v->flags==JSV_COMPACT_FORWARD ||
+      (jsvIsFlatString(v) && !(v->flags&JSV_GARBAGE_COLLECT) && jsvGetNextSibling(v)))
+    return jsvGetNextSibling(v);
+  return ref;
+}
+
+/// Mark a var (and the rest of its characters if it's a string) so jsvCompact won't move it
+static void jsvCompactPin(JsVarRef ref) {
+  JsVar *var = jsvGetAddressOf(ref);
+  var->flags |= (JsVarFlags)JSV_GARBAGE_COLLECT;
+  if (jsvHasCharacterData(var)) {
+    JsVarRef child = jsvGetLastChild(var);
+    while (child) {
+      JsVar *childVar = jsvGetAddressOf(child);
+      childVar->flags |= (JsVarFlags)JSV_GARBAGE_COLLECT;
+      child = jsvGetLastChild(childVar);
+    }
+  }
+}
+
+/// Update the references in this var to anything that jsvCompact has moved (the same ones jsvGarbageCollectScan follows)
+static void jsvCompactUpdateRefs(JsVar *var) {
+  JsVarRef ref;
+  /* Arrays and child indexes keep refs in the data of a flat string. Nothing
+   * has actually moved yet, so update those while we still link to where the
+   * string is now, and only then update the link */
+  if (jsvIsArray(var) && jsvGetNextSibling(var)) {
+    unsigned int i, length;
+    JsVarRef *items = jsvGetArrayDenseIndex(var, &length);
+    for (i=0;i<length;i++)
+      items[i] = jsvCompactGetNewRef(items[i]);
+    jsvSetNextSibling(var, jsvCompactGetNewRef(jsvGetNextSibling(var)));
+  }
+  if (jsvIsChildIndexName(var) && jsvGetFirstChild(var)) {
+    JsVar *indexVar = jsvGetAddressOf(jsvGetFirstChild(var));
+    if (jsvIsFlatString(indexVar)) {
+      JsVarRef *index = (JsVarRef*)jsvGetFlatStringPointer(indexVar);
+      size_t i, count = jsvGetStringLength(indexVar)/sizeof(JsVarRef);
+      index[JSV_CHILD_INDEX_OWNER] = jsvCompactGetNewRef(index[JSV_CHILD_INDEX_OWNER]);
+      for (i=JSV_CHILD_INDEX_BUCKETS;i<count;i++)
+        index[i] = jsvCompactGetNewRef(index[i]);
+    }
+  }
+  if (jsvHasCharacterData(var) || jsvHasChildren(var)) {
+    ref = jsvGetLastChild(var);
+    if (ref) jsvSetLastChild(var, jsvCompactGetNewRef(ref));
+  }
+  if (jsvHasSingleChild(var) || jsvHasChildren(var)) {
+    ref = jsvGetFirstChild(var);
+    if (ref) jsvSetFirstChild(var, jsvCompactGetNewRef(ref));
+  }
+  if (jsvIsName(var) && !jsvIsRefUsedForData(var)) {
+    ref = jsvGetNextSibling(var);
+    if (ref) jsvSetNextSibling(var, jsvCompactGetNewRef(ref));
+    ref = jsvGetPrevSibling(var);
+    if (ref) jsvSetPrevSibling(var, jsvCompactGetNewRef(ref));
+  }
+}
+
+/// Update every reference to anything that jsvCompact has moved, both in vars and outside them
+static void jsvCompactUpdateAllRefs() {
+  JsVarRef i;
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      jsvCompactUpdateRefs(var);
+      if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+  }
+  // the timer heap and watch index are flat strings too, so update what's in them before the handles
+  jsiRemapTimerHeap(jsvCompactGetNewRef);
+  jsiRemapWatchIndex(jsvCompactGetNewRef);
+  jsiRemapEvents(jsvCompactGetNewRef);
+  jspRemapFieldCache(jsvCompactGetNewRef);
+#ifndef SAVE_ON_FLASH
+  jspRemapProfile(jsvCompactGetNewRef);
+#endif
+  unsigned int h;
+  for (h=0;h<sizeof(jsvCompactHandles)/sizeof(JsVarRef*);h++)
+    *jsvCompactHandles[h] = jsvCompactGetNewRef(*jsvCompactHandles[h]);
+  for (h=0;h<JSV_INTERN_TABLE_SIZE;h++)
+    if (jsvInternTable[h]) jsvInternTable[h] = jsvCompactGetNewRef(jsvInternTable[h]);
+  for (h=0;h<JSV_STRING_END_CACHE_SIZE;h++) {
+    if (jsvStringEndCache[h].str) {
+      jsvStringEndCache[h].str = jsvCompactGetNewRef(jsvStringEndCache[h].str);
+      if (jsvStringEndCache[h].end)
+        jsvStringEndCache[h].end = jsvCompactGetNewRef(jsvStringEndCache[h].end);
+      if (jsvStringEndCache[h].mid)
+        jsvStringEndCache[h].mid = jsvCompactGetNewRef(jsvStringEndCache[h].mid);
+    }
+  }
+}
+
+/** Move vars around so that free blocks are next to each other (which flat
+ * strings need). Anything that is locked (or part of a locked string, as the
+ * lexer walks those without locking) can't move, as there may be pointers to
+ * it. Neither can the buffers that timer tasks read from in their IRQ.
+ * IRQs stay on, apart from while each var is copied - the free list is
+ * detached so they can't allocate while we work. Returns the number of blocks
+ * moved. Don't call this from an IRQ. */
+unsigned int jsvCompact() {
+  JsVarRef i, to;
+  unsigned int moved = 0;
+  // We use the GC flag to mark vars that can't move, so forget any incremental collection
+  jsvGCPhase = JSVGC_IDLE;
+  jsvFreeListDetach();
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      var->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
+      if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+  }
+  // Mark everything that can't move
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      if (jsvGetLocks(var)>0)
+        jsvCompactPin(i);
+      if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+  }
+#ifndef SAVE_ON_FLASH
+  jstMarkBufferTimerTasks(jsvCompactPin);
+#endif
+  /* First move single vars from the top of memory into free blocks at the
+   * bottom. Work out where to split memory - so there are as many free blocks
+   * below the split as there are movable vars above it */
+  unsigned int movable = 0;
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
     if (jsvIsFlatString(var))
       i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    else if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED && !(var->flags&JSV_GARBAGE_COLLECT))
+      movable++;
+  }
+  unsigned int freeBelow = 0;
+  JsVarRef split;
+  for (split=1;split<=jsVarsSize && freeBelow<movable;split++) {
+    JsVar *var = jsvGetAddressOf(split);
+    if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED)
+      freeBelow++;
+    else if (jsvIsFlatString(var))
+      split = (JsVarRef)(split+jsvGetFlatStringBlocks(var));
+    else if (!(var->flags&JSV_GARBAGE_COLLECT))
+      movable--;
+  }
+  to = 1;
+  for (i=split;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED) continue;
+    if (jsvIsFlatString(var)) {
+      i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+      continue;
+    }
+    if (var->flags&JSV_GARBAGE_COLLECT) continue; // can't move
+    // find the next free block below the split
+    while (to<split) {
+      JsVar *toVar = jsvGetAddressOf(to);
+      if ((toVar->flags&JSV_VARTYPEMASK) == JSV_UNUSED) break;
+      if (jsvIsFlatString(toVar))
+        to = (JsVarRef)(to+jsvGetFlatStringBlocks(toVar));
+      to++;
+    }
+    if (to>=split) break;
+    jshInterruptOff();
+    *jsvGetAddressOf(to) = *var;
+    var->flags = JSV_COMPACT_FORWARD;
+    jsvSetNextSibling(var, to);
+    jshInterruptOn();
+    to++;
+    moved++;
+  }
+  /* Now work out where flat strings can slide down to, counting the space
+   * that single vars have just left as free */
+  to = 1; // everything from 'to' up to 'i' will be free
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) == JSV_UNUSED) continue;
+    JsVarRef blocks = jsvIsFlatString(var) ? (JsVarRef)jsvGetFlatStringBlocks(var) : 0;
+    if (blocks && to<i && !(var->flags&JSV_GARBAGE_COLLECT)) {
+      jsvSetNextSibling(var, to);
+      moved += (unsigned int)blocks+1;
+      to = (JsVarRef)(to+blocks+1);
+    } else {
+      if (jsvIsFlatString(var) && !(var->flags&JSV_GARBAGE_COLLECT))
+        jsvSetNextSibling(var, 0);
+      to = (JsVarRef)(i+blocks+1);
+    }
+    i = (JsVarRef)(i+blocks);
+  }
+  if (moved) {
+    // Update every reference in one go, then actually slide the flat strings
+    jsvCompactUpdateAllRefs();
+    for (i=1;i<=jsVarsSize;i++) {
+      JsVar *var = jsvGetAddressOf(i);
+      if (var->flags==JSV_COMPACT_FORWARD)
+        var->flags = JSV_UNUSED;
+      else if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
+    for (i=1;i<=jsVarsSize;i++) {
+      JsVar *var = jsvGetAddressOf(i);
+      if (!jsvIsFlatString(var)) continue;
+      JsVarRef blocks = (JsVarRef)jsvGetFlatStringBlocks(var);
+      to = (var->flags&JSV_GARBAGE_COLLECT) ? 0 : jsvGetNextSibling(var);
+      if (to) {
+        // earlier strings have already slid out of the way, and we only ever move down
+        JsVarRef j;
+        for (j=0;j<=blocks;j++) {
+          jshInterruptOff();
+          *jsvGetAddressOf((JsVarRef)(to+j)) = *jsvGetAddressOf((JsVarRef)(i+j));
+          jshInterruptOn();
+        }
+        jsvSetNextSibling(jsvGetAddressOf(to), 0);
+        for (j=(JsVarRef)(to+blocks+1);j<=i+blocks;j++)
+          jsvGetAddressOf(j)->flags = JSV_UNUSED;
+      }
+      i = (JsVarRef)(i+blocks);
+    }
+  }
+  // Clear the marks we made, and put all the free blocks back in the free list
+  for (i=1;i<=jsVarsSize;i++) {
+    JsVar *var = jsvGetAddressOf(i);
+    if ((var->flags&JSV_VARTYPEMASK) != JSV_UNUSED) {
+      var->flags &= (JsVarFlags)~JSV_GARBAGE_COLLECT;
+      if (jsvIsFlatString(var))
+        i = (JsVarRef)(i+jsvGetFlatStringBlocks(var));
+    }
   }
-  return freedSomething;
+  jsvFreeListAttach(jsvLinkEmptyVars());
+  return moved;
 }
 
 /** Remove whitespace to the right of a string - on MULTIPLE LINES */
@@ -68,6 +68,7 @@ typedef struct {
   /* For Variable NAMES (e.g. Object/Array keys) these store actual next/previous pointers for a linked list or 0.
    *   - if nextSibling==prevSibling==!0 then they point to the object that should contain this name if it ever gets set to anything that's not undefined
    * For STRING_EXT - extra characters
+   * For ARRAY - nextSibling may link to a flat string that indexes the elements
    * Not used for other stuff
    */
 #ifndef JSVARREF_PACKED_BITS
@@ -155,6 +156,7 @@ typedef struct {
  * NAME_INT_INT/NAME_INT_BOOL are the same as NAME_INT, except 'child' contains the value rather than a pointer
  * NAME_STRING_INT is the same as NAME_STRING, except 'child' contains the value rather than a pointer
  * FLAT_STRING uses the variable blocks that follow it as flat storage for all the data
+ * ARRAY may use 'next' to link to a flat string that is an index of its elements (see jsvGetArrayItem)
  * NATIVE_FUNCTION's nativePtr is a pointer to code if there is no child called JSPARSE_FUNCTION_CODE_NAME, but if there is one, it's an index into that child
  *
  * For Objects that represent hardware devices, 'nativePtr' is actually set to a special string that
@@ -212,10 +214,15 @@ void jsvSoftKill(); ///< called when saving to flash
 JsVar *jsvFindOrCreateRoot(); ///< Find or create the ROOT variable item - used mainly if recovering from a saved state.
 unsigned int jsvGetMemoryUsage(); ///< Get number of memory records (JsVars) used
 unsigned int jsvGetMemoryTotal(); ///< Get total amount of memory records
+unsigned int jsvGetMemoryLargestFreeRun(); ///< Get the biggest number of free memory records that are next to each other
+unsigned int jsvGetMemoryFlatStringUsage(); ///< Get number of memory records used by flat strings (including their headers)
+unsigned int jsvGetMemoryLocked(); ///< Get number of JsVars that are currently locked
 bool jsvIsMemoryFull(); ///< Get whether memory is full or not
 void jsvShowAllocated(); ///< Show what is still allocated, for debugging memory problems
 /// Try and allocate more memory - only works if RESIZABLE_JSVARS is defined
 void jsvSetMemoryTotal(unsigned int jsNewVarCount);
+unsigned int jsvGetInternedNameCount(); ///< Get the number of chains of StringExts that long names share (see jsvar.c)
+unsigned int jsvGetInternedNameHits(); ///< Get the number of names that have shared StringExts that were already interned
 
 
 // Note that jsvNew* don't REF a variable for you, but the do LOCK it
@@ -225,7 +232,7 @@ JsVar *jsvNewFromString(const char *str); ///< Create a new string
 JsVar *jsvNewStringOfLength(unsigned int byteLength); ///< Create a new string of the given length - full of 0s
 static ALWAYS_INLINE JsVar *jsvNewFromEmptyString() { JsVar *v = jsvNewWithFlags(JSV_STRING_0); return v; } ;///< Create a new empty string
 static ALWAYS_INLINE JsVar *jsvNewNull() { return jsvNewWithFlags(JSV_NULL); } ;///< Create a new null variable
-/** Create a new variable from a substring. argument must be a string. stridx = start char or str, maxLength = max number of characters (can be JSVAPPENDSTRINGVAR_MAXLENGTH)  */
+/** Create a new variable from a substring. argument must be a string. stridx = start char or str, maxLength = max number of characters (can be JSVAPPENDSTRINGVAR_MAXLENGTH). The end of a long string is shared rather than copied  */
 JsVar *jsvNewFromStringVar(const JsVar *str, size_t stridx, size_t maxLength);
 JsVar *jsvNewFromInteger(JsVarInt value);
 JsVar *jsvNewFromBool(bool value);
@@ -238,6 +245,8 @@ void jsvMakeFunctionParameter(JsVar *v);
 JsVar *jsvNewFromPin(int pin);
 JsVar *jsvNewArray(JsVar **elements, int elementCount); ///< Create an array containing the given elements
 JsVar *jsvNewNativeFunction(void (*ptr)(void), unsigned short argTypes); ///< Create an array containing the given elements
+JsVar *jsvGetNativeFunction(void (*ptr)(void), unsigned short argTypes); ///< Like jsvNewNativeFunction, but may return the same var as a previous call (for built-in functions)
+bool jsvClearNativeFunctionCache(); ///< Free the native functions kept by jsvGetNativeFunction (returns true if there were any)
 JsVar *jsvNewArrayBufferFromString(JsVar *str, unsigned int lengthOrZero); ///< Create a new ArrayBuffer backed by the given string. If length is not specified, it will be worked out
 
 void *jsvGetNativeFunctionPtr(const JsVar *function); ///< Get the actual pointer from a native function - this may not be the contents of varData.native.ptr
@@ -402,6 +411,16 @@ JsVar *jsvAsString(JsVar *var, bool unlockVar); ///< If var is a string, lock an
 JsVar *jsvAsFlatString(JsVar *var); ///< Create a flat string from the given variable (or return it if it is already a flat string)
 bool jsvIsEmptyString(JsVar *v); ///< Returns true if the string is empty - faster than jsvGetStringLength(v)==0
 size_t jsvGetStringLength(JsVar *v); ///< Get the length of this string, IF it is a string
+/// Lock the last var of a string and set *endIndex to the number of characters before it. Remembers where it was for long strings
+JsVar *jsvLockStringEnd(JsVar *str, size_t *endIndex);
+/// Like jsvLockStringEnd, but if the string shares StringExts with others (see jsvNewFromStringVar) it gets its own copy first - use this before appending
+JsVar *jsvLockStringEndUnshared(JsVar *str, size_t *endIndex);
+/// If this string shares StringExts with other strings (see jsvNewFromStringVar), give it its own copy of them so it can be changed
+void jsvUnshareStringExts(JsVar *str);
+/// Characters have been added to the end of a string (which is now 'end') - call after jsvLockStringEnd
+void jsvStringEndMoved(JsVar *str, JsVar *end, size_t endIndex);
+/// Lock the var of a string that contains character idx and set *blockIndex to the number of characters before it. Remembers where it was for long strings
+JsVar *jsvLockStringBlock(JsVar *str, size_t idx, size_t *blockIndex);
 size_t jsvGetFlatStringBlocks(JsVar *v); ///< return the number of blocks used by the given flat string
 char *jsvGetFlatStringPointer(JsVar *v); ///< Get a pointer to the data in this flat string
 size_t jsvGetLinesInString(JsVar *v); ///<  IN A STRING get the number of lines in the string (min=1)
@@ -503,6 +522,22 @@ JsVar *jsvAsName(JsVar *var);
 /// MATHS!
 JsVar *jsvMathsOpSkipNames(JsVar *a, JsVar *b, int op);
 JsVar *jsvMathsOp(JsVar *a, JsVar *b, int op);
+/** Do 'name = name op b' for a name with an integer value stored in it (see
+ * jsvIsNameInt), without making any new vars. Returns false (and does
+ * nothing) if that can't be done - eg. if the result wouldn't fit */
+bool jsvMathsOpIntoNameInt(JsVar *name, JsVarInt b, int op);
+/// If v is an integer, or a name with an integer stored in it (see jsvIsNameInt), get it without making a new var
+static ALWAYS_INLINE bool jsvGetImmediateInteger(const JsVar *v, JsVarInt *value) {
+  if (jsvIsNameInt(v)) {
+    *value = (JsVarInt)jsvGetFirstChildSigned(v);
+    return true;
+  }
+  if (v && (v->flags&JSV_VARTYPEMASK)==JSV_INTEGER) {
+    *value = v->varData.integer;
+    return true;
+  }
+  return false;
+}
 /// Negates an integer/double value
 JsVar *jsvNegateAndUnLock(JsVar *v);
 
@@ -528,6 +563,12 @@ JsVar *jsvFindChildFromVar(JsVar *parent, JsVar *childName, bool addIfNotFound);
 void jsvRemoveChild(JsVar *parent, JsVar *child);
 void jsvRemoveAllChildren(JsVar *parent);
 void jsvRemoveNamedChild(JsVar *parent, const char *name);
+/** A number that changes whenever a named child is added to or removed from
+ * something that is referenced - and so whenever the place a field would be
+ * found in could have changed (see the field cache in jsparse.c) */
+unsigned int jsvGetShapeVersion();
+/// Make jsvGetShapeVersion change, eg. because an object's __proto__ has been replaced
+void jsvShapeChanged();
 
 /// Get the named child of an object. If createChild!=0 then create the child
 JsVar *jsvObjectGetChild(JsVar *obj, const char *name, JsVarFlags createChild);
@@ -560,6 +601,27 @@ void jsvTrace(JsVar *var, int indent);
 /** Run a garbage collection sweep - return true if things have been freed */
 bool jsvGarbageCollect();
 
+/** Run part of an incremental garbage collection, taking roughly no more than
+ * 'budget' (in system time units). Returns true if a collection finished */
+bool jsvGarbageCollectStep(JsSysTime budget);
+
+/// Is an incremental garbage collection part way through?
+bool jsvGarbageCollectInProgress();
+
+/// Get the number of blocks freed by the last garbage collection that finished
+unsigned int jsvGarbageCollectGetLastFreed();
+
+/// Get the number of garbage collections (full or incremental) that have finished
+unsigned int jsvGarbageCollectGetCount();
+
+/// Get the longest time (in system time units) taken by one step of the last incremental garbage collection
+JsSysTime jsvGarbageCollectGetLastMaxStepTime();
+
+/** Move vars around so that free blocks are next to each other (which flat
+ * strings need). IRQs are left on, but can't allocate while it runs.
+ * Returns the number of blocks moved. Don't call this from an IRQ. */
+unsigned int jsvCompact();
+
 /** Remove whitespace to the right of a string - on MULTIPLE LINES */
 JsVar *jsvStringTrimRight(JsVar *srcString);
 
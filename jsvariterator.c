@@ -86,6 +86,12 @@ void jsvStringIteratorNew(JsvStringIterator *it, JsVar *str, size_t startIdx) {
     it->varIndex = -sizeof(JsVar);
     it->charsInVar += sizeof(JsVar);
     it->charIdx = sizeof(JsVar)+startIdx;
+  } else if (startIdx >= it->charsInVar && jsvGetLastChild(str) && !jsvIsStringExt(str)) {
+    // go straight to the var that startIdx is in (if the string is long we may know roughly where that is)
+    jsvUnLock(it->var);
+    it->var = jsvLockStringBlock(str, startIdx, &it->varIndex);
+    it->charsInVar = jsvGetCharactersInVar(it->var);
+    it->charIdx = startIdx - it->varIndex;
   } else {
     it->varIndex = 0;
     it->charIdx = startIdx;
@@ -116,6 +122,15 @@ void jsvStringIteratorNext(JsvStringIterator *it) {
 
 void jsvStringIteratorGotoEnd(JsvStringIterator *it) {
   assert(it->var);
+  if (it->varIndex==0 && !jsvIsStringExt(it->var) && jsvGetLastChild(it->var)) {
+    // we're at the start of the string, so we may already know where the end is
+    size_t endIndex;
+    JsVar *end = jsvLockStringEndUnshared(it->var, &endIndex);
+    jsvUnLock(it->var);
+    it->var = end;
+    it->varIndex = endIndex;
+    it->charsInVar = jsvGetCharactersInVar(end);
+  }
   while (jsvGetLastChild(it->var)) {
      JsVar *next = jsvLock(jsvGetLastChild(it->var));
      jsvUnLock(it->var);
@@ -101,7 +101,7 @@ static ALWAYS_INLINE void jsvStringIteratorNextInline(JsvStringIterator *it) {
 }
 
 
-/// Go to the end of the string iterator - for use with jsvStringIteratorAppend
+/// Go to the end of the string iterator - for use with jsvStringIteratorAppend (so if the iterator is at the start of a string that shares StringExts with others, it gets its own copy of them)
 void jsvStringIteratorGotoEnd(JsvStringIterator *it);
 
 /// Append a character TO THE END of a string iterator
@@ -576,6 +576,8 @@ Get and reset the error flags. Returns an array that can contain:
 `'LOW_MEMORY'`: Memory is running low - Espruino had to run a garbage collection pass or remove some of the command history
 
 `'MEMORY'`: Espruino ran out of memory and was unable to allocate some data that it needed.
+
+`'EVENT_QUEUE_FULL'`: Too many events (callbacks) were waiting to be executed, so some were dropped
 */
 JsVar *jswrap_espruino_getErrorFlags() {
   JsVar *arr = jsvNewWithFlags(JSV_ARRAY);
@@ -585,6 +587,7 @@ JsVar *jswrap_espruino_getErrorFlags() {
   if (jsErrorFlags&JSERR_CALLBACK) jsvArrayPushAndUnLock(arr, jsvNewFromString("CALLBACK"));
   if (jsErrorFlags&JSERR_LOW_MEMORY) jsvArrayPushAndUnLock(arr, jsvNewFromString("LOW_MEMORY"));
   if (jsErrorFlags&JSERR_MEMORY) jsvArrayPushAndUnLock(arr, jsvNewFromString("MEMORY"));
+  if (jsErrorFlags&JSERR_EVENT_QUEUE_FULL) jsvArrayPushAndUnLock(arr, jsvNewFromString("EVENT_QUEUE_FULL"));
   jsErrorFlags = JSERR_NONE;
   return arr;
 }
@@ -602,6 +605,8 @@ JsVar *jswrap_espruino_getErrorFlags() {
 }
 Create an ArrayBuffer from the given string. This is done via a reference, not a copy - so it is very fast and memory efficient.
 
+As with the string itself, substrings that were taken from the end of the string before it was changed via the ArrayBuffer may see the change too.
+
 Note that this is an ArrayBuffer, not a Uint8Array. To get one of those, do: `new Uint8Array(E.toArrayBuffer('....'))`.
 */
 JsVar *jswrap_espruino_toArrayBuffer(JsVar *str) {
@@ -726,3 +731,54 @@ See http://www.espruino.com/Internals for more information
 int jswrap_espruino_getSizeOf(JsVar *v) {
   return (int)jsvCountJsVarsUsed(v);
 }
+
+/*JSON{
+  "type" : "staticmethod",
+  "ifndef" : "SAVE_ON_FLASH",
+  "class" : "E",
+  "name" : "setProfile",
+  "generate" : "jswrap_espruino_setProfile",
+  "params" : [
+    ["period","float","How often to take a sample in milliseconds, or 0/undefined to stop"]
+  ]
+}
+Start sampling where in your code Espruino is executing, every `period` milliseconds. Any samples from before are cleared. Use `E.getProfile()` to find out which functions and lines took the most time.
+
+Samples are taken with the Utility Timer, so this can affect the timing of `digitalPulse` and waveforms. When the profiler is stopped, it doesn't slow anything down.
+*/
+void jswrap_espruino_setProfile(JsVarFloat period) {
+  JsSysTime time = 0;
+  if (period>0) {
+    time = jshGetTimeFromMilliseconds(period);
+    if (time<1) time = 1;
+  }
+  jspSetProfile(time);
+}
+
+/*JSON{
+  "type" : "staticmethod",
+  "ifndef" : "SAVE_ON_FLASH",
+  "class" : "E",
+  "name" : "getProfile",
+  "generate" : "jswrap_espruino_getProfile",
+  "return" : ["JsVar","An object describing where the samples were taken"]
+}
+Return the samples taken since `E.setProfile` was called, as an object like:
+
+```
+{
+  samples : 1000, // how many samples were taken
+  idle : 200, // how many of them were taken when no JavaScript was executing
+  lost : 0, // how many were taken in too many different places to be counted
+  lines : [ // where the samples were taken, most samples first
+    { name : "myFunction", line : 3, count : 500 },
+    ...
+  ]
+}
+```
+
+`line` is the line in the function's code (or in the code that was uploaded or typed in, if it wasn't in a function). `name` is where the function that the line is in can be found, and is left out if it can't be (or if the line isn't in a function).
+*/
+JsVar *jswrap_espruino_getProfile() {
+  return jspGetProfile();
+}
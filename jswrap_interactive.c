@@ -385,15 +385,13 @@ JsVar *_jswrap_interface_setTimeoutOrInterval(JsVar *func, JsVarFloat interval,
     JsVar *timerPtr = jsvNewWithFlags(JSV_OBJECT);
     if (interval<TIMER_MIN_INTERVAL) interval=TIMER_MIN_INTERVAL;
     JsSysTime intervalInt = jshGetTimeFromMilliseconds(interval);
-    //jsiConsolePrintf("interval = %f,intervalInt = %d,now = %d,timeInt = %d\n",interval,intervalInt,jshGetSystemTime(),(jshGetSystemTime() - jsiLastIdleTime) + intervalInt);
-    jsvUnLock(jsvObjectSetChild(timerPtr, "time", jsvNewFromLongInteger((jshGetSystemTime() - jsiLastIdleTime) + intervalInt)));
     if (!isTimeout) {
       jsvUnLock(jsvObjectSetChild(timerPtr, "interval", jsvNewFromLongInteger(intervalInt)));
     }
     jsvObjectSetChild(timerPtr, "callback", func); // intentionally no unlock
 
     // Add to array
-    itemIndex = jsvNewFromInteger(jsiTimerAdd(timerPtr));
+    itemIndex = jsvNewFromInteger(jsiTimerAdd(timerPtr, jshGetSystemTime() + intervalInt));
     jsvUnLock(timerPtr);
   }
   return itemIndex;
@@ -441,10 +439,14 @@ If no argument is supplied, all timers and intervals are stopped
 void _jswrap_interface_clearTimeoutOrInterval(JsVar *idVar, bool isTimeout) {
   JsVar *timerArrayPtr = jsvLock(timerArray);
   if (jsvIsUndefined(idVar)) {
+    jsiTimerRemoveAll();
     jsvRemoveAllChildren(timerArrayPtr);
   } else {
     JsVar *child = jsvIsBasic(idVar) ? jsvFindChildFromVar(timerArrayPtr, idVar, false) : 0;
     if (child) {
+      JsVar *timer = jsvSkipName(child);
+      jsiTimerRemove(timer);
+      jsvUnLock(timer);
       JsVar *timerArrayPtr = jsvLock(timerArray);
       jsvRemoveChild(timerArrayPtr, child);
       jsvUnLock(child);
@@ -491,9 +493,7 @@ void jswrap_interface_changeInterval(JsVar *idVar, JsVarFloat interval) {
     v = jsvNewFromInteger(intervalInt);
     jsvUnLock(jsvSetNamedChild(timer, v, "interval"));
     jsvUnLock(v);
-    v = jsvNewFromInteger((JsVarInt)(jshGetSystemTime()-jsiLastIdleTime) + intervalInt);
-    jsvUnLock(jsvSetNamedChild(timer, v, "time"));
-    jsvUnLock(v);
+    jsiTimerSetTime(timer, jshGetSystemTime() + intervalInt);
     jsvUnLock(timer);
     // timerName already unlocked
   } else {
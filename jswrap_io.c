@@ -439,9 +439,9 @@ JsVar *jswrap_interface_setWatch(JsVar *func, Pin pin, JsVar *repeatOrObject) {
     }
 
 
-    JsVar *watchArrayPtr = jsvLock(watchArray);
-    itemIndex = jsvArrayAddToEnd(watchArrayPtr, watchPtr, 1) - 1;
-    jsvUnLock(watchArrayPtr);
+    itemIndex = jsiWatchAdd(watchPtr);
+    if (itemIndex<0 && exti && !jsiIsWatchingPin(pin))
+      jshPinWatch(pin, false); // out of memory - no watch to handle the events
     jsvUnLock(watchPtr);
   }
   return (itemIndex>=0) ? jsvNewFromInteger(itemIndex) : 0/*undefined*/;
@@ -460,38 +460,14 @@ Clear the Watch that was created with setWatch. If no parameter is supplied, all
 void jswrap_interface_clearWatch(JsVar *idVar) {
 
   if (jsvIsUndefined(idVar)) {
-    JsVar *watchArrayPtr = jsvLock(watchArray);
-    JsvObjectIterator it;
-    jsvObjectIteratorNew(&it, watchArrayPtr);
-    while (jsvObjectIteratorHasValue(&it)) {
-      JsVar *watchPtr = jsvObjectIteratorGetValue(&it);
-      JsVar *watchPin = jsvObjectGetChild(watchPtr, "pin", 0);
-      jshPinWatch(jshGetPinFromVar(watchPin), false);
-      jsvUnLock(watchPin);
-      jsvUnLock(watchPtr);
-      jsvObjectIteratorNext(&it);
-    }
-    jsvObjectIteratorFree(&it);
-    // remove all items
-    jsvRemoveAllChildren(watchArrayPtr);
-    jsvUnLock(watchArrayPtr);
+    jsiWatchRemoveAll();
   } else {
     JsVar *watchArrayPtr = jsvLock(watchArray);
     JsVar *watchNamePtr = jsvFindChildFromVar(watchArrayPtr, idVar, false);
     jsvUnLock(watchArrayPtr);
     if (watchNamePtr) { // child is a 'name'
-      JsVar *watchPtr = jsvSkipName(watchNamePtr);
-      Pin pin = jshGetPinFromVarAndUnLock(jsvObjectGetChild(watchPtr, "pin", 0));
-      jsvUnLock(watchPtr);
-
-      JsVar *watchArrayPtr = jsvLock(watchArray);
-      jsvRemoveChild(watchArrayPtr, watchNamePtr);
+      jsiWatchRemove(watchNamePtr);
       jsvUnLock(watchNamePtr);
-      jsvUnLock(watchArrayPtr);
-
-      // Now check if this pin is still being watched
-      if (!jsiIsWatchingPin(pin))
-        jshPinWatch(pin, false); // 'unwatch' pin
     } else {
       jsExceptionHere(JSET_ERROR, "Unknown Watch");
     }
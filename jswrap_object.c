@@ -216,7 +216,8 @@ JsVar *jswrap_object_keys_or_property_names(JsVar *obj, bool includeNonEnumerabl
   "name" : "create",
   "generate" : "jswrap_object_create",
   "params" : [
-    ["proto","JsVar","A prototype object","propertiesObject","JsVar","An object containing properties. NOT IMPLEMENTED"]
+    ["proto","JsVar","A prototype object"],
+    ["propertiesObject","JsVar","An object containing properties. NOT IMPLEMENTED"]
   ],
   "return" : ["JsVar","A new object"]
 }
@@ -442,16 +443,12 @@ void jswrap_object_emit(JsVar *parent, JsVar *event, JsVar *argArray) {
   jsvGetString(event, &eventName[3], sizeof(eventName)-4);
 
   // extract data
-  const int MAX_ARGS = 4;
-  JsVar *args[MAX_ARGS];
+  int argCount = (int)jsvGetArrayLength(argArray);
+  JsVar **args = (JsVar**)alloca(sizeof(JsVar*)*(size_t)(argCount?argCount:1));
   int n = 0;
   JsvObjectIterator it;
   jsvObjectIteratorNew(&it, argArray);
-  while (jsvObjectIteratorHasValue(&it)) {
-    if (n>=MAX_ARGS) {
-      jsWarn("Too many arguments");
-      break;
-    }
+  while (jsvObjectIteratorHasValue(&it) && n<argCount) {
     args[n++] = jsvObjectIteratorGetValue(&it);
     jsvObjectIteratorNext(&it);
   }
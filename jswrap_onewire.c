@@ -237,15 +237,6 @@ JsVar *jswrap_onewire_read(JsVar *parent, JsVar *count) {
 }
 
 
-/*JSON{
-  "type" : "method",
-  "class" : "OneWire",
-  "name" : "search",
-  "generate" : "jswrap_onewire_search",
-  "return" : ["JsVar","An array of devices that were found"]
-}
-Search for devices
-*/
 /*JSON{
   "type" : "method",
   "class" : "OneWire",
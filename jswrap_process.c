@@ -103,8 +103,30 @@ usage : Memory that has been used
 
 total : Total memory
 
+largest : The biggest number of free blocks that are next to each other - which is what typed arrays and other 'flat' strings need
+
+flatstrings : Memory used by 'flat' strings (for instance the data of typed arrays). This is INCLUDED in the figure for 'usage'
+
+locked : The number of variables that are locked (in use by the interpreter right now, rather than just referenced)
+
 history : Memory used for command history - that is freed if memory is low. Note that this is INCLUDED in the figure for 'free'
 
+gc : Memory freed during the GC pass
+
+gctime : The longest time (in milliseconds) spent in one step of the last incremental garbage collection (done when idle)
+
+events : The number of events (callbacks) waiting to be executed
+
+eventsmax : The most events that have been waiting to be executed at once. If the event queue fills up, events are dropped and `E.getErrorFlags()` reports `EVENT_QUEUE_FULL`
+
+fieldcachehits : The number of `object.field` lookups that were answered from the cache of where each field was found last time
+
+fieldcachemisses : The number of `object.field` lookups that had to search the object, its prototypes and the built-in functions
+
+internednames : The number of distinct long property names whose characters are stored once and shared by every object with that name
+
+internednamehits : The number of times a new property name reused the characters of one that was already stored
+
 stackEndAddress : (on ARM) the address (that can be used with peek/poke/etc) of the END of the stack. The stack grows down, so unless you do a lot of recursion the bytes above this can be used.
 
 Memory units are specified in 'blocks', which are around 16 bytes each (depending on your device). See http://www.espruino.com/Performance for more information.
@@ -118,20 +140,35 @@ extern int _etext; // end of flash text (binary) section
 */
 JsVar *jswrap_process_memory() {
   jsvGarbageCollect();
+  // take all the figures before we allocate anything, so they agree with each other
+  unsigned int history = 0;
+  JsVar *historyVar = jsvObjectGetChild(execInfo.hiddenRoot, JSI_HISTORY_NAME, 0);
+  if (historyVar) {
+    history = (unsigned int)jsvCountJsVarsUsed(historyVar); // vars used to store history
+    jsvUnLock(historyVar);
+  }
+  unsigned int usage = jsvGetMemoryUsage() - history;
+  unsigned int total = jsvGetMemoryTotal();
+  unsigned int largest = jsvGetMemoryLargestFreeRun(); // known after a GC, as long as nothing has been allocated
+  unsigned int flatStrings = jsvGetMemoryFlatStringUsage();
+  unsigned int locked = jsvGetMemoryLocked();
   JsVar *obj = jsvNewWithFlags(JSV_OBJECT);
   if (obj) {
-    unsigned int history = 0;
-    JsVar *historyVar = jsvObjectGetChild(execInfo.hiddenRoot, JSI_HISTORY_NAME, 0);
-    if (historyVar) {
-      history = (unsigned int)jsvCountJsVarsUsed(historyVar); // vars used to store history
-      jsvUnLock(historyVar);
-    }
-    unsigned int usage = jsvGetMemoryUsage() - history;
-    unsigned int total = jsvGetMemoryTotal();
     jsvUnLock(jsvObjectSetChild(obj, "free", jsvNewFromInteger((JsVarInt)(total-usage))));
     jsvUnLock(jsvObjectSetChild(obj, "usage", jsvNewFromInteger((JsVarInt)usage)));
     jsvUnLock(jsvObjectSetChild(obj, "total", jsvNewFromInteger((JsVarInt)total)));
+    jsvUnLock(jsvObjectSetChild(obj, "largest", jsvNewFromInteger((JsVarInt)largest)));
+    jsvUnLock(jsvObjectSetChild(obj, "flatstrings", jsvNewFromInteger((JsVarInt)flatStrings)));
+    jsvUnLock(jsvObjectSetChild(obj, "locked", jsvNewFromInteger((JsVarInt)locked)));
     jsvUnLock(jsvObjectSetChild(obj, "history", jsvNewFromInteger((JsVarInt)history)));
+    jsvUnLock(jsvObjectSetChild(obj, "gc", jsvNewFromInteger((JsVarInt)jsvGarbageCollectGetLastFreed())));
+    jsvUnLock(jsvObjectSetChild(obj, "gctime", jsvNewFromFloat(jshGetMillisecondsFromTime(jsvGarbageCollectGetLastMaxStepTime()))));
+    jsvUnLock(jsvObjectSetChild(obj, "events", jsvNewFromInteger((JsVarInt)jsiGetEventCount())));
+    jsvUnLock(jsvObjectSetChild(obj, "eventsmax", jsvNewFromInteger((JsVarInt)jsiGetMaxEventCount())));
+    jsvUnLock(jsvObjectSetChild(obj, "fieldcachehits", jsvNewFromInteger((JsVarInt)jspGetFieldCacheHits())));
+    jsvUnLock(jsvObjectSetChild(obj, "fieldcachemisses", jsvNewFromInteger((JsVarInt)jspGetFieldCacheMisses())));
+    jsvUnLock(jsvObjectSetChild(obj, "internednames", jsvNewFromInteger((JsVarInt)jsvGetInternedNameCount())));
+    jsvUnLock(jsvObjectSetChild(obj, "internednamehits", jsvNewFromInteger((JsVarInt)jsvGetInternedNameHits())));
 
 /*
 #ifdef ARM
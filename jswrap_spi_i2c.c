@@ -101,12 +101,13 @@ int spi_sender_software(int data, void *info) {
   "type" : "constructor",
   "class" : "SPI",
   "name" : "SPI",
-  "generate" : "jswrap_spi_constructor"
+  "generate" : "jswrap_spi_constructor",
+  "return" : ["JsVar","A new SPI object"]
 }
 Create a software SPI port. This has limited functionality (no baud rate), but it can work on any pins.
  */
 JsVar *jswrap_spi_constructor() {
-	return jsvNewWithFlags(JSV_OBJECT);
+	return jspNewObject(0, "SPI");
 }
 
 
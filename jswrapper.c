@@ -473,7 +473,7 @@ JsVar *jswBinarySearch(const JswSymList *symbolsPtr, JsVar *parent, const char *
     if (cmp==0) {
       if ((sym->functionSpec & JSWAT_EXECUTE_IMMEDIATELY_MASK) == JSWAT_EXECUTE_IMMEDIATELY)
         return jsnCallFunction(sym->functionPtr, sym->functionSpec, parent, 0, 0);
-      return jsvNewNativeFunction(sym->functionPtr, sym->functionSpec);
+      return jsvGetNativeFunction(sym->functionPtr, sym->functionSpec);
     } else {
       if (cmp<0) {
         // searchMin is the same
@@ -497,7 +497,10 @@ static const JswSymPtr jswSymbols_I2C_proto[] = {
   {9, (void (*)(void))jswrap_i2c_setup, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {15, (void (*)(void))jswrap_i2c_writeTo, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_I2C_proto = 0;
+#define jswSymbolIndex_I2C_proto 0
+JSW_CHECK_PROTOTYPE(jswrap_i2c_readFrom, JsVar *(JsVar *, JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_i2c_setup, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_i2c_writeTo, void(JsVar *, JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_Date_proto[] = {
   {0, (void (*)(void))jswrap_date_getDate, JSWAT_INT32 | JSWAT_THIS_ARG},
   {8, (void (*)(void))jswrap_date_getDay, JSWAT_INT32 | JSWAT_THIS_ARG},
@@ -513,12 +516,24 @@ static const JswSymPtr jswSymbols_Date_proto[] = {
   {118, (void (*)(void))jswrap_date_toUTCString, JSWAT_JSVAR | JSWAT_THIS_ARG},
   {130, (void (*)(void))jswrap_date_getTime, JSWAT_JSVARFLOAT | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_Date_proto = 1;
+#define jswSymbolIndex_Date_proto 1
+JSW_CHECK_PROTOTYPE(jswrap_date_getDate, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getDay, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getFullYear, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getHours, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getMilliseconds, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getMinutes, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getMonth, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getSeconds, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getTime, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_getTimezoneOffset, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_toString, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_toUTCString, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_Graphics[] = {
   //{0, (void (*)(void))jswrap_graphics_createArrayBuffer, JSWAT_JSVAR | (JSWAT_INT32 << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2)) | (JSWAT_INT32 << (JSWAT_BITS*3)) | (JSWAT_JSVAR << (JSWAT_BITS*4))},
   //{18, (void (*)(void))jswrap_graphics_createCallback, JSWAT_JSVAR | (JSWAT_INT32 << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2)) | (JSWAT_INT32 << (JSWAT_BITS*3)) | (JSWAT_JSVAR << (JSWAT_BITS*4))}
 };
-static const unsigned char jswSymbolIndex_Graphics = 2;
+#define jswSymbolIndex_Graphics 2
 static const JswSymPtr jswSymbols_E[] = {
   {0, (void (*)(void))jswrap_espruino_FFT, JSWAT_VOID | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2)) | (JSWAT_BOOL << (JSWAT_BITS*3))},
   {4, (void (*)(void))jswrap_espruino_clip, JSWAT_JSVARFLOAT | (JSWAT_JSVARFLOAT << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*3))},
@@ -527,28 +542,50 @@ static const JswSymPtr jswSymbols_E[] = {
   {29, (void (*)(void))jswrap_espruino_enableWatchdog, JSWAT_VOID | (JSWAT_JSVARFLOAT << (JSWAT_BITS*1))},
   {44, (void (*)(void))gen_jswrap_E_getAnalogVRef, JSWAT_JSVARFLOAT},
   {58, (void (*)(void))jswrap_espruino_getErrorFlags, JSWAT_JSVAR},
-  {72, (void (*)(void))jswrap_espruino_getSizeOf, JSWAT_INT32 | (JSWAT_JSVAR << (JSWAT_BITS*1))},
-  {82, (void (*)(void))gen_jswrap_E_getTemperature, JSWAT_JSVARFLOAT},
-  {97, (void (*)(void))jswrap_espruino_interpolate, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))},
-  {109, (void (*)(void))jswrap_espruino_interpolate2d, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*3)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*4))},
-  {123, (void (*)(void))jswrap_espruino_nativeCall, JSWAT_JSVAR | (JSWAT_INT32 << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))},
-  {134, (void (*)(void))jswrap_espruino_reverseByte, JSWAT_INT32 | (JSWAT_INT32 << (JSWAT_BITS*1))},
-  {146, (void (*)(void))jswrap_espruino_sum, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1))},
-  {150, (void (*)(void))jswrap_espruino_toArrayBuffer, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
-  {164, (void (*)(void))jswrap_espruino_toString, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
-  {173, (void (*)(void))jswrap_espruino_toUint8Array, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
-  {186, (void (*)(void))jswrap_espruino_variance, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))}
+  {72, (void (*)(void))jswrap_espruino_getProfile, JSWAT_JSVAR},
+  {83, (void (*)(void))jswrap_espruino_getSizeOf, JSWAT_INT32 | (JSWAT_JSVAR << (JSWAT_BITS*1))},
+  {93, (void (*)(void))gen_jswrap_E_getTemperature, JSWAT_JSVARFLOAT},
+  {108, (void (*)(void))jswrap_espruino_interpolate, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))},
+  {120, (void (*)(void))jswrap_espruino_interpolate2d, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*3)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*4))},
+  {134, (void (*)(void))jswrap_espruino_nativeCall, JSWAT_JSVAR | (JSWAT_INT32 << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))},
+  {145, (void (*)(void))jswrap_espruino_reverseByte, JSWAT_INT32 | (JSWAT_INT32 << (JSWAT_BITS*1))},
+  {157, (void (*)(void))jswrap_espruino_setProfile, JSWAT_VOID | (JSWAT_JSVARFLOAT << (JSWAT_BITS*1))},
+  {168, (void (*)(void))jswrap_espruino_sum, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1))},
+  {172, (void (*)(void))jswrap_espruino_toArrayBuffer, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
+  {186, (void (*)(void))jswrap_espruino_toString, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
+  {195, (void (*)(void))jswrap_espruino_toUint8Array, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
+  {208, (void (*)(void))jswrap_espruino_variance, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_E = 3;
+#define jswSymbolIndex_E 3
+JSW_CHECK_PROTOTYPE(jswrap_espruino_FFT, void(JsVar *, JsVar *, bool))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_clip, JsVarFloat(JsVarFloat, JsVarFloat, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_convolve, JsVarFloat(JsVar *, JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_dumpTimers, void(void))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_enableWatchdog, void(JsVarFloat))
+JSW_CHECK_PROTOTYPE(gen_jswrap_E_getAnalogVRef, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_getErrorFlags, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_getProfile, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_getSizeOf, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_E_getTemperature, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_interpolate, JsVarFloat(JsVar *, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_interpolate2d, JsVarFloat(JsVar *, JsVarInt, JsVarFloat, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_nativeCall, JsVar *(JsVarInt, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_reverseByte, JsVarInt(JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_setProfile, void(JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_sum, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_toArrayBuffer, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_toString, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_toUint8Array, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_espruino_variance, JsVarFloat(JsVar *, JsVarFloat))
 static const JswSymPtr jswSymbols_Server_proto[] = {
   //{0, (void (*)(void))jswrap_net_server_close, JSWAT_VOID | JSWAT_THIS_ARG},
   //{6, (void (*)(void))jswrap_net_server_listen, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Server_proto = 4;
+#define jswSymbolIndex_Server_proto 4
 static const JswSymPtr jswSymbols_Socket[] = {
   
 };
-static const unsigned char jswSymbolIndex_Socket = 5;
+#define jswSymbolIndex_Socket 5
 static const JswSymPtr jswSymbols_String_proto[] = {
   {0, (void (*)(void))jswrap_string_charAt, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))},
   {7, (void (*)(void))jswrap_string_charCodeAt, JSWAT_INT32 | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))},
@@ -563,32 +600,51 @@ static const JswSymPtr jswSymbols_String_proto[] = {
   {82, (void (*)(void))gen_jswrap_String_toLowerCase, JSWAT_JSVAR | JSWAT_THIS_ARG},
   {94, (void (*)(void))gen_jswrap_String_toUpperCase, JSWAT_JSVAR | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_String_proto = 6;
+#define jswSymbolIndex_String_proto 6
+JSW_CHECK_PROTOTYPE(jswrap_string_charAt, JsVar *(JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_string_charCodeAt, JsVarInt(JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_String_indexOf, JsVarInt(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_String_lastIndexOf, JsVarInt(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_length, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_string_replace, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_string_slice, JsVar *(JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_string_split, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_string_substr, JsVar *(JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_string_substring, JsVar *(JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_String_toLowerCase, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_String_toUpperCase, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_OneWire_proto[] = {
   {0, (void (*)(void))jswrap_onewire_read, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {5, (void (*)(void))jswrap_onewire_reset, JSWAT_BOOL | JSWAT_THIS_ARG},
-  {11, (void (*)(void))jswrap_onewire_search, JSWAT_JSVAR | JSWAT_THIS_ARG},
-  {18, (void (*)(void))jswrap_onewire_search, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))},
-  {25, (void (*)(void))jswrap_onewire_select, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
-  {32, (void (*)(void))jswrap_onewire_skip, JSWAT_VOID | JSWAT_THIS_ARG},
-  {37, (void (*)(void))jswrap_onewire_write, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_BOOL << (JSWAT_BITS*2))}
+  {11, (void (*)(void))jswrap_onewire_search, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))},
+  {18, (void (*)(void))jswrap_onewire_select, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
+  {25, (void (*)(void))jswrap_onewire_skip, JSWAT_VOID | JSWAT_THIS_ARG},
+  {30, (void (*)(void))jswrap_onewire_write, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_BOOL << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_OneWire_proto = 7;
+#define jswSymbolIndex_OneWire_proto 7
+JSW_CHECK_PROTOTYPE(jswrap_onewire_read, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_reset, bool(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_search, JsVar *(JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_select, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_skip, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_write, void(JsVar *, JsVar *, bool))
 static const JswSymPtr jswSymbols_Serial[] = {
   
 };
-static const unsigned char jswSymbolIndex_Serial = 8;
+#define jswSymbolIndex_Serial 8
 static const JswSymPtr jswSymbols_httpSRs_proto[] = {
   //{0, (void (*)(void))jswrap_httpSRs_end, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   //{4, (void (*)(void))jswrap_httpSRs_write, JSWAT_BOOL | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   //{10, (void (*)(void))jswrap_httpSRs_writeHead, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_httpSRs_proto = 9;
+#define jswSymbolIndex_httpSRs_proto 9
 static const JswSymPtr jswSymbols_JSON[] = {
   {0, (void (*)(void))jswrap_json_parse, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {6, (void (*)(void))jswrap_json_stringify, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_JSON = 10;
+#define jswSymbolIndex_JSON 10
+JSW_CHECK_PROTOTYPE(jswrap_json_parse, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_json_stringify, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_global[] = {
   {0, (void (*)(void))jswrap_array_constructor, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
   {6, (void (*)(void))jswrap_arraybuffer_constructor, JSWAT_JSVAR | (JSWAT_INT32 << (JSWAT_BITS*1))},
@@ -624,7 +680,7 @@ static const JswSymPtr jswSymbols_global[] = {
   {247, (void (*)(void))gen_jswrap_Object_Object, JSWAT_JSVAR},
   {254, (void (*)(void))jswrap_onewire_constructor, JSWAT_JSVAR | (JSWAT_PIN << (JSWAT_BITS*1))},
   {262, (void (*)(void))jswrap_pin_constructor, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
-  {266, (void (*)(void))jswrap_spi_constructor, JSWAT_VOID},
+  {266, (void (*)(void))jswrap_spi_constructor, JSWAT_JSVAR},
   {270, (void (*)(void))gen_jswrap_SPI1, JSWAT_JSVAR | JSWAT_EXECUTE_IMMEDIATELY},
   {275, (void (*)(void))gen_jswrap_SPI2, JSWAT_JSVAR | JSWAT_EXECUTE_IMMEDIATELY},
   {280, (void (*)(void))gen_jswrap_SPI3, JSWAT_JSVAR | JSWAT_EXECUTE_IMMEDIATELY},
@@ -694,29 +750,141 @@ static const JswSymPtr jswSymbols_global[] = {
   {850, (void (*)(void))jswrap_interface_trace, JSWAT_VOID | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {856, (void (*)(void))gen_jswrap_url_url, JSWAT_JSVAR}
 };
-static const unsigned char jswSymbolIndex_global = 11;
+#define jswSymbolIndex_global 11
+JSW_CHECK_PROTOTYPE(jswrap_array_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_arraybuffer_constructor, JsVar *(JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_ArrayBufferView_ArrayBufferView, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_boolean_constructor, bool(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_date_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_E_E, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_error_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Float32Array_Float32Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Float64Array_Float64Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_function_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Graphics_Graphics, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_HIGH, JsVarInt(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Hardware_Hardware, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_I2C_I2C, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_I2C1, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_I2C2, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_I2C3, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Infinity, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Int16Array_Int16Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Int32Array_Int32Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Int8Array_Int8Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_internalerror_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_JSON_JSON, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_LOW, JsVarInt(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_LoopbackA, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_LoopbackB, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_Math, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Modules_Modules, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_NaN, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Nucleo_Nucleo, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_number_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Object_Object, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_onewire_constructor, JsVar *(Pin))
+JSW_CHECK_PROTOTYPE(jswrap_pin_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_spi_constructor, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_SPI1, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_SPI2, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_SPI3, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Serial_Serial, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Serial1, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Serial2, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Serial3, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Server_Server, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Socket_Socket, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_string_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_syntaxerror_constructor, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Uint16Array_Uint16Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Uint32Array_Uint32Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Uint8Array_Uint8Array, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Uint8ClampedArray_Uint8ClampedArray, JsVar *(JsVar *, JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_WLAN_WLAN, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_waveform_constructor, JsVar *(JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jshPinAnalog, JsVarFloat(Pin))
+JSW_CHECK_PROTOTYPE(jswrap_io_analogWrite, void(Pin, JsVarFloat, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_arguments, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_atob, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_btoa, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_changeInterval, void(JsVar *, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_interface_clearInterval, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_clearTimeout, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_clearWatch, void(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_console_console, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_io_digitalPulse, void(Pin, bool, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_io_digitalRead, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_io_digitalWrite, void(JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jsiDumpState, void(void))
+JSW_CHECK_PROTOTYPE(jswrap_interface_echo, void(bool))
+JSW_CHECK_PROTOTYPE(jswrap_interface_edit, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_eval, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_fs_fs, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_io_getPinMode, JsVar *(Pin))
+JSW_CHECK_PROTOTYPE(jswrap_interface_getSerial, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_getTime, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_httpCRq_httpCRq, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_httpCRs_httpCRs, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_httpSRq_httpSRq, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_httpSRs_httpSRs, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_httpSrv_httpSrv, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_isNaN, bool(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_load, void(void))
+JSW_CHECK_PROTOTYPE(jswrap_parseFloat, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_parseInt, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_peek16, JsVar *(JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_peek32, JsVar *(JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_peek8, JsVar *(JsVarInt, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_io_pinMode, void(Pin, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_poke16, void(JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_poke32, void(JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_poke8, void(JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_print, void(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_process_process, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_require, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_reset, void(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_save, void(void))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setBusyIndicator, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setDeepSleep, void(bool))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setInterval, JsVar *(JsVar *, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setSleepIndicator, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interactive_setTime, void(JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setTimeout, JsVar *(JsVar *, JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_interface_setWatch, JsVar *(JsVar *, Pin, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_interface_trace, void(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_url_url, JsVar *(void))
 static const JswSymPtr jswSymbols_Modules[] = {
   {0, (void (*)(void))jswrap_modules_addCached, JSWAT_VOID | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {10, (void (*)(void))jswrap_modules_getCached, JSWAT_JSVAR},
   {20, (void (*)(void))jswrap_modules_removeAllCached, JSWAT_VOID},
   {36, (void (*)(void))jswrap_modules_removeCached, JSWAT_VOID | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Modules = 12;
+#define jswSymbolIndex_Modules 12
+JSW_CHECK_PROTOTYPE(jswrap_modules_addCached, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_modules_getCached, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_modules_removeAllCached, void(void))
+JSW_CHECK_PROTOTYPE(jswrap_modules_removeCached, void(JsVar *))
 static const JswSymPtr jswSymbols_Error_proto[] = {
   {0, (void (*)(void))jswrap_error_toString, JSWAT_JSVAR | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_Error_proto = 13;
+#define jswSymbolIndex_Error_proto 13
+JSW_CHECK_PROTOTYPE(jswrap_error_toString, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_Object[] = {
-  {0, (void (*)(void))jswrap_object_create, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
+  {0, (void (*)(void))jswrap_object_create, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {7, (void (*)(void))jswrap_object_getOwnPropertyDescriptor, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {32, (void (*)(void))gen_jswrap_Object_getOwnPropertyNames, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {52, (void (*)(void))gen_jswrap_Object_keys, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Object = 14;
+#define jswSymbolIndex_Object 14
+JSW_CHECK_PROTOTYPE(jswrap_object_create, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_getOwnPropertyDescriptor, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Object_getOwnPropertyNames, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Object_keys, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_httpCRq[] = {
   
 };
-static const unsigned char jswSymbolIndex_httpCRq = 15;
+#define jswSymbolIndex_httpCRq 15
 static const JswSymPtr jswSymbols_Serial_proto[] = {
   {0, (void (*)(void))jswrap_stream_available, JSWAT_INT32 | JSWAT_THIS_ARG},
   {10, (void (*)(void))jswrap_serial_onData, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
@@ -728,15 +896,25 @@ static const JswSymPtr jswSymbols_Serial_proto[] = {
   {52, (void (*)(void))jswrap_serial_setup, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {58, (void (*)(void))jswrap_serial_write, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Serial_proto = 16;
+#define jswSymbolIndex_Serial_proto 16
+JSW_CHECK_PROTOTYPE(jswrap_stream_available, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_serial_onData, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pipe, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_serial_print, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_serial_println, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_stream_read, JsVar *(JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Serial_setConsole, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_serial_setup, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_serial_write, void(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_CC3000[] = {
   //{0, (void (*)(void))jswrap_cc3000_connect, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_PIN << (JSWAT_BITS*2)) | (JSWAT_PIN << (JSWAT_BITS*3)) | (JSWAT_PIN << (JSWAT_BITS*4))}
 };
-static const unsigned char jswSymbolIndex_CC3000 = 17;
+#define jswSymbolIndex_CC3000 17
 static const JswSymPtr jswSymbols_Array[] = {
   {0, (void (*)(void))gen_jswrap_Array_isArray, JSWAT_BOOL | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Array = 18;
+#define jswSymbolIndex_Array 18
+JSW_CHECK_PROTOTYPE(gen_jswrap_Array_isArray, bool(JsVar *))
 static const JswSymPtr jswSymbols_Number[] = {
   {0, (void (*)(void))gen_jswrap_Number_MAX_VALUE, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY},
   {10, (void (*)(void))gen_jswrap_Number_MIN_VALUE, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY},
@@ -744,7 +922,12 @@ static const JswSymPtr jswSymbols_Number[] = {
   {38, (void (*)(void))gen_jswrap_Number_NaN, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY},
   {42, (void (*)(void))gen_jswrap_Number_POSITIVE_INFINITY, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY}
 };
-static const unsigned char jswSymbolIndex_Number = 19;
+#define jswSymbolIndex_Number 19
+JSW_CHECK_PROTOTYPE(gen_jswrap_Number_MAX_VALUE, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Number_MIN_VALUE, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Number_NEGATIVE_INFINITY, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Number_NaN, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Number_POSITIVE_INFINITY, JsVarFloat(void))
 static const JswSymPtr jswSymbols_Math[] = {
   {0, (void (*)(void))gen_jswrap_Math_E, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY},
   {2, (void (*)(void))gen_jswrap_Math_LN10, JSWAT_JSVARFLOAT | JSWAT_EXECUTE_IMMEDIATELY},
@@ -775,7 +958,35 @@ static const JswSymPtr jswSymbols_Math[] = {
   {128, (void (*)(void))gen_jswrap_Math_tan, JSWAT_JSVARFLOAT | (JSWAT_JSVARFLOAT << (JSWAT_BITS*1))},
   {132, (void (*)(void))wrapAround, JSWAT_JSVARFLOAT | (JSWAT_JSVARFLOAT << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_Math = 20;
+#define jswSymbolIndex_Math 20
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_E, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_LN10, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_LN2, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_LOG10E, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_LOG2E, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_PI, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_SQRT1_2, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_SQRT2, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(jswrap_math_abs, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(acos, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(asin, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(atan, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(atan2, JsVarFloat(JsVarFloat, JsVarFloat))
+JSW_CHECK_PROTOTYPE(ceil, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_math_clip, JsVarFloat(JsVarFloat, JsVarFloat, JsVarFloat))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_cos, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(exp, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(floor, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(log, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_max, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_min, JsVarFloat(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_math_pow, JsVarFloat(JsVarFloat, JsVarFloat))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_random, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(jswrap_math_round, JsVar *(JsVarFloat))
+JSW_CHECK_PROTOTYPE(sin, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(jswrap_math_sqrt, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Math_tan, JsVarFloat(JsVarFloat))
+JSW_CHECK_PROTOTYPE(wrapAround, JsVarFloat(JsVarFloat, JsVarFloat))
 static const JswSymPtr jswSymbols_Graphics_proto[] = {
 		/*
   {0, (void (*)(void))jswrap_graphics_clear, JSWAT_VOID | JSWAT_THIS_ARG},
@@ -804,21 +1015,23 @@ static const JswSymPtr jswSymbols_Graphics_proto[] = {
   {234, (void (*)(void))jswrap_graphics_stringWidth, JSWAT_INT32 | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 */
 };
-static const unsigned char jswSymbolIndex_Graphics_proto = 21;
+#define jswSymbolIndex_Graphics_proto 21
 static const JswSymPtr jswSymbols_fs[] = {
   {0, (void (*)(void))jswrap_pipe, JSWAT_VOID | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))}
 };
-static const unsigned char jswSymbolIndex_fs = 22;
+#define jswSymbolIndex_fs 22
+JSW_CHECK_PROTOTYPE(jswrap_pipe, void(JsVar *, JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_InternalError_proto[] = {
   {0, (void (*)(void))jswrap_error_toString, JSWAT_JSVAR | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_InternalError_proto = 23;
+#define jswSymbolIndex_InternalError_proto 23
+JSW_CHECK_PROTOTYPE(jswrap_error_toString, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_http[] = {
   //{0, (void (*)(void))jswrap_http_createServer, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   //{13, (void (*)(void))jswrap_http_get, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   //{17, (void (*)(void))gen_jswrap_http_request, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_http = 24;
+#define jswSymbolIndex_http 24
 static const JswSymPtr jswSymbols_Object_proto[] = {
   {0, (void (*)(void))jswrap_object_clone, JSWAT_JSVAR | JSWAT_THIS_ARG},
   {6, (void (*)(void))jswrap_object_emit, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*2))},
@@ -829,7 +1042,15 @@ static const JswSymPtr jswSymbols_Object_proto[] = {
   {55, (void (*)(void))jswrap_object_toString, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {64, (void (*)(void))jswrap_object_valueOf, JSWAT_JSVAR | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_Object_proto = 25;
+#define jswSymbolIndex_Object_proto 25
+JSW_CHECK_PROTOTYPE(jswrap_object_clone, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_emit, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_hasOwnProperty, bool(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_length, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_on, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_removeAllListeners, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_toString, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_valueOf, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_Nucleo[] = {
   /*{0, (void (*)(void))gen_jswrap_Nucleo_A0, JSWAT_PIN | JSWAT_EXECUTE_IMMEDIATELY},
   {3, (void (*)(void))gen_jswrap_Nucleo_A1, JSWAT_PIN | JSWAT_EXECUTE_IMMEDIATELY},
@@ -854,13 +1075,15 @@ static const JswSymPtr jswSymbols_Nucleo[] = {
   {66, (void (*)(void))gen_jswrap_Nucleo_D8, JSWAT_PIN | JSWAT_EXECUTE_IMMEDIATELY},
   {69, (void (*)(void))gen_jswrap_Nucleo_D9, JSWAT_PIN | JSWAT_EXECUTE_IMMEDIATELY}*/
 };
-static const unsigned char jswSymbolIndex_Nucleo = 26;
+#define jswSymbolIndex_Nucleo 26
 static const JswSymPtr jswSymbols_Function_proto[] = {
   {0, (void (*)(void))jswrap_function_apply_or_call, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {6, (void (*)(void))jswrap_function_apply_or_call, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*2))},
   {11, (void (*)(void))jswrap_function_replaceWith, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Function_proto = 27;
+#define jswSymbolIndex_Function_proto 27
+JSW_CHECK_PROTOTYPE(jswrap_function_apply_or_call, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_function_replaceWith, void(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_Socket_proto[] = {
   {0, (void (*)(void))jswrap_stream_available, JSWAT_INT32 | JSWAT_THIS_ARG},
   //{10, (void (*)(void))jswrap_net_socket_end, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
@@ -868,20 +1091,25 @@ static const JswSymPtr jswSymbols_Socket_proto[] = {
   {19, (void (*)(void))jswrap_stream_read, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))},
   //{24, (void (*)(void))jswrap_net_socket_write, JSWAT_BOOL | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Socket_proto = 28;
+#define jswSymbolIndex_Socket_proto 28
+JSW_CHECK_PROTOTYPE(jswrap_stream_available, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pipe, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_stream_read, JsVar *(JsVar *, JsVarInt))
 static const JswSymPtr jswSymbols_httpSRq[] = {
   
 };
-static const unsigned char jswSymbolIndex_httpSRq = 29;
+#define jswSymbolIndex_httpSRq 29
 static const JswSymPtr jswSymbols_Date[] = {
   {0, (void (*)(void))jswrap_date_now, JSWAT_JSVARFLOAT},
   {4, (void (*)(void))jswrap_date_parse, JSWAT_JSVARFLOAT | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Date = 30;
+#define jswSymbolIndex_Date 30
+JSW_CHECK_PROTOTYPE(jswrap_date_now, JsVarFloat(void))
+JSW_CHECK_PROTOTYPE(jswrap_date_parse, JsVarFloat(JsVar *))
 static const JswSymPtr jswSymbols_httpCRs[] = {
   
 };
-static const unsigned char jswSymbolIndex_httpCRs = 31;
+#define jswSymbolIndex_httpCRs 31
 static const JswSymPtr jswSymbols_Pin_proto[] = {
   {0, (void (*)(void))jswrap_pin_read, JSWAT_BOOL | JSWAT_THIS_ARG},
   {5, (void (*)(void))jswrap_pin_reset, JSWAT_VOID | JSWAT_THIS_ARG},
@@ -889,32 +1117,43 @@ static const JswSymPtr jswSymbols_Pin_proto[] = {
   {15, (void (*)(void))jswrap_pin_write, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_BOOL << (JSWAT_BITS*1))},
   {21, (void (*)(void))jswrap_pin_writeAtTime, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_BOOL << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_Pin_proto = 32;
+#define jswSymbolIndex_Pin_proto 32
+JSW_CHECK_PROTOTYPE(jswrap_pin_read, bool(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pin_reset, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pin_set, void(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pin_write, void(JsVar *, bool))
+JSW_CHECK_PROTOTYPE(jswrap_pin_writeAtTime, void(JsVar *, bool, JsVarFloat))
 static const JswSymPtr jswSymbols_Waveform_proto[] = {
   {0, (void (*)(void))jswrap_waveform_startInput, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_PIN << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))},
   {11, (void (*)(void))jswrap_waveform_startOutput, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_PIN << (JSWAT_BITS*1)) | (JSWAT_JSVARFLOAT << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))},
   {23, (void (*)(void))jswrap_waveform_stop, JSWAT_VOID | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_Waveform_proto = 33;
+#define jswSymbolIndex_Waveform_proto 33
+JSW_CHECK_PROTOTYPE(jswrap_waveform_startInput, void(JsVar *, Pin, JsVarFloat, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_waveform_startOutput, void(JsVar *, Pin, JsVarFloat, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_waveform_stop, void(JsVar *))
 static const JswSymPtr jswSymbols_httpCRs_proto[] = {
   {0, (void (*)(void))jswrap_stream_available, JSWAT_INT32 | JSWAT_THIS_ARG},
   {10, (void (*)(void))jswrap_pipe, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {15, (void (*)(void))jswrap_stream_read, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_httpCRs_proto = 34;
+#define jswSymbolIndex_httpCRs_proto 34
+JSW_CHECK_PROTOTYPE(jswrap_stream_available, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pipe, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_stream_read, JsVar *(JsVar *, JsVarInt))
 static const JswSymPtr jswSymbols_httpSRs[] = {
   
 };
-static const unsigned char jswSymbolIndex_httpSRs = 35;
+#define jswSymbolIndex_httpSRs 35
 static const JswSymPtr jswSymbols_httpSrv_proto[] = {
   //{0, (void (*)(void))jswrap_net_server_close, JSWAT_VOID | JSWAT_THIS_ARG},
   //{6, (void (*)(void))jswrap_net_server_listen, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_httpSrv_proto = 36;
+#define jswSymbolIndex_httpSrv_proto 36
 static const JswSymPtr jswSymbols_url[] = {
   //{0, (void (*)(void))jswrap_url_parse, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_BOOL << (JSWAT_BITS*2))}
 };
-static const unsigned char jswSymbolIndex_url = 37;
+#define jswSymbolIndex_url 37
 static const JswSymPtr jswSymbols_SPI_proto[] = {
   {0, (void (*)(void))jswrap_spi_send, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_PIN << (JSWAT_BITS*2))},
   {5, (void (*)(void))jswrap_spi_send4bit, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2)) | (JSWAT_INT32 << (JSWAT_BITS*3)) | (JSWAT_PIN << (JSWAT_BITS*4))},
@@ -922,20 +1161,28 @@ static const JswSymPtr jswSymbols_SPI_proto[] = {
   {23, (void (*)(void))jswrap_spi_setup, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {29, (void (*)(void))jswrap_spi_write, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_SPI_proto = 38;
+#define jswSymbolIndex_SPI_proto 38
+JSW_CHECK_PROTOTYPE(jswrap_spi_send, JsVar *(JsVar *, JsVar *, Pin))
+JSW_CHECK_PROTOTYPE(jswrap_spi_send4bit, void(JsVar *, JsVar *, JsVarInt, JsVarInt, Pin))
+JSW_CHECK_PROTOTYPE(jswrap_spi_send8bit, void(JsVar *, JsVar *, JsVarInt, JsVarInt, Pin))
+JSW_CHECK_PROTOTYPE(jswrap_spi_setup, void(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_spi_write, void(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_String[] = {
   {0, (void (*)(void))jswrap_string_fromCharCode, JSWAT_JSVAR | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_String = 39;
+#define jswSymbolIndex_String 39
+JSW_CHECK_PROTOTYPE(jswrap_string_fromCharCode, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_SyntaxError_proto[] = {
   {0, (void (*)(void))jswrap_error_toString, JSWAT_JSVAR | JSWAT_THIS_ARG}
 };
-static const unsigned char jswSymbolIndex_SyntaxError_proto = 40;
+#define jswSymbolIndex_SyntaxError_proto 40
+JSW_CHECK_PROTOTYPE(jswrap_error_toString, JsVar *(JsVar *))
 static const JswSymPtr jswSymbols_net[] = {
   {0, (void (*)(void))gen_jswrap_net_connect, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   //{8, (void (*)(void))jswrap_net_createServer, JSWAT_JSVAR | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_net = 41;
+#define jswSymbolIndex_net 41
+JSW_CHECK_PROTOTYPE(gen_jswrap_net_connect, JsVar *(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_ArrayBufferView_proto[] = {
   {0, (void (*)(void))gen_jswrap_ArrayBufferView_buffer, JSWAT_JSVAR | JSWAT_THIS_ARG | JSWAT_EXECUTE_IMMEDIATELY},
   {7, (void (*)(void))gen_jswrap_ArrayBufferView_byteLength, JSWAT_INT32 | JSWAT_THIS_ARG | JSWAT_EXECUTE_IMMEDIATELY},
@@ -950,21 +1197,38 @@ static const JswSymPtr jswSymbols_ArrayBufferView_proto[] = {
   {74, (void (*)(void))jswrap_arraybufferview_set, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_INT32 << (JSWAT_BITS*2))},
   {78, (void (*)(void))jswrap_array_sort, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_ArrayBufferView_proto = 42;
+#define jswSymbolIndex_ArrayBufferView_proto 42
+JSW_CHECK_PROTOTYPE(gen_jswrap_ArrayBufferView_buffer, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_ArrayBufferView_byteLength, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_ArrayBufferView_byteOffset, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_fill, JsVar *(JsVar *, JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_forEach, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_indexOf, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_join, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_arraybufferview_map, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_reduce, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_reverse, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_arraybufferview_set, void(JsVar *, JsVar *, JsVarInt))
+JSW_CHECK_PROTOTYPE(jswrap_array_sort, JsVar *(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_Number_proto[] = {
   {0, (void (*)(void))jswrap_number_toFixed, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Number_proto = 43;
+#define jswSymbolIndex_Number_proto 43
+JSW_CHECK_PROTOTYPE(jswrap_number_toFixed, JsVar *(JsVar *, JsVarInt))
 static const JswSymPtr jswSymbols_httpSRq_proto[] = {
   {0, (void (*)(void))jswrap_stream_available, JSWAT_INT32 | JSWAT_THIS_ARG},
   {10, (void (*)(void))jswrap_pipe, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
   {15, (void (*)(void))jswrap_stream_read, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_INT32 << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_httpSRq_proto = 44;
+#define jswSymbolIndex_httpSRq_proto 44
+JSW_CHECK_PROTOTYPE(jswrap_stream_available, JsVarInt(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_pipe, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_stream_read, JsVar *(JsVar *, JsVarInt))
 static const JswSymPtr jswSymbols_console[] = {
   {0, (void (*)(void))jswrap_interface_print, JSWAT_VOID | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_console = 45;
+#define jswSymbolIndex_console 45
+JSW_CHECK_PROTOTYPE(jswrap_interface_print, void(JsVar *))
 static const JswSymPtr jswSymbols_Array_proto[] = {
   {0, (void (*)(void))jswrap_array_concat, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))},
   {7, (void (*)(void))jswrap_array_every, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2))},
@@ -987,18 +1251,41 @@ static const JswSymPtr jswSymbols_Array_proto[] = {
   {110, (void (*)(void))jswrap_object_toString, JSWAT_JSVAR | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   {119, (void (*)(void))jswrap_array_unshift, JSWAT_INT32 | JSWAT_THIS_ARG | (JSWAT_ARGUMENT_ARRAY << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_Array_proto = 46;
+#define jswSymbolIndex_Array_proto 46
+JSW_CHECK_PROTOTYPE(jswrap_array_concat, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_every, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_fill, JsVar *(JsVar *, JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_filter, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_forEach, void(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_indexOf, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_join, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_length, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_map, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(gen_jswrap_Array_pop, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_push, JsVarInt(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_reduce, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_reverse, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_shift, JsVar *(JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_slice, JsVar *(JsVar *, JsVarInt, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_some, JsVar *(JsVar *, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_sort, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_splice, JsVar *(JsVar *, JsVarInt, JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_object_toString, JsVar *(JsVar *, JsVar *))
+JSW_CHECK_PROTOTYPE(jswrap_array_unshift, JsVarInt(JsVar *, JsVar *))
 static const JswSymPtr jswSymbols_httpCRq_proto[] = {
   //{0, (void (*)(void))jswrap_net_socket_end, JSWAT_VOID | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))},
   //{4, (void (*)(void))jswrap_net_socket_write, JSWAT_BOOL | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 };
-static const unsigned char jswSymbolIndex_httpCRq_proto = 47;
+#define jswSymbolIndex_httpCRq_proto 47
 static const JswSymPtr jswSymbols_process[] = {
   {0, (void (*)(void))jswrap_process_env, JSWAT_JSVAR | JSWAT_EXECUTE_IMMEDIATELY},
   {4, (void (*)(void))jswrap_process_memory, JSWAT_JSVAR},
   {11, (void (*)(void))gen_jswrap_process_version, JSWAT_JSVAR | JSWAT_EXECUTE_IMMEDIATELY}
 };
-static const unsigned char jswSymbolIndex_process = 48;
+#define jswSymbolIndex_process 48
+JSW_CHECK_PROTOTYPE(jswrap_process_env, JsVar *(void))
+JSW_CHECK_PROTOTYPE(jswrap_process_memory, JsVar *(void))
+JSW_CHECK_PROTOTYPE(gen_jswrap_process_version, JsVar *(void))
 static const JswSymPtr jswSymbols_WLAN_proto[] = {
   /*
   {0, (void (*)(void))jswrap_wlan_connect, JSWAT_BOOL | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1)) | (JSWAT_JSVAR << (JSWAT_BITS*2)) | (JSWAT_JSVAR << (JSWAT_BITS*3))},
@@ -1008,18 +1295,18 @@ static const JswSymPtr jswSymbols_WLAN_proto[] = {
   {35, (void (*)(void))jswrap_wlan_setIP, JSWAT_BOOL | JSWAT_THIS_ARG | (JSWAT_JSVAR << (JSWAT_BITS*1))}
 	*/
 };
-static const unsigned char jswSymbolIndex_WLAN_proto = 49;
+#define jswSymbolIndex_WLAN_proto 49
 
 
 const JswSymList jswSymbolTables[] = {
   {jswSymbols_I2C_proto, 3, "readFrom\0setup\0writeTo\0"},
   {jswSymbols_Date_proto, 13, "getDate\0getDay\0getFullYear\0getHours\0getMilliseconds\0getMinutes\0getMonth\0getSeconds\0getTime\0getTimezoneOffset\0toString\0toUTCString\0valueOf\0"},
   {jswSymbols_Graphics, 2, "createArrayBuffer\0createCallback\0"},
-  {jswSymbols_E, 18, "FFT\0clip\0convolve\0dumpTimers\0enableWatchdog\0getAnalogVRef\0getErrorFlags\0getSizeOf\0getTemperature\0interpolate\0interpolate2d\0nativeCall\0reverseByte\0sum\0toArrayBuffer\0toString\0toUint8Array\0variance\0"},
+  {jswSymbols_E, 20, "FFT\0clip\0convolve\0dumpTimers\0enableWatchdog\0getAnalogVRef\0getErrorFlags\0getProfile\0getSizeOf\0getTemperature\0interpolate\0interpolate2d\0nativeCall\0reverseByte\0setProfile\0sum\0toArrayBuffer\0toString\0toUint8Array\0variance\0"},
   {jswSymbols_Server_proto, 2, "close\0listen\0"},
   {jswSymbols_Socket, 0, ""},
   {jswSymbols_String_proto, 12, "charAt\0charCodeAt\0indexOf\0lastIndexOf\0length\0replace\0slice\0split\0substr\0substring\0toLowerCase\0toUpperCase\0"},
-  {jswSymbols_OneWire_proto, 7, "read\0reset\0search\0search\0select\0skip\0write\0"},
+  {jswSymbols_OneWire_proto, 6, "read\0reset\0search\0select\0skip\0write\0"},
   {jswSymbols_Serial, 0, ""},
   {jswSymbols_httpSRs_proto, 3, "end\0write\0writeHead\0"},
   {jswSymbols_JSON, 2, "parse\0stringify\0"},
@@ -1065,173 +1352,148 @@ const JswSymList jswSymbolTables[] = {
 };
 
 
+/// No symbol list for this part of a class
+#define JSW_NO_SYMBOLS 255
+
+/// A class whose constructor is a native function
+typedef struct {
+  void (*constructor)(void);
+  unsigned char staticSymbols; ///< index in jswSymbolTables of the methods on the constructor itself
+  unsigned char protoSymbols; ///< index in jswSymbolTables of the methods on instances
+  bool isBasicType; ///< instances are basic types (eg. String) rather than Objects whose prototype has a 'constructor'
+} PACKED_FLAGS JswClass;
+
+static const JswClass jswClasses[] = {
+  {(void (*)(void))jswrap_array_constructor, jswSymbolIndex_Array, jswSymbolIndex_Array_proto, true},
+  {(void (*)(void))gen_jswrap_ArrayBufferView_ArrayBufferView, JSW_NO_SYMBOLS, jswSymbolIndex_ArrayBufferView_proto, true},
+  {(void (*)(void))gen_jswrap_CC3000_CC3000, jswSymbolIndex_CC3000, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))jswrap_date_constructor, jswSymbolIndex_Date, jswSymbolIndex_Date_proto, false},
+  {(void (*)(void))gen_jswrap_E_E, jswSymbolIndex_E, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))jswrap_error_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_Error_proto, false},
+  {(void (*)(void))jswrap_function_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_Function_proto, true},
+  {(void (*)(void))gen_jswrap_Graphics_Graphics, jswSymbolIndex_Graphics, jswSymbolIndex_Graphics_proto, false},
+  {(void (*)(void))gen_jswrap_I2C_I2C, JSW_NO_SYMBOLS, jswSymbolIndex_I2C_proto, false},
+  {(void (*)(void))jswrap_internalerror_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_InternalError_proto, false},
+  {(void (*)(void))gen_jswrap_JSON_JSON, jswSymbolIndex_JSON, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_Math_Math, jswSymbolIndex_Math, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_Modules_Modules, jswSymbolIndex_Modules, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_Nucleo_Nucleo, jswSymbolIndex_Nucleo, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))jswrap_number_constructor, jswSymbolIndex_Number, jswSymbolIndex_Number_proto, true},
+  {(void (*)(void))gen_jswrap_Object_Object, jswSymbolIndex_Object, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))jswrap_onewire_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_OneWire_proto, false},
+  {(void (*)(void))jswrap_pin_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_Pin_proto, true},
+  {(void (*)(void))jswrap_spi_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_SPI_proto, false},
+  {(void (*)(void))gen_jswrap_Serial_Serial, jswSymbolIndex_Serial, jswSymbolIndex_Serial_proto, false},
+  {(void (*)(void))gen_jswrap_Server_Server, JSW_NO_SYMBOLS, jswSymbolIndex_Server_proto, false},
+  {(void (*)(void))gen_jswrap_Socket_Socket, jswSymbolIndex_Socket, jswSymbolIndex_Socket_proto, false},
+  {(void (*)(void))jswrap_string_constructor, jswSymbolIndex_String, jswSymbolIndex_String_proto, true},
+  {(void (*)(void))jswrap_syntaxerror_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_SyntaxError_proto, false},
+  {(void (*)(void))gen_jswrap_WLAN_WLAN, JSW_NO_SYMBOLS, jswSymbolIndex_WLAN_proto, false},
+  {(void (*)(void))jswrap_waveform_constructor, JSW_NO_SYMBOLS, jswSymbolIndex_Waveform_proto, false},
+  {(void (*)(void))gen_jswrap_console_console, jswSymbolIndex_console, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_fs_fs, jswSymbolIndex_fs, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_http_http, jswSymbolIndex_http, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_httpCRq_httpCRq, jswSymbolIndex_httpCRq, jswSymbolIndex_httpCRq_proto, false},
+  {(void (*)(void))gen_jswrap_httpCRs_httpCRs, jswSymbolIndex_httpCRs, jswSymbolIndex_httpCRs_proto, false},
+  {(void (*)(void))gen_jswrap_httpSRq_httpSRq, jswSymbolIndex_httpSRq, jswSymbolIndex_httpSRq_proto, false},
+  {(void (*)(void))gen_jswrap_httpSRs_httpSRs, jswSymbolIndex_httpSRs, jswSymbolIndex_httpSRs_proto, false},
+  {(void (*)(void))gen_jswrap_httpSrv_httpSrv, JSW_NO_SYMBOLS, jswSymbolIndex_httpSrv_proto, false},
+  {(void (*)(void))gen_jswrap_net_net, jswSymbolIndex_net, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_process_process, jswSymbolIndex_process, JSW_NO_SYMBOLS, false},
+  {(void (*)(void))gen_jswrap_url_url, jswSymbolIndex_url, JSW_NO_SYMBOLS, false},
+};
+#define JSW_CLASS_COUNT (sizeof(jswClasses)/sizeof(JswClass))
+
+/* Function addresses aren't known until link time, so the hash table from
+ * constructor to class is filled in the first time it's needed. Each entry
+ * is an index into jswClasses plus one, or 0 if empty. */
+#define JSW_CLASS_HASH_SIZE 64 // power of 2, and comfortably more than JSW_CLASS_COUNT
+static unsigned char jswClassHash[JSW_CLASS_HASH_SIZE];
+static bool jswClassHashFilled = false;
+
+static unsigned int jswGetClassHash(void *constructor) {
+  size_t p = (size_t)constructor;
+  return (unsigned int)((p>>2) ^ (p>>8) ^ (p>>14)) & (JSW_CLASS_HASH_SIZE-1);
+}
+
+/// Find the class with the given native constructor, or 0
+static const JswClass *jswFindClass(void *constructor) {
+  unsigned int i, h;
+  if (!jswClassHashFilled) {
+    for (i=0;i<JSW_CLASS_COUNT;i++) {
+      h = jswGetClassHash((void*)jswClasses[i].constructor);
+      while (jswClassHash[h]) h = (h+1) & (JSW_CLASS_HASH_SIZE-1);
+      jswClassHash[h] = (unsigned char)(i+1);
+    }
+    jswClassHashFilled = true;
+  }
+  h = jswGetClassHash(constructor);
+  while (jswClassHash[h]) {
+    const JswClass *cls = &jswClasses[jswClassHash[h]-1];
+    if ((void*)cls->constructor == constructor) return cls;
+    h = (h+1) & (JSW_CLASS_HASH_SIZE-1);
+  }
+  return 0;
+}
+
+/// Find the class that made the given object (from its prototype's constructor), or 0
+static const JswClass *jswFindClassOfObject(JsVar *parent) {
+  JsVar *proto = jsvIsObject(parent)?jsvSkipNameAndUnLock(jsvFindChildFromString(parent, JSPARSE_INHERITS_VAR, false)):0;
+  JsVar *constructor = jsvIsObject(proto)?jsvSkipNameAndUnLock(jsvFindChildFromString(proto, JSPARSE_CONSTRUCTOR_VAR, false)):0;
+  jsvUnLock(proto);
+  const JswClass *cls = 0;
+  if (constructor && jsvIsNativeFunction(constructor))
+    cls = jswFindClass(constructor->varData.native.ptr);
+  jsvUnLock(constructor);
+  return (cls && !cls->isBasicType) ? cls : 0;
+}
+
+/// Return the instance methods for a basic type (eg. String or Array), or 0
+static const JswSymList *jswGetSymbolListForType(JsVar *parent) {
+  switch (parent->flags&JSV_VARTYPEMASK) {
+    case JSV_ARRAY: return &jswSymbolTables[jswSymbolIndex_Array_proto];
+    case JSV_ARRAYBUFFER:
+      if (parent->varData.arraybuffer.type==ARRAYBUFFERVIEW_ARRAYBUFFER) return 0;
+      return &jswSymbolTables[jswSymbolIndex_ArrayBufferView_proto];
+    case JSV_FUNCTION: return &jswSymbolTables[jswSymbolIndex_Function_proto];
+    case JSV_PIN: return &jswSymbolTables[jswSymbolIndex_Pin_proto];
+    case JSV_INTEGER:
+    case JSV_FLOAT:
+    case JSV_NAME_INT:
+    case JSV_NAME_INT_INT:
+    case JSV_NAME_INT_BOOL: return &jswSymbolTables[jswSymbolIndex_Number_proto];
+    default:
+      if (jsvIsString(parent)) return &jswSymbolTables[jswSymbolIndex_String_proto];
+      return 0;
+  }
+}
+
 JsVar *jswFindBuiltInFunction(JsVar *parent, const char *name) {
   JsVar *v;
   if (parent && !jsvIsRoot(parent)) {
-    // ------------------------------------------ INSTANCE + STATIC METHODS
+    // ------------------------------------------ STATIC METHODS
     if (jsvIsNativeFunction(parent)) {
-      if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Graphics_Graphics) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Graphics], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_E_E) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_E], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Socket_Socket) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Socket], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Serial_Serial) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Serial], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_JSON_JSON) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_JSON], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Modules_Modules) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Modules], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Object_Object) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Object], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_httpCRq_httpCRq) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpCRq], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_CC3000_CC3000) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_CC3000], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)jswrap_array_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Array], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)jswrap_number_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Number], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Math_Math) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Math], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_fs_fs) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_fs], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_http_http) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_http], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_Nucleo_Nucleo) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Nucleo], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_httpSRq_httpSRq) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpSRq], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)jswrap_date_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Date], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_httpCRs_httpCRs) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpCRs], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_httpSRs_httpSRs) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpSRs], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_url_url) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_url], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)jswrap_string_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_String], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_net_net) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_net], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_console_console) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_console], parent, name);
-        if (v) return v;
-      } else if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_process_process) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_process], parent, name);
+      const JswClass *cls = jswFindClass(parent->varData.native.ptr);
+      if (cls && cls->staticSymbols!=JSW_NO_SYMBOLS) {
+        v = jswBinarySearch(&jswSymbolTables[cls->staticSymbols], parent, name);
         if (v) return v;
       }
     }
-    if (jsvIsString(parent)) {
-      v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_String_proto], parent, name);
-      if (v) return v;
-    }
-    if (jsvIsFunction(parent)) {
-      v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Function_proto], parent, name);
+    // ------------------------------------------ INSTANCE METHODS OF BASIC TYPES
+    const JswSymList *symbols = jswGetSymbolListForType(parent);
+    if (symbols) {
+      v = jswBinarySearch(symbols, parent, name);
       if (v) return v;
     }
-    if (jsvIsPin(parent)) {
-      v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Pin_proto], parent, name);
-      if (v) return v;
-    }
-    if (jsvIsArrayBuffer(parent) && parent->varData.arraybuffer.type!=ARRAYBUFFERVIEW_ARRAYBUFFER) {
-      v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_ArrayBufferView_proto], parent, name);
-      if (v) return v;
-    }
-    if (jsvIsInt(parent) || jsvIsFloat(parent)) {
+    if (jsvIsPin(parent)) { // pins are numbers too
       v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Number_proto], parent, name);
       if (v) return v;
     }
-    if (jsvIsArray(parent)) {
-      v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Array_proto], parent, name);
-      if (v) return v;
-    }
     // ------------------------------------------ INSTANCE METHODS WE MUST CHECK CONSTRUCTOR FOR
-    JsVar *proto = jsvIsObject(parent)?jsvSkipNameAndUnLock(jsvFindChildFromString(parent, JSPARSE_INHERITS_VAR, false)):0;
-    JsVar *constructor = jsvIsObject(proto)?jsvSkipNameAndUnLock(jsvFindChildFromString(proto, JSPARSE_CONSTRUCTOR_VAR, false)):0;
-    jsvUnLock(proto);
-    if (constructor && jsvIsNativeFunction(constructor)) {
-      void *constructorPtr = constructor->varData.native.ptr;
-      jsvUnLock(constructor);
-      if (constructorPtr==(void*)gen_jswrap_I2C_I2C) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_I2C_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_date_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Date_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_Server_Server) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Server_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_onewire_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_OneWire_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_httpSRs_httpSRs) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpSRs_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_error_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Error_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_Serial_Serial) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Serial_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_Graphics_Graphics) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Graphics_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_internalerror_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_InternalError_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_Socket_Socket) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Socket_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_waveform_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Waveform_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_httpCRs_httpCRs) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpCRs_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_httpSrv_httpSrv) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpSrv_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_spi_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_SPI_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)jswrap_syntaxerror_constructor) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_SyntaxError_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_httpSRq_httpSRq) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpSRq_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_httpCRq_httpCRq) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_httpCRq_proto], parent, name);
-        if (v) return v;
-      } else if (constructorPtr==(void*)gen_jswrap_WLAN_WLAN) {
-        v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_WLAN_proto], parent, name);
-        if (v) return v;
-      }
-    } else {
-      jsvUnLock(constructor);
+    const JswClass *cls = jswFindClassOfObject(parent);
+    if (cls && cls->protoSymbols!=JSW_NO_SYMBOLS) {
+      v = jswBinarySearch(&jswSymbolTables[cls->protoSymbols], parent, name);
+      if (v) return v;
     }
     // ------------------------------------------ METHODS ON OBJECT
     v = jswBinarySearch(&jswSymbolTables[jswSymbolIndex_Object_proto], parent, name);
@@ -1250,118 +1512,48 @@ JsVar *jswFindBuiltInFunction(JsVar *parent, const char *name) {
 
 
 const JswSymList *jswGetSymbolListForObject(JsVar *parent) {
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Graphics_Graphics) return &jswSymbolTables[jswSymbolIndex_Graphics];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_E_E) return &jswSymbolTables[jswSymbolIndex_E];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Socket_Socket) return &jswSymbolTables[jswSymbolIndex_Socket];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Serial_Serial) return &jswSymbolTables[jswSymbolIndex_Serial];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_JSON_JSON) return &jswSymbolTables[jswSymbolIndex_JSON];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Modules_Modules) return &jswSymbolTables[jswSymbolIndex_Modules];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Object_Object) return &jswSymbolTables[jswSymbolIndex_Object];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_httpCRq_httpCRq) return &jswSymbolTables[jswSymbolIndex_httpCRq];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_CC3000_CC3000) return &jswSymbolTables[jswSymbolIndex_CC3000];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)jswrap_array_constructor) return &jswSymbolTables[jswSymbolIndex_Array];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)jswrap_number_constructor) return &jswSymbolTables[jswSymbolIndex_Number];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Math_Math) return &jswSymbolTables[jswSymbolIndex_Math];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_fs_fs) return &jswSymbolTables[jswSymbolIndex_fs];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_http_http) return &jswSymbolTables[jswSymbolIndex_http];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_Nucleo_Nucleo) return &jswSymbolTables[jswSymbolIndex_Nucleo];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_httpSRq_httpSRq) return &jswSymbolTables[jswSymbolIndex_httpSRq];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)jswrap_date_constructor) return &jswSymbolTables[jswSymbolIndex_Date];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_httpCRs_httpCRs) return &jswSymbolTables[jswSymbolIndex_httpCRs];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_httpSRs_httpSRs) return &jswSymbolTables[jswSymbolIndex_httpSRs];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_url_url) return &jswSymbolTables[jswSymbolIndex_url];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)jswrap_string_constructor) return &jswSymbolTables[jswSymbolIndex_String];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_net_net) return &jswSymbolTables[jswSymbolIndex_net];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_console_console) return &jswSymbolTables[jswSymbolIndex_console];
-  if (jsvIsNativeFunction(parent) && (void*)parent->varData.native.ptr==(void*)gen_jswrap_process_process) return &jswSymbolTables[jswSymbolIndex_process];
-  return 0;
+  if (!jsvIsNativeFunction(parent)) return 0;
+  const JswClass *cls = jswFindClass(parent->varData.native.ptr);
+  if (!cls || cls->staticSymbols==JSW_NO_SYMBOLS) return 0;
+  return &jswSymbolTables[cls->staticSymbols];
 }
 
 
 const JswSymList *jswGetSymbolListForObjectProto(JsVar *parent) {
   if (jsvIsNativeFunction(parent)) {
-    if ((void*)parent->varData.native.ptr==(void*)jswrap_string_constructor) return &jswSymbolTables[jswSymbolIndex_String_proto];
-    if ((void*)parent->varData.native.ptr==(void*)jswrap_function_constructor) return &jswSymbolTables[jswSymbolIndex_Function_proto];
-    if ((void*)parent->varData.native.ptr==(void*)jswrap_pin_constructor) return &jswSymbolTables[jswSymbolIndex_Pin_proto];
-    if ((void*)parent->varData.native.ptr==(void*)gen_jswrap_ArrayBufferView_ArrayBufferView) return &jswSymbolTables[jswSymbolIndex_ArrayBufferView_proto];
-    if ((void*)parent->varData.native.ptr==(void*)jswrap_number_constructor) return &jswSymbolTables[jswSymbolIndex_Number_proto];
-    if ((void*)parent->varData.native.ptr==(void*)jswrap_array_constructor) return &jswSymbolTables[jswSymbolIndex_Array_proto];
+    const JswClass *cls = jswFindClass(parent->varData.native.ptr);
+    if (cls && cls->isBasicType) return &jswSymbolTables[cls->protoSymbols];
   }
   JsVar *constructor = jsvIsObject(parent)?jsvSkipNameAndUnLock(jsvFindChildFromString(parent, JSPARSE_CONSTRUCTOR_VAR, false)):0;
   if (constructor && jsvIsNativeFunction(constructor)) {
-    void *constructorPtr = constructor->varData.native.ptr;
-   jsvUnLock(constructor);
-    if (constructorPtr==(void*)gen_jswrap_I2C_I2C) return &jswSymbolTables[jswSymbolIndex_I2C_proto];
-    if (constructorPtr==(void*)jswrap_date_constructor) return &jswSymbolTables[jswSymbolIndex_Date_proto];
-    if (constructorPtr==(void*)gen_jswrap_Server_Server) return &jswSymbolTables[jswSymbolIndex_Server_proto];
-    if (constructorPtr==(void*)jswrap_onewire_constructor) return &jswSymbolTables[jswSymbolIndex_OneWire_proto];
-    if (constructorPtr==(void*)gen_jswrap_httpSRs_httpSRs) return &jswSymbolTables[jswSymbolIndex_httpSRs_proto];
-    if (constructorPtr==(void*)jswrap_error_constructor) return &jswSymbolTables[jswSymbolIndex_Error_proto];
-    if (constructorPtr==(void*)gen_jswrap_Serial_Serial) return &jswSymbolTables[jswSymbolIndex_Serial_proto];
-    if (constructorPtr==(void*)gen_jswrap_Graphics_Graphics) return &jswSymbolTables[jswSymbolIndex_Graphics_proto];
-    if (constructorPtr==(void*)jswrap_internalerror_constructor) return &jswSymbolTables[jswSymbolIndex_InternalError_proto];
-    if (constructorPtr==(void*)gen_jswrap_Socket_Socket) return &jswSymbolTables[jswSymbolIndex_Socket_proto];
-    if (constructorPtr==(void*)jswrap_waveform_constructor) return &jswSymbolTables[jswSymbolIndex_Waveform_proto];
-    if (constructorPtr==(void*)gen_jswrap_httpCRs_httpCRs) return &jswSymbolTables[jswSymbolIndex_httpCRs_proto];
-    if (constructorPtr==(void*)gen_jswrap_httpSrv_httpSrv) return &jswSymbolTables[jswSymbolIndex_httpSrv_proto];
-    if (constructorPtr==(void*)jswrap_spi_constructor) return &jswSymbolTables[jswSymbolIndex_SPI_proto];
-    if (constructorPtr==(void*)jswrap_syntaxerror_constructor) return &jswSymbolTables[jswSymbolIndex_SyntaxError_proto];
-    if (constructorPtr==(void*)gen_jswrap_httpSRq_httpSRq) return &jswSymbolTables[jswSymbolIndex_httpSRq_proto];
-    if (constructorPtr==(void*)gen_jswrap_httpCRq_httpCRq) return &jswSymbolTables[jswSymbolIndex_httpCRq_proto];
-    if (constructorPtr==(void*)gen_jswrap_WLAN_WLAN) return &jswSymbolTables[jswSymbolIndex_WLAN_proto];
+    const JswClass *cls = jswFindClass(constructor->varData.native.ptr);
+    jsvUnLock(constructor);
+    if (cls && !cls->isBasicType && cls->protoSymbols!=JSW_NO_SYMBOLS) return &jswSymbolTables[cls->protoSymbols];
   }
   return &jswSymbolTables[jswSymbolIndex_Object_proto];
 }
 
 
+/// Names of built-in objects, sorted for jswIsBuiltInObject
+static const char *const jswBuiltInObjects[] = {
+  "Array", "ArrayBuffer", "ArrayBufferView", "Boolean", "Date", "E", "Error", "Float32Array", "Float64Array",
+  "Function", "Graphics", "Hardware", "I2C", "Int16Array", "Int32Array", "Int8Array", "InternalError", "JSON",
+  "Math", "Modules", "Nucleo", "Number", "Object", "OneWire", "Pin", "SPI", "Serial", "Server", "Socket",
+  "String", "SyntaxError", "Uint16Array", "Uint32Array", "Uint8Array", "Uint8ClampedArray", "WLAN", "Waveform",
+  "console", "fs", "httpCRq", "httpCRs", "httpSRq", "httpSRs", "httpSrv", "process", "url",
+};
+
 bool jswIsBuiltInObject(const char *name) {
-  return
-strcmp(name, "Array")==0 ||
-    strcmp(name, "ArrayBuffer")==0 ||
-    strcmp(name, "ArrayBufferView")==0 ||
-    strcmp(name, "Uint8Array")==0 ||
-    strcmp(name, "Uint8ClampedArray")==0 ||
-    strcmp(name, "Int8Array")==0 ||
-    strcmp(name, "Uint16Array")==0 ||
-    strcmp(name, "Int16Array")==0 ||
-    strcmp(name, "Uint32Array")==0 ||
-    strcmp(name, "Int32Array")==0 ||
-    strcmp(name, "Float32Array")==0 ||
-    strcmp(name, "Float64Array")==0 ||
-    strcmp(name, "Date")==0 ||
-    strcmp(name, "Error")==0 ||
-    strcmp(name, "SyntaxError")==0 ||
-    strcmp(name, "InternalError")==0 ||
-    strcmp(name, "E")==0 ||
-    strcmp(name, "Function")==0 ||
-    strcmp(name, "console")==0 ||
-    strcmp(name, "JSON")==0 ||
-    strcmp(name, "Modules")==0 ||
-    strcmp(name, "Number")==0 ||
-    strcmp(name, "Hardware")==0 ||
-    strcmp(name, "Object")==0 ||
-    strcmp(name, "Boolean")==0 ||
-    strcmp(name, "OneWire")==0 ||
-    strcmp(name, "Pin")==0 ||
-    strcmp(name, "fs")==0 ||
-    strcmp(name, "process")==0 ||
-    strcmp(name, "Serial")==0 ||
-    strcmp(name, "SPI")==0 ||
-    strcmp(name, "I2C")==0 ||
-    strcmp(name, "String")==0 ||
-    strcmp(name, "Waveform")==0 ||
-    strcmp(name, "Math")==0 ||
-    strcmp(name, "Graphics")==0 ||
-    strcmp(name, "url")==0 ||
-    strcmp(name, "Server")==0 ||
-    strcmp(name, "Socket")==0 ||
-    strcmp(name, "httpSrv")==0 ||
-    strcmp(name, "httpSRq")==0 ||
-    strcmp(name, "httpSRs")==0 ||
-    strcmp(name, "httpCRq")==0 ||
-    strcmp(name, "httpCRs")==0 ||
-    strcmp(name, "WLAN")==0 ||
-    strcmp(name, "Nucleo")==0;
+  int searchMin = 0;
+  int searchMax = (int)(sizeof(jswBuiltInObjects)/sizeof(const char*)) - 1;
+  while (searchMin <= searchMax) {
+    int idx = (searchMin+searchMax) >> 1;
+    int cmp = strcmp(name, jswBuiltInObjects[idx]);
+    if (cmp==0) return true;
+    if (cmp<0) searchMax = idx-1;
+    else searchMin = idx+1;
+  }
+  return false;
 }
 
 
@@ -55,6 +55,19 @@ typedef struct {
   const char *symbolChars;
 } PACKED_FLAGS JswSymList;
 
+/** jsnCallFunction calls built-in functions through a prototype made from
+ * their argument specifier, so a function whose real C prototype doesn't
+ * match gets garbage arguments. The generated symbol tables use this to make
+ * that a compile error. Only checked on Linux with GCC, where int32_t is int
+ * so JSWAT_INT32 arguments can be declared as either. */
+#if defined(__GNUC__) && defined(LINUX)
+#define JSW_CHECK_PROTOTYPE_NAME2(FN, LINE) jswPrototypeMismatch_##FN##_##LINE
+#define JSW_CHECK_PROTOTYPE_NAME(FN, LINE) JSW_CHECK_PROTOTYPE_NAME2(FN, LINE)
+#define JSW_CHECK_PROTOTYPE(FN, TYPE) typedef char JSW_CHECK_PROTOTYPE_NAME(FN, __LINE__)[__builtin_types_compatible_p(__typeof__(FN), TYPE) ? 1 : -1];
+#else
+#define JSW_CHECK_PROTOTYPE(FN, TYPE)
+#endif
+
 /// Do a binary search of the symbol table list
 JsVar *jswBinarySearch(const JswSymList *symbolsPtr, JsVar *parent, const char *name);
 
@@ -12,7 +12,14 @@
 #define SYSTICKS_BEFORE_USB_DISCONNECT 2
 */
 
-#ifdef TARGET_NRF51822
+#ifdef LINUX
+// Host build (targets/linux) - RAM_TOTAL can be set to match a board's number of vars
+#ifndef RAM_TOTAL
+#define RAM_TOTAL (128*1024)
+#endif
+#define FLASH_TOTAL (512*1024)
+
+#elif TARGET_NRF51822
 #define RAM_TOTAL (0x2000)
 #define FLASH_TOTAL (0x2A000)
 #define HASNOOPENDRAIN
@@ -140,8 +147,9 @@
 #define IOBUFFER_XON ((TXBUFFERMASK)*3/8)
 
 #define IOBUFFERMASK ((RAM_TOTAL < 20 * 1024 ? 64:128) - 1) // amount of items in event buffer
-#define TXBUFFERMASK ((RAM_TOTAL < 20  * 1024 ? 32:128) - 1)
+#define TXBUFFERMASK ((RAM_TOTAL < 20  * 1024 ? 32:128) - 1) // size of the transmit buffer (for each serial device)
 #define UTILTIMERTASK_TASKS (RAM_TOTAL < 20 * 1024 ? 4:16)
+#define EVENTQUEUE_SLOTS (RAM_TOTAL < 20 * 1024 ? 32:128) // var references in the JS event queue - each event uses 3 + its argument count
 
 
 
@@ -0,0 +1,31 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Pin names for the simulated board used by the Linux host build (this
+ * stands in for the PinNames.h that mbed provides for each target)
+ * ----------------------------------------------------------------------------
+ */
+#ifndef MBED_PINNAMES_H
+#define MBED_PINNAMES_H
+
+typedef enum {
+	D0, D1, D2, D3, D4, D5, D6, D7,
+	D8, D9, D10, D11, D12, D13, D14, D15,
+	A0, A1, A2, A3, A4, A5,
+	LED1,
+	USBTX,
+	USBRX,
+	PIN_COUNT, ///< Number of simulated pins
+
+	// Not connected
+	NC = (int)0xFFFFFFFF
+} PinName;
+
+#endif // MBED_PINNAMES_H
@@ -0,0 +1,513 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Hardware interface Layer for the Linux host build. Peripherals are
+ * simulated so the interpreter can be run (and benchmarked) without a board:
+ *
+ *  - Pins keep their state/value in RAM. Changing the value of a watched pin
+ *    raises the EXTI event, so digitalWrite on a watched pin injects an edge.
+ *  - EV_STDIOSERIAL is stdin/stdout. Other serial ports are looped back
+ *    (what is transmitted is received), as is SPI. Each I2C device is a FIFO
+ *    that writes fill and reads drain.
+ *  - Flash is a file (ESPRUINO_FLASH, or "espruino.flash") that save() dumps
+ *    the variable store into.
+ *  - Signals stand in for IRQs: SIGALRM (from a one-shot ITIMER_REAL) is the
+ *    utility timer and SIGIO is console input. jshInterruptOff just sets a
+ *    flag - an IRQ that arrives while it's set is run by jshInterruptOn.
+ * ----------------------------------------------------------------------------
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <sys/select.h>
+
+#include "jstimer.h"
+#include "jshardware.h"
+#include "jsutils.h"
+#include "jsparse.h"
+#include "jsinteractive.h"
+#include "jshost.h"
+
+#define FLASH_MAGIC 0xDEADBEEF
+#define FLASH_DEFAULT_FILE "espruino.flash"
+
+typedef struct {
+	JshPinState state;
+	bool value;
+	bool isStateManual;
+	bool watched;
+	JsVarFloat analog; ///< last value written with analogWrite
+	JshEventCallbackCallback callback;
+} jsSimPin;
+
+typedef struct {
+	unsigned char data[256];
+	unsigned char head, tail;
+} jsSimI2C;
+
+static jsSimPin simPins[PIN_COUNT];
+static jsSimI2C simI2Cs[I2CSNUM];
+static JshSerialDeviceState simSerialStates[EV_SERIAL_MAX+1-EV_SERIAL_START];
+static uint64_t DEVICE_INITIALISED_FLAGS = 0;
+
+static JsSysTime systemTimeOffset = 0;
+static volatile bool stdinClosed = false;
+
+static volatile sig_atomic_t interruptsDisabled = 0;
+// 'IRQs' that have been signalled but not run yet
+static volatile sig_atomic_t utilTimerPending = 0;
+static volatile sig_atomic_t stdinPending = 0;
+
+static bool jshIsSimPin(Pin pin) {
+	return (unsigned int)pin < PIN_COUNT;
+}
+
+// ---------------------------------------------------------------------- IRQS
+/// Read whatever is waiting on stdin into the console's input queue - the 'UART RX IRQ'
+static void jshStdinIRQ() {
+	unsigned char buf[IOEVENT_MAXCHARS];
+	ssize_t i, n;
+	if (stdinClosed) return;
+	while ((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+		for (i=0;i<n;i++) {
+			// Ctrl-C again before the idle loop saw the first one - JS is busy, so interrupt it
+			if (buf[i]==3 && (execInfo.execute & EXEC_CTRL_C)) {
+				execInfo.execute &= (JsExecFlags)~EXEC_CTRL_C_MASK;
+				jspSetInterrupted(true);
+			} else
+				jshPushIOCharEvent(EV_STDIOSERIAL, (char)buf[i]);
+		}
+		if (jshGetEventsUsed() > IOBUFFER_XOFF) return; // leave the rest for jshIdle
+	}
+	if (n == 0) stdinClosed = true;
+}
+
+/// Run any pending 'IRQs' - with 'interrupts' off, as they would be on a board
+static void jshRunPendingIRQs() {
+	do {
+		interruptsDisabled = 1;
+		while (utilTimerPending || stdinPending) {
+			if (utilTimerPending) {
+				utilTimerPending = 0;
+				jstUtilTimerInterruptHandler();
+			}
+			if (stdinPending) {
+				stdinPending = 0;
+				jshStdinIRQ();
+			}
+		}
+		interruptsDisabled = 0;
+	} while (utilTimerPending || stdinPending); // signalled just as we finished
+}
+
+static void jshSignalHandler(int sig) {
+	if (sig == SIGALRM)
+		utilTimerPending = 1;
+	else
+		stdinPending = 1;
+	if (!interruptsDisabled)
+		jshRunPendingIRQs();
+}
+
+// ---------------------------------------------------------------- UTIL TIMER
+
+static void jshUtilTimerSet(JsSysTime period) {
+	struct itimerval t;
+	t.it_interval.tv_sec = 0;
+	t.it_interval.tv_usec = 0;
+	if (period < 1) period = 1; // a zero it_value would disarm the timer
+	t.it_value.tv_sec = (time_t)(period / 1000000);
+	t.it_value.tv_usec = (suseconds_t)(period % 1000000);
+	setitimer(ITIMER_REAL, &t, 0);
+}
+
+// ---------------------------------------------------------------------- PINS
+bool jshGetPinStateIsManual(Pin pin) {
+	return jshIsSimPin(pin) && simPins[pin].isStateManual;
+}
+
+void jshSetPinStateIsManual(Pin pin, bool manual) {
+	if (jshIsSimPin(pin))
+		simPins[pin].isStateManual = manual;
+}
+
+void jshPinSetState(Pin pin, JshPinState state) {
+	if (jshIsSimPin(pin))
+		simPins[pin].state = state;
+}
+
+JshPinState jshPinGetState(Pin pin) {
+	if (!jshIsSimPin(pin)) return JSHPINSTATE_UNDEFINED;
+	JshPinState state = simPins[pin].state;
+	if (JSHPINSTATE_IS_OUTPUT(state) && simPins[pin].value)
+		state |= JSHPINSTATE_PIN_IS_ON;
+	return state;
+}
+
+void jshPinSetValue(Pin pin, bool value) {
+	if (!jshIsSimPin(pin)) return;
+	bool changed = simPins[pin].value != value;
+	simPins[pin].value = value;
+	// a watched pin that changes is an edge - raise EXTI as the hardware would
+	if (changed && simPins[pin].watched)
+		jshPushIOWatchEvent(EV_EXTI, pin);
+}
+
+bool jshPinGetValue(Pin pin) {
+	return jshIsSimPin(pin) && simPins[pin].value;
+}
+
+JsVarFloat jshPinAnalog(Pin pin) {
+	if (!jshIsSimPin(pin)) return NAN;
+	if (simPins[pin].state == JSHPINSTATE_AF_OUT)
+		return simPins[pin].analog; // read back what analogWrite set
+	return simPins[pin].value ? 1 : 0;
+}
+
+int jshPinAnalogFast(Pin pin) {
+	return jshPinGetValue(pin) ? 65535 : 0;
+}
+
+void jshPinAnalogOutput(Pin pin, JsVarFloat value, JsVarFloat freq) { // if freq<=0, the default is used
+	NOT_USED(freq);
+	if (!jshIsSimPin(pin)) return;
+	if (!jshGetPinStateIsManual(pin))
+		jshPinSetState(pin, JSHPINSTATE_AF_OUT);
+	simPins[pin].analog = value;
+	jshPinSetValue(pin, value >= 0.5);
+}
+
+void jshPinPulse(Pin pin, bool pulsePolarity, JsVarFloat pulseTime) {
+	if (!jshIsPinValid(pin)) {
+		jsExceptionHere(JSET_ERROR, "Invalid pin!");
+		return;
+	}
+	if (pulseTime<=0) {
+		// just wait for everything to complete
+		jstUtilTimerWaitEmpty();
+		return;
+	} else {
+		// find out if we already had a timer scheduled
+		UtilTimerTask task;
+		if (!jstGetLastPinTimerTask(pin, &task)) {
+			// no timer - just start the pulse now!
+			jshPinOutput(pin, pulsePolarity);
+			task.time = jshGetSystemTime();
+		}
+		// Now set the end of the pulse to happen on a timer
+		jstPinOutputAtTime(task.time + jshGetTimeFromMilliseconds(pulseTime), &pin, 1, !pulsePolarity);
+	}
+}
+
+JshPinFunction jshGetCurrentPinFunction(Pin pin) {
+	NOT_USED(pin);
+	return (JshPinFunction)0;
+}
+
+void jshSetOutputValue(JshPinFunction func, int value) {
+	NOT_USED(func);
+	NOT_USED(value);
+}
+
+/// Set a callback function to be called when an event occurs
+void jshSetEventCallback(Pin pin, JshEventCallbackCallback callback) {
+	if (jshIsSimPin(pin))
+		simPins[pin].callback = callback;
+}
+
+bool callWatchPinEventCallback(Pin pin,bool state) {
+	if (jshIsSimPin(pin) && simPins[pin].callback) {
+		simPins[pin].callback(state);
+		return true;
+	}
+	return false;
+}
+
+IOEventFlags jshPinWatch(Pin pin, bool shouldWatch) {
+	if (!jshIsSimPin(pin)) {
+		jsExceptionHere(JSET_ERROR, "Invalid pin!");
+		return EV_NONE;
+	}
+	if (shouldWatch && !jshGetPinStateIsManual(pin))
+		jshPinSetState(pin, JSHPINSTATE_GPIO_IN_PULLUP);
+	simPins[pin].watched = shouldWatch;
+	return (IOEventFlags)(~(EV_EXTI + pin) + 1);
+}
+
+// ------------------------------------------------------------------- DEVICES
+void jshSetDeviceInitialised(IOEventFlags device, bool isInit) {
+	uint64_t mask = 1ULL << (int)device;
+	if (isInit)
+		DEVICE_INITIALISED_FLAGS |= mask;
+	else
+		DEVICE_INITIALISED_FLAGS &= ~mask;
+}
+
+bool jshIsDeviceInitialised(IOEventFlags device) {
+	uint64_t mask = 1ULL << (int)device;
+	return (DEVICE_INITIALISED_FLAGS & mask) != 0L;
+}
+
+JshSerialDeviceState *getSerialDeviceStates(IOEventFlags device) {
+	if (!DEVICE_IS_USART(device)) return 0;
+	return &simSerialStates[device-EV_SERIAL_START];
+}
+
+void jshResetSerial() {
+	memset(simSerialStates, 0, sizeof(simSerialStates));
+}
+
+void jshUSARTSetup(IOEventFlags device, JshUSARTInfo *inf) {
+	NOT_USED(inf);
+	jshSetDeviceInitialised(device, true);
+}
+
+/** Kick a device into action (if required). The console goes to stdout,
+ * anything else is received straight back as if TX were wired to RX */
+void jshUSARTKick(IOEventFlags device) {
+	int c;
+	while ((c = jshGetCharToTransmit(device)) >= 0) {
+		if (device == EV_STDIOSERIAL || device == EV_USBSERIAL)
+			fputc(c, stdout);
+		else
+			jshPushIOCharEvent(device, (char)c);
+	}
+	if (device == EV_STDIOSERIAL || device == EV_USBSERIAL)
+		fflush(stdout);
+}
+
+void jshSPISetup(IOEventFlags device, JshSPIInfo *inf) {
+	NOT_USED(inf);
+	jshSetDeviceInitialised(device, true);
+}
+
+/** Send data through the given SPI device (if data>=0), and return the result
+ * of the previous send (or -1). MISO is wired to MOSI, so this is the data sent */
+int jshSPISend(IOEventFlags device, int data) {
+	NOT_USED(device);
+	return data;
+}
+
+void jshSPIWait(IOEventFlags device) {
+	NOT_USED(device);
+}
+
+void jshSPISet16(IOEventFlags device, bool is16) {
+	NOT_USED(device);
+	NOT_USED(is16);
+}
+
+void jshSPISend16(IOEventFlags device, int data) {
+	NOT_USED(device);
+	NOT_USED(data);
+}
+
+void jshI2CSetup(IOEventFlags device, JshI2CInfo *inf) {
+	NOT_USED(inf);
+	if (!DEVICE_IS_I2C(device)) return;
+	jsSimI2C *i2c = &simI2Cs[device-EV_I2C0];
+	i2c->head = i2c->tail = 0;
+	jshSetDeviceInitialised(device, true);
+}
+
+void jshI2CWrite(IOEventFlags device, unsigned char address, int nBytes, const unsigned char *data, bool sendStop) {
+	NOT_USED(address);
+	NOT_USED(sendStop);
+	if (!DEVICE_IS_I2C(device)) return;
+	jsSimI2C *i2c = &simI2Cs[device-EV_I2C0];
+	int i;
+	for (i=0;i<nBytes;i++) {
+		unsigned char nextHead = (unsigned char)(i2c->head+1);
+		if (nextHead == i2c->tail) break; // full - drop the rest
+		i2c->data[i2c->head] = data[i];
+		i2c->head = nextHead;
+	}
+}
+
+void jshI2CRead(IOEventFlags device, unsigned char address, int nBytes, unsigned char *data, bool sendStop) {
+	NOT_USED(address);
+	NOT_USED(sendStop);
+	if (!DEVICE_IS_I2C(device)) return;
+	jsSimI2C *i2c = &simI2Cs[device-EV_I2C0];
+	int i;
+	for (i=0;i<nBytes;i++) {
+		if (i2c->tail == i2c->head) {
+			data[i] = 0xFF; // nothing there - the bus is pulled up
+		} else {
+			data[i] = i2c->data[i2c->tail];
+			i2c->tail++;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------- MAIN
+void jshInit() {
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = jshSignalHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, 0);
+	sigaction(SIGIO, &sa, 0);
+	// stdin raises SIGIO when there's data (so Ctrl-C can interrupt running code), and mustn't block
+	fcntl(STDIN_FILENO, F_SETOWN, getpid());
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK | O_ASYNC);
+	jshReset();
+}
+
+void jshReset() {
+	jshUtilTimerDisable();
+	DEVICE_INITIALISED_FLAGS = 0;
+	memset(simPins, 0, sizeof(simPins));
+	memset(simI2Cs, 0, sizeof(simI2Cs));
+	jshResetSerial();
+}
+
+void jshIdle() {
+	jsiSetConsoleDevice(DEFAULT_CONSOLE_DEVICE);
+	// SIGIO only comes when more data arrives, so pick up anything left behind
+	jshInterruptOff();
+	jshStdinIRQ();
+	jshInterruptOn();
+}
+
+bool jshIsStdinClosed() {
+	return stdinClosed;
+}
+
+int jshGetSerialNumber(unsigned char *data, int maxChars) {
+	long id = gethostid();
+	int i;
+	for (i=0;i<maxChars && i<(int)sizeof(id);i++)
+		data[i] = (unsigned char)(id >> (i*8));
+	return i;
+}
+
+bool jshIsUSBSERIALConnected() {
+	return false;
+}
+
+void jshInterruptOff() {
+	interruptsDisabled = 1;
+}
+
+void jshInterruptOn() {
+	interruptsDisabled = 0;
+	if (utilTimerPending || stdinPending)
+		jshRunPendingIRQs();
+}
+
+void jshDelayMicroseconds(int microsec) {
+	JsSysTime end = jshGetSystemTime() + microsec;
+	while (jshGetSystemTime() < end); // busy wait, like the hardware
+}
+
+void jshEnableWatchDog(JsVarFloat timeout) {
+	NOT_USED(timeout);
+}
+
+// ---------------------------------------------------------------------- TIME
+JsSysTime jshGetTimeFromMilliseconds(JsVarFloat ms) {
+	return (JsSysTime)(ms*1000);
+}
+
+JsVarFloat jshGetMillisecondsFromTime(JsSysTime time) {
+	return ((JsVarFloat)time)/1000;
+}
+
+JsSysTime jshGetSystemTime() {
+	struct timespec ts; // clock_gettime is safe to call from the SIGALRM handler
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (JsSysTime)ts.tv_sec*1000000 + ts.tv_nsec/1000 + systemTimeOffset;
+}
+
+void jshSetSystemTime(JsSysTime time) {
+	systemTimeOffset = 0;
+	systemTimeOffset = time - jshGetSystemTime();
+}
+
+/// Enter simple sleep mode (woken up by console input or a signal). Returns true on success
+bool jshSleep(JsSysTime timeUntilWake) {
+	if (timeUntilWake <= 0) return true;
+	if (timeUntilWake > 1000000) timeUntilWake = 1000000; // so jshIdle gets called
+	fd_set fds;
+	FD_ZERO(&fds);
+	if (!stdinClosed) FD_SET(STDIN_FILENO, &fds); // at EOF it would always be readable
+	struct timeval tv;
+	tv.tv_sec = (time_t)(timeUntilWake / 1000000);
+	tv.tv_usec = (suseconds_t)(timeUntilWake % 1000000);
+	select(STDIN_FILENO+1, &fds, 0, 0, &tv);
+	return true;
+}
+
+void jshUtilTimerDisable() {
+	struct itimerval t;
+	memset(&t, 0, sizeof(t));
+	setitimer(ITIMER_REAL, &t, 0);
+	utilTimerPending = 0;
+}
+
+void jshUtilTimerReschedule(JsSysTime period) {
+	jshUtilTimerSet(period);
+}
+
+void jshUtilTimerStart(JsSysTime period) {
+	jshUtilTimerSet(period);
+}
+
+JsVarFloat jshReadTemperature() { return NAN; };
+JsVarFloat jshReadVRef()  { return NAN; };
+
+// --------------------------------------------------------------------- FLASH
+static const char *jshFlashFileName() {
+	const char *name = getenv("ESPRUINO_FLASH");
+	return name ? name : FLASH_DEFAULT_FILE;
+}
+
+void jshSaveToFlash() {
+	unsigned int header[2] = { FLASH_MAGIC, jsvGetMemoryTotal() };
+	FILE *f = fopen(jshFlashFileName(), "wb");
+	if (!f) {
+		jsiConsolePrintf("Unable to open %s\n", jshFlashFileName());
+		return;
+	}
+	jsiConsolePrintf("Saving %d bytes to %s...\n", (int)(header[1]*sizeof(JsVar)), jshFlashFileName());
+	bool ok = fwrite(header, sizeof(header), 1, f) == 1 &&
+	          fwrite(_jsvGetAddressOf(1), sizeof(JsVar), header[1], f) == header[1];
+	if (fclose(f) != 0) ok = false;
+	jsiConsolePrint(ok ? "Done!\n" : "Write failed!\n");
+}
+
+void jshLoadFromFlash() {
+	unsigned int header[2];
+	FILE *f = fopen(jshFlashFileName(), "rb");
+	if (!f) return;
+	jsiConsolePrintf("Loading from %s...\n", jshFlashFileName());
+	if (fread(header, sizeof(header), 1, f) != 1 ||
+	    header[0] != FLASH_MAGIC || header[1] != jsvGetMemoryTotal() ||
+	    fread(_jsvGetAddressOf(1), sizeof(JsVar), header[1], f) != header[1])
+		jsiConsolePrint("Flash file doesn't match this build\n");
+	fclose(f);
+}
+
+bool jshFlashContainsCode() {
+	unsigned int header[2];
+	FILE *f = fopen(jshFlashFileName(), "rb");
+	if (!f) return false;
+	bool ok = fread(header, sizeof(header), 1, f) == 1 &&
+	          header[0] == FLASH_MAGIC && header[1] == jsvGetMemoryTotal();
+	fclose(f);
+	return ok;
+}
@@ -0,0 +1,22 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Extra hardware functions only provided by the Linux host build
+ * ----------------------------------------------------------------------------
+ */
+#ifndef JSHOST_H_
+#define JSHOST_H_
+
+#include "jsutils.h"
+
+/// Has stdin (the console) reached end of file?
+bool jshIsStdinClosed();
+
+#endif /* JSHOST_H_ */
@@ -0,0 +1,27 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Pin info for the simulated board used by the Linux host build
+ * ----------------------------------------------------------------------------
+ */
+#include "jspininfo.h"
+
+// sorted by name, as jshGetPinFromString does a binary search
+const pinStrEnum pinsInfo[] = {
+	{"A0", A0}, {"A1", A1}, {"A2", A2}, {"A3", A3}, {"A4", A4}, {"A5", A5},
+	{"D0", D0}, {"D1", D1}, {"D10", D10}, {"D11", D11}, {"D12", D12},
+	{"D13", D13}, {"D14", D14}, {"D15", D15}, {"D2", D2}, {"D3", D3},
+	{"D4", D4}, {"D5", D5}, {"D6", D6}, {"D7", D7}, {"D8", D8}, {"D9", D9},
+	{"LED1", LED1},
+	{"USBRX", USBRX},
+	{"USBTX", USBTX},
+};
+
+const int PINNUM = sizeof(pinsInfo)/sizeof(pinStrEnum);
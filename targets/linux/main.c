@@ -0,0 +1,260 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Entrypoint for the Linux host build. Build from the repository root with:
+ *
+ *   gcc -std=gnu99 -O2 -DLINUX -I. -Imath -Itargets/linux -o espruino \
+ *       *.c math/jswrap_math.c targets/linux/jshardware.c \
+ *       targets/linux/jspininfo.c targets/linux/main.c -lm
+ *
+ * Add -DRAM_TOTAL=... to give the same number of variables as a given board.
+ *
+ *   espruino                      interactive console
+ *   espruino file.js ...          run files, exit when there's nothing left to do
+ *   espruino -e "code"            run code, exit when there's nothing left to do
+ *   espruino --bench [-r N] file.js ...
+ *                                 run each file in a freshly initialised
+ *                                 interpreter (best of N runs) and report wall
+ *                                 time, variables used and garbage collections
+ * ----------------------------------------------------------------------------
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "jsutils.h"
+#include "jsvar.h"
+#include "jsparse.h"
+#include "jsinteractive.h"
+#include "jshardware.h"
+#include "jshost.h"
+
+static struct termios oldTermios;
+static bool termiosChanged = false;
+static int oldStdinFlags;
+static int savedStdout = -1;
+
+/// Put stdin back the way we found it
+static void restoreStdin() {
+	if (termiosChanged)
+		tcsetattr(STDIN_FILENO, TCSANOW, &oldTermios);
+	fcntl(STDIN_FILENO, F_SETFL, oldStdinFlags);
+}
+
+/// Pass keypresses (including Ctrl-C) straight to the console, as a serial terminal would
+static void setRawStdin() {
+	struct termios t;
+	if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &oldTermios) != 0) return;
+	t = oldTermios;
+	t.c_lflag &= (tcflag_t)~(ICANON | ECHO | ISIG);
+	t.c_cc[VMIN] = 1;
+	t.c_cc[VTIME] = 0;
+	if (tcsetattr(STDIN_FILENO, TCSANOW, &t) == 0)
+		termiosChanged = true;
+}
+
+/// Ctrl-C when stdin isn't raw - handled like Ctrl-C on the console, and a third one gives up
+static void sigintHandler(int sig) {
+	NOT_USED(sig);
+	if (jspIsInterrupted()) {
+		restoreStdin();
+		_exit(1);
+	}
+	if (execInfo.execute & EXEC_CTRL_C) { // JS is busy - the idle loop didn't see the first one
+		execInfo.execute &= (JsExecFlags)~EXEC_CTRL_C_MASK;
+		jspSetInterrupted(true);
+	} else
+		execInfo.execute |= EXEC_CTRL_C;
+}
+
+/// Send everything the interpreter prints to /dev/null (or put it back)
+static void setQuiet(bool quiet) {
+	fflush(stdout);
+	if (quiet && savedStdout < 0) {
+		int devNull = open("/dev/null", O_WRONLY);
+		if (devNull < 0) return;
+		savedStdout = dup(STDOUT_FILENO);
+		dup2(devNull, STDOUT_FILENO);
+		close(devNull);
+	} else if (!quiet && savedStdout >= 0) {
+		dup2(savedStdout, STDOUT_FILENO);
+		close(savedStdout);
+		savedStdout = -1;
+	}
+}
+
+static char *readFile(const char *fileName) {
+	FILE *f = fopen(fileName, "rb");
+	if (!f) {
+		fprintf(stderr, "Unable to open %s\n", fileName);
+		return 0;
+	}
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char *buf = (char*)malloc((size_t)size+1);
+	if (buf) {
+		size_t len = fread(buf, 1, (size_t)size, f);
+		buf[len] = 0;
+	}
+	fclose(f);
+	return buf;
+}
+
+/** Execute some code, then keep going until no timers or events are left.
+ * Returns false if there was an uncaught exception */
+static bool runCode(const char *code) {
+	bool ok = true;
+	jsvUnLock(jspEvaluate(code, false));
+	while (jsiHasTimers() || jshHasEvents() || jsiGetEventCount())
+		jsiLoop();
+	// jsiLoop would report these too, but with nothing left to do it'd sleep first
+	JsVar *exception = jspGetException();
+	if (exception) {
+		jsiConsolePrintf("Uncaught %v\n", exception);
+		jsvUnLock(exception);
+		ok = false;
+	}
+	JsVar *stackTrace = jspGetStackTrace();
+	if (stackTrace) {
+		jsiConsolePrintStringVar(stackTrace);
+		jsvUnLock(stackTrace);
+	}
+	return ok;
+}
+
+/// Shut the interpreter down and bring it back up with nothing in it
+static void restartInterpreter() {
+	jsiKill();
+	jsvKill();
+	jshReset();
+	jsvInit();
+	jsiInit(false);
+}
+
+static double getMilliseconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec*1000 + (double)ts.tv_nsec/1000000;
+}
+
+static int runBenchmarks(int repeats, int fileCount, char **fileNames) {
+	int i, r;
+	int failed = 0;
+	printf("%-32s %10s %8s %6s\n", "workload", "time(ms)", "vars", "gcs");
+	for (i=0;i<fileCount;i++) {
+		char *code = readFile(fileNames[i]);
+		if (!code) {
+			failed++;
+			continue;
+		}
+		double best = 0;
+		unsigned int vars = 0, gcs = 0;
+		bool ok = true;
+		for (r=0;r<repeats;r++) {
+			setQuiet(true);
+			restartInterpreter();
+			unsigned int gcStart = jsvGarbageCollectGetCount();
+			double start = getMilliseconds();
+			if (!runCode(code)) ok = false;
+			double time = getMilliseconds() - start;
+			gcs = jsvGarbageCollectGetCount() - gcStart;
+			vars = jsvGetMemoryUsage(); // whatever the workload left behind (including garbage)
+			setQuiet(false);
+			if (r==0 || time<best) best = time;
+		}
+		printf("%-32s %10.2f %8u %6u%s\n", fileNames[i], best, vars, gcs, ok ? "" : "  (uncaught exception)");
+		if (!ok) failed++;
+		fflush(stdout);
+		free(code);
+	}
+	return failed ? 1 : 0;
+}
+
+static void showHelp(const char *name) {
+	printf("Usage:\n"
+	       "  %s                          interactive console\n"
+	       "  %s file.js ...              run files\n"
+	       "  %s -e \"code\"                run code\n"
+	       "  %s --bench [-r N] file.js ...\n"
+	       "                              time each file in a fresh interpreter (best of N)\n",
+	       name, name, name, name);
+}
+
+int main(int argc, char **argv) {
+	int i;
+	bool bench = false;
+	int repeats = 1;
+	const char *code = 0;
+	int fileCount = 0;
+	char **fileNames = (char**)malloc(sizeof(char*)*(size_t)argc);
+
+	for (i=1;i<argc;i++) {
+		if (!strcmp(argv[i], "--bench")) {
+			bench = true;
+		} else if (!strcmp(argv[i], "-r") && i+1<argc) {
+			repeats = atoi(argv[++i]);
+			if (repeats < 1) repeats = 1;
+		} else if (!strcmp(argv[i], "-e") && i+1<argc) {
+			code = argv[++i];
+		} else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+			showHelp(argv[0]);
+			return 0;
+		} else if (argv[i][0] == '-') {
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			showHelp(argv[0]);
+			return 1;
+		} else {
+			fileNames[fileCount++] = argv[i];
+		}
+	}
+
+	oldStdinFlags = fcntl(STDIN_FILENO, F_GETFL);
+	atexit(restoreStdin);
+	signal(SIGINT, sigintHandler);
+
+	bool interactive = !bench && !code && !fileCount;
+	if (interactive) setRawStdin();
+	else setQuiet(true); // no banner
+	jshInit();
+	jsvInit();
+	jsiInit(interactive); // only load 'flash' for the console
+	if (!interactive) jsiStatus |= JSIS_ECHO_OFF; // no prompt after each callback
+	setQuiet(false);
+
+	int result = 0;
+	if (bench) {
+		result = runBenchmarks(repeats, fileCount, fileNames);
+	} else if (!interactive) {
+		if (code && !runCode(code)) result = 1;
+		for (i=0;i<fileCount;i++) {
+			char *fileCode = readFile(fileNames[i]);
+			if (!fileCode) {
+				result = 1;
+				break;
+			}
+			if (!runCode(fileCode)) result = 1;
+			free(fileCode);
+		}
+	} else {
+		while (!jshIsStdinClosed() || jsiHasTimers() || jshHasEvents() || jsiGetEventCount())
+			jsiLoop();
+	}
+
+	jsiKill();
+	jsvKill();
+	free(fileNames);
+	return result;
+}
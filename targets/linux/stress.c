@@ -0,0 +1,154 @@
+/*
+ * This file is part of Espruino, a JavaScript interpreter for Microcontrollers
+ *
+ * Copyright (C) 2013 Gordon Williams <gw@pur3.co.uk>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * ----------------------------------------------------------------------------
+ * Stress test for allocating vars from IRQs. Build it instead of main.c:
+ *
+ *   gcc -std=gnu99 -O2 -DLINUX -I. -Imath -Itargets/linux -o stress \
+ *       *.c math/jswrap_math.c targets/linux/jshardware.c \
+ *       targets/linux/jspininfo.c targets/linux/stress.c -lm
+ *
+ * A Utility Timer task allocates and frees vars every few microseconds,
+ * while JS code fills memory with objects, strings and flat strings (so the
+ * heap gets compacted too). Afterwards every var is checked: the heap
+ * counters (used and flat string blocks) must match what is really
+ * in use, and every free var must be on the free list. Prints "ok" and
+ * exits with 0 if so.
+ *
+ *   stress [iterations]
+ * ----------------------------------------------------------------------------
+ */
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "jsutils.h"
+#include "jsvar.h"
+#include "jsparse.h"
+#include "jsinteractive.h"
+#include "jshardware.h"
+#include "jstimer.h"
+
+#define STRESS_IRQ_VARS 6 ///< How many vars each 'IRQ' tries to allocate
+#define STRESS_IRQ_HELD 16 ///< How many vars the 'IRQ' keeps until a later call (so some are freed while memory is being rearranged)
+#define STRESS_KEEP 32 ///< How many iterations' objects the JS keeps alive at once
+
+static volatile unsigned int irqCount = 0;
+static volatile unsigned int irqAllocs = 0;
+static JsVar *irqHeld[STRESS_IRQ_HELD];
+
+/// Called from the Utility Timer 'IRQ' - allocate some vars (some of them strings longer than one var), then free them
+static void stressIRQ(JsSysTime time) {
+	NOT_USED(time);
+	JsVar *vars[STRESS_IRQ_VARS];
+	unsigned int i, n = 0;
+	for (i=0;i<STRESS_IRQ_VARS;i++) {
+		if (jsvIsMemoryFull()) break;
+		vars[n] = (i&1) ? jsvNewFromString("a string that needs more than one var") : jsvNewFromInteger((JsVarInt)i);
+		if (!vars[n]) break;
+		n++;
+	}
+	for (i=0;i<n;i++)
+		jsvUnLock(vars[i]);
+	// swap one var we kept from a previous call for a new one
+	JsVar **held = &irqHeld[irqCount % STRESS_IRQ_HELD];
+	jsvUnLock(*held);
+	*held = jsvIsMemoryFull() ? 0 : jsvNewFromString("kept until a later call");
+	irqCount++;
+	irqAllocs += n;
+}
+
+/// Count how many vars are really used, and how many are on the free list
+static void stressCountVars(unsigned int *used, unsigned int *unused, unsigned int *flat, unsigned int *freeList) {
+	JsVarRef i;
+	*used = 0;
+	*unused = 0;
+	*flat = 0;
+	for (i=1;i<=jsvGetMemoryTotal();i++) {
+		JsVar *v = _jsvGetAddressOf(i);
+		if ((v->flags&JSV_VARTYPEMASK) == JSV_UNUSED) {
+			(*unused)++;
+		} else {
+			(*used)++;
+			if (jsvIsFlatString(v)) {
+				*used += (unsigned int)jsvGetFlatStringBlocks(v);
+				*flat += 1+(unsigned int)jsvGetFlatStringBlocks(v);
+				i = (JsVarRef)(i+jsvGetFlatStringBlocks(v));
+			}
+		}
+	}
+	// take everything off the free list, then give it back
+	JsVar **vars = malloc(sizeof(JsVar*) * jsvGetMemoryTotal());
+	*freeList = 0;
+	while (vars && !jsvIsMemoryFull()) {
+		JsVar *v = jsvNewFromInteger(0);
+		if (!v) break;
+		vars[(*freeList)++] = v;
+	}
+	for (i=0;i<*freeList;i++)
+		jsvUnLock(vars[i]);
+	free(vars);
+}
+
+int main(int argc, char **argv) {
+	int iterations = (argc>1) ? atoi(argv[1]) : 300;
+	char code[1024];
+	jshInit();
+	jsvInit();
+	jsiInit(false);
+	/* Objects that stay alive for a while are left scattered about, so the
+	 * Uint8Arrays (which are flat strings) often need the heap compacted */
+	snprintf(code, sizeof(code),
+		"var keep=[], sum=0;"
+		"for (var k=0;k<%d;k++) {"
+		"  var a=[];"
+		"  for (var i=0;i<50;i++) a.push({x:i,s:'str'+i});"
+		"  keep[k%%%d] = a.filter(function(e,i) { return i%%2==0; });"
+		"  var o={};"
+		"  for (i=0;i<50;i++) o['k'+i]=a[i].s;"
+		"  var u=new Uint8Array(2000+(k%%9)*300);"
+		"  u[u.length-1]=k;"
+		"  sum+=u[u.length-1]+o.k49.length;"
+		"}"
+		"var check=0;"
+		"keep.forEach(function(a) { a.forEach(function(e) { check+=e.x+e.s.length; }); });"
+		"[sum, check]", iterations, STRESS_KEEP);
+	jstExecuteFn(stressIRQ, jshGetTimeFromMilliseconds(0.02));
+	JsVar *result = jspEvaluate(code, false);
+	jstStopExecuteFn(stressIRQ);
+	int k;
+	for (k=0;k<STRESS_IRQ_HELD;k++)
+		jsvUnLock(irqHeld[k]);
+
+	// work out what the JS should have got
+	int expectedSum = 0, expectedCheck = 0;
+	for (k=0;k<iterations;k++)
+		expectedSum += (k&0xFF) + 5;
+	for (k=iterations<STRESS_KEEP ? 0 : iterations-STRESS_KEEP;k<iterations;k++) {
+		int i;
+		for (i=0;i<50;i+=2)
+			expectedCheck += i + (i<10 ? 4 : 5);
+	}
+	int sum = (int)jsvGetIntegerAndUnLock(jsvGetArrayItem(result, 0));
+	int check = (int)jsvGetIntegerAndUnLock(jsvGetArrayItem(result, 1));
+	jsvUnLock(result);
+
+	jsvGarbageCollect();
+	unsigned int usage = jsvGetMemoryUsage();
+	unsigned int flatUsage = jsvGetMemoryFlatStringUsage();
+	unsigned int used, unused, flat, freeList;
+	stressCountVars(&used, &unused, &flat, &freeList);
+	bool ok = sum==expectedSum && check==expectedCheck &&
+	          usage==used && flatUsage==flat && unused==freeList && used+unused==jsvGetMemoryTotal();
+	printf("irqs=%u irqAllocs=%u sum=%d/%d check=%d/%d usage=%u used=%u flat=%u/%u unused=%u freeList=%u total=%u %s\n",
+	       irqCount, irqAllocs, sum, expectedSum, check, expectedCheck,
+	       usage, used, flatUsage, flat, unused, freeList, jsvGetMemoryTotal(), ok ? "ok" : "FAILED");
+	jsiKill();
+	jsvKill();
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+// Object.create is called with fewer arguments than its C function takes
+function check(cond, msg) {
+  if (!cond) throw new Error("FAIL: "+msg);
+}
+
+var P = {a:1};
+var o = Object.create(P);
+check(o.a===1, "inherits from the prototype");
+check(Object.keys(o).length===0, "has no properties of its own");
+
+o = Object.create(P, undefined);
+check(o.a===1, "with properties undefined");
+
+o = Object.create(null);
+check(typeof o==="object" && o.a===undefined, "with a null prototype");
+
+for (var i=0;i<100;i++) o = Object.create({b:i});
+check(o.b===99, "many times");